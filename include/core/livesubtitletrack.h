@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QStringView>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include "core/subtitletrack.h"
+
+// Дорожка, которая растёт во время транскрипции. Один поток-писатель
+// дописывает реплики в конец и публикует снимки; читатели в любом потоке
+// берут последний снимок без копирования данных. Указатель на снимок
+// защищён собственным мьютексом дорожки: под ним только копирование
+// shared_ptr, писатель держит его раз на публикацию. (std::atomic_load для
+// shared_ptr в libstdc++ - тот же мьютекс, но из общего пула, и в C++20
+// устарел; std::atomic<std::shared_ptr> требует C++20.) Проверить, появилось
+// ли новое, можно без блокировки через version().
+//
+// Записи и тексты лежат в блоках, которые только дописываются. Снимок - это
+// SubtitleTrack поверх префикса текущих блоков, держащий их ссылкой; писатель
+// пишет лишь за пределами опубликованного префикса. Когда блок заполнен,
+// заводится новый вдвое больше, а старые снимки продолжают держать прежний.
+class LiveSubtitleTrack {
+public:
+    LiveSubtitleTrack() = default;
+    LiveSubtitleTrack(const LiveSubtitleTrack &) = delete;
+    LiveSubtitleTrack &operator=(const LiveSubtitleTrack &) = delete;
+
+    // Только из потока-писателя. Реплики должны идти по времени; реплика,
+    // начинающаяся раньше конца последней принятой (перекрытие соседних
+    // чанков), отбрасывается. Возвращает, была ли реплика принята.
+    bool append(qint64 start, qint64 end, QStringView text);
+    // Делает принятые реплики видимыми читателям
+    void publish();
+
+    // Из любого потока
+    SubtitleTrackPtr snapshot() const;
+    quint64 version() const { return m_version.load(std::memory_order_acquire); }
+
+private:
+    template <typename T>
+    struct Block {
+        explicit Block(qsizetype capacity) : data(new T[capacity]), capacity(capacity) {}
+        std::unique_ptr<T[]> data;
+        qsizetype capacity;
+    };
+
+    template <typename T>
+    static void ensureCapacity(std::shared_ptr<Block<T>> &block, qsizetype used, qsizetype needed);
+
+    std::shared_ptr<Block<SubtitleTrack::Entry>> m_entries;
+    qsizetype m_count = 0;
+    std::shared_ptr<Block<QChar>> m_text;
+    qsizetype m_textSize = 0;
+    qint64 m_lastEnd = std::numeric_limits<qint64>::min();
+
+    mutable std::mutex m_publishedMutex;
+    SubtitleTrackPtr m_published = std::make_shared<const SubtitleTrack>();
+    std::atomic<quint64> m_version{0};
+};
+
+using LiveSubtitleTrackPtr = std::shared_ptr<LiveSubtitleTrack>;
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QFileInfo>
+#include <QString>
+
+// Кэш производных данных по медиафайлу (волна, миниатюры, индекс пакетов).
+// Файлы лежат в каталоге кэша приложения, а не рядом с видео: имя - хэш
+// абсолютного пути плюс суффикс вида данных. Устаревание каждый формат
+// проверяет сам по размеру и времени изменения исходника (см. SourceStamp).
+namespace MediaCache {
+
+// Путь файла кэша; каталог создаётся при необходимости. Пустая строка, если
+// каталог кэша недоступен
+QString pathFor(const QString &sourcePath, const QString &suffix);
+
+// Отпечаток исходника, который форматы кэша пишут в заголовок
+struct SourceStamp {
+    quint64 size = 0;
+    qint64 modified = 0; // мс от эпохи, UTC
+
+    static SourceStamp of(const QFileInfo &source);
+    bool operator==(const SourceStamp &other) const { return size == other.size && modified == other.modified; }
+    bool operator!=(const SourceStamp &other) const { return !(*this == other); }
+};
+
+} // namespace MediaCache
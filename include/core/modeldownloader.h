@@ -0,0 +1,76 @@
+#pragma once
+
+#include <QObject>
+#include <QFile>
+#include <QUrl>
+#include <QString>
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QFutureWatcher>
+#include <atomic>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+// Потоковое скачивание модели во временный файл "<target>.part".
+// Данные пишутся на диск по мере поступления (readyRead), поэтому память
+// ограничена размером буфера чтения, а не размером модели. Прерванная
+// загрузка продолжается с места остановки через HTTP Range. SHA-256
+// считается инкрементально и сверяется до переименования .part в итоговый файл.
+class ModelDownloader : public QObject {
+    Q_OBJECT
+public:
+    explicit ModelDownloader(QNetworkAccessManager *nam, QObject *parent = nullptr);
+    ~ModelDownloader();
+
+    // expectedSha256 - hex-строка; если пустая, берётся из "<target>.sha256"
+    // или из заголовков ответа сервера (X-Linked-ETag / ETag), если там SHA-256.
+    void start(const QUrl &url, const QString &targetPath, const QByteArray &expectedSha256 = QByteArray());
+    void abort();
+    bool isRunning() const { return m_reply != nullptr || m_hashWatcher.isRunning(); }
+
+    // После успешного finished: была ли сумма сверена с эталоном. Если эталона
+    // нет ни в аргументе, ни в .sha256, ни в заголовках - файл не проверен
+    bool isVerified() const { return m_verified; }
+    QByteArray actualSha256() const { return m_actualSha256; }
+
+    static QString partialPath(const QString &targetPath);
+
+    // Размер буфера чтения сокета: больше этого объёма в памяти не копится
+    static constexpr qint64 ReadBufferSize = 1024 * 1024;
+
+signals:
+    void progress(qint64 received, qint64 total);
+    void finished(bool ok, const QString &error);
+
+private slots:
+    void onMetaDataChanged();
+    void onReadyRead();
+    void onReplyFinished();
+
+private:
+    void sendRequest();
+    bool restartFromScratch();
+    void fail(const QString &error);
+    QString metaPath() const;
+    QByteArray expectedChecksum() const;
+
+    QNetworkAccessManager *m_nam;
+    QNetworkReply *m_reply = nullptr;
+    QFutureWatcher<bool> m_hashWatcher;
+    QCryptographicHash m_hash;
+    QFile m_file;
+    QUrl m_url;
+    QString m_targetPath;
+    QByteArray m_expectedSha256;
+    QByteArray m_serverSha256;
+    QByteArray m_validator; // ETag / Last-Modified частичного файла для If-Range
+    QByteArray m_actualSha256;
+    qint64 m_offset = 0;      // сколько байт уже лежит в .part
+    qint64 m_requestBase = 0; // с какого байта начат текущий запрос
+    bool m_headersChecked = false;
+    bool m_restartPending = false;
+    // Читается и фоновым подсчётом хеша .part - чтобы отмена не ждала весь файл
+    std::atomic<bool> m_aborted{false};
+    bool m_verified = false;
+};
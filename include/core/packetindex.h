@@ -0,0 +1,58 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <functional>
+#include <memory>
+
+// Индекс видеопакетов файла: время показа каждого кадра первой видеодорожки
+// и отдельно - ключевых кадров, оба списка отсортированы (мкс). Строится
+// одним проходом ffprobe по демуксеру, без декодирования, и кэшируется в
+// MediaCache. По нему перемотка выбирает ключевые кадры, а шаг по кадрам
+// находит соседний кадр.
+class PacketIndex {
+public:
+    PacketIndex() = default;
+    PacketIndex(QVector<qint64> framesUs, QVector<qint64> keyframesUs, qint64 durationUs);
+
+    // Аргументы ffprobe и разбор его CSV-вывода
+    static QStringList probeArguments(const QString &mediaPath);
+    static std::shared_ptr<PacketIndex> fromProbeOutput(const QByteArray &csv);
+
+    // Из кэша или через ffprobe. Блокирует - только для фоновых потоков.
+    // cancelled опрашивается, пока идёт ffprobe; вернул true - процесс
+    // убивается, результат nullptr
+    static std::shared_ptr<const PacketIndex> loadOrBuild(const QString &mediaPath, QString *error = nullptr,
+                                                          const std::function<bool()> &cancelled = {});
+
+    // Как часто loadOrBuild проверяет отмену, мс
+    static constexpr int ProbePollMs = 100;
+
+    bool save(const QString &cachePath, const QString &sourcePath) const;
+    static std::shared_ptr<PacketIndex> load(const QString &cachePath, const QString &sourcePath);
+
+    qint64 durationUs() const { return m_durationUs; }
+    double durationSeconds() const { return m_durationUs / 1e6; }
+    bool hasVideo() const { return !m_frames.isEmpty(); }
+    int frameCount() const { return int(m_frames.size()); }
+    qint64 frameTime(int index) const { return m_frames[index]; }
+    const QVector<qint64> &keyframes() const { return m_keyframes; }
+
+    // Кадр, который виден в момент positionUs (последний с началом <= позиции), или -1
+    int frameAt(qint64 positionUs) const;
+    // Ключевой кадр не позже позиции (0, если таких нет)
+    qint64 keyframeAtOrBefore(qint64 positionUs) const;
+    // Ключевой кадр не раньше позиции (-1, если таких нет)
+    qint64 keyframeAtOrAfter(qint64 positionUs) const;
+    // Ближайший к позиции ключевой кадр (сама позиция, если ключевых кадров нет)
+    qint64 nearestKeyframe(qint64 positionUs) const;
+
+private:
+    QVector<qint64> m_frames;
+    QVector<qint64> m_keyframes;
+    qint64 m_durationUs = 0;
+};
+
+using PacketIndexPtr = std::shared_ptr<const PacketIndex>;
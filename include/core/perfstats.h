@@ -0,0 +1,93 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QProcess>
+#include <QTimer>
+#include <functional>
+#include "core/subtitlescheduler.h"
+
+// Счётчики производительности для оверлея и телеметрии: частота показанных
+// кадров, пропуски (по разрывам PTS), цена смены субтитров, realtime factor
+// whisper и RSS дочерних процессов, точность синхронизации субтитров.
+// Раз в секунду, пока включён сбор, счётчики сводятся в Sample; если задан
+// CSV, строка дописывается в файл, чтобы сравнивать модели, файлы и машины.
+// Только для GUI-потока.
+class PerfStats : public QObject {
+    Q_OBJECT
+public:
+    explicit PerfStats(QObject *parent = nullptr);
+
+    static constexpr int SampleIntervalMs = 1000;
+
+    struct Sample {
+        qint64 timestampMs = 0;      // от эпохи, UTC
+        double fps = 0;
+        quint64 droppedFrames = 0;   // всего с начала сбора
+        int subtitleUpdates = 0;     // за интервал
+        double subtitleMeanUs = 0;
+        double subtitleMaxUs = 0;
+        double whisperRtf = -1;      // время обработки / длительность аудио; -1 - не было
+        qint64 childRssBytes = 0;    // сумма по живым дочерним процессам
+        qint64 childPeakRssBytes = 0;
+        int childProcesses = 0;
+        SubtitleScheduler::SyncStats sync;
+    };
+
+    void setActive(bool active);
+    bool isActive() const { return m_timer.isActive(); }
+    // Откуда брать SyncStats; опрашивается при каждом замере
+    void setSyncSource(std::function<SubtitleScheduler::SyncStats()> source);
+    // Контекст для строк CSV
+    void setContext(const QString &mediaFile, const QString &model);
+    // Пустой путь - не писать; файл дописывается, заголовок - только в новый
+    bool setCsvPath(const QString &path, QString *error = nullptr);
+
+    Sample lastSample() const { return m_last; }
+    static QString format(const Sample &sample);
+    // RSS процесса в байтах; -1, если на этой платформе не узнать
+    static qint64 processRssBytes(qint64 pid);
+
+public slots:
+    // Кадр отдан на экран; PTS в мс
+    void frameShown(qint64 position);
+    void subtitleUpdated(qint64 costNs);
+    // Очередной кусок аудио расшифрован: его длительность и время работы whisper
+    void transcribed(qint64 audioMs, qint64 wallMs);
+    // RSS процесса снимается при каждом замере, пока он жив
+    void watchProcess(QProcess *process);
+    void resetTranscription();
+
+signals:
+    void sampled(const PerfStats::Sample &sample);
+
+private:
+    void takeSample();
+    void writeCsv(const Sample &sample);
+
+    QTimer m_timer;
+    QElapsedTimer m_interval;
+    std::function<SubtitleScheduler::SyncStats()> m_syncSource;
+
+    int m_frames = 0;
+    qint64 m_lastFramePts = -1;
+    qint64 m_frameStepMs = 0; // наименьший шаг PTS - номинальная длительность кадра
+    quint64 m_dropped = 0;
+
+    int m_subtitleUpdates = 0;
+    qint64 m_subtitleTotalNs = 0;
+    qint64 m_subtitleMaxNs = 0;
+
+    qint64 m_audioMs = 0;
+    qint64 m_wallMs = 0;
+    QList<QPointer<QProcess>> m_processes;
+    qint64 m_peakRss = 0;
+
+    QFile m_csv;
+    QString m_mediaFile;
+    QString m_model;
+    Sample m_last;
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+// Очередь файлов для последовательного воспроизведения (например, серия лекций)
+class Playlist {
+public:
+    void setItems(const QStringList &items, int current = 0);
+    void clear();
+
+    const QStringList &items() const { return m_items; }
+    bool isEmpty() const { return m_items.isEmpty(); }
+    int currentIndex() const { return m_current; }
+    QString current() const;
+    bool hasNext() const { return m_current >= 0 && m_current + 1 < m_items.size(); }
+    // Путь следующего файла или пустая строка
+    QString next() const;
+    bool advance();
+
+private:
+    QStringList m_items;
+    int m_current = -1;
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <QTimer>
+#include <atomic>
+#include "core/packetindex.h"
+
+class QMediaPlayer;
+
+// Единственная точка, через которую плеер перематывает. Пока декодер не
+// закончил предыдущую перемотку (не пришёл кадр у цели или не истёк
+// таймаут), новые запросы не уходят в QMediaPlayer, а заменяют отложенный -
+// выполняется только последний. Быстрая перемотка прыгает на ключевой кадр
+// из PacketIndex, чтобы декодеру не приходилось дорабатывать длинный GOP:
+// при перетаскивании ползунка - на ближайший, при автоповторе клавиш - на
+// первый в сторону движения; точная идёт ровно в запрошенную позицию. Шаг
+// по кадрам берёт соседний кадр из индекса.
+class SeekCoordinator : public QObject {
+    Q_OBJECT
+public:
+    enum Mode { Fast, Exact };
+
+    explicit SeekCoordinator(QMediaPlayer *player, QObject *parent = nullptr);
+    ~SeekCoordinator() override;
+
+    // Строит (или берёт из кэша) индекс пакетов в фоне; пустой путь - сброс.
+    // Недостроенный индекс прежнего файла бросается вместе с его ffprobe
+    void loadIndex(const QString &mediaPath);
+    // Индекс, уже загруженный заранее (предзагрузка плейлиста); nullptr - как loadIndex
+    void setIndex(const QString &mediaPath, PacketIndexPtr index);
+    // Плейлист подменяет плеер при переходе к предзагруженному файлу
+    void setPlayer(QMediaPlayer *player);
+    PacketIndexPtr index() const { return m_index; }
+
+    void seek(qint64 positionMs, Mode mode = Exact);
+    // Относительно targetPosition(). Быстрая - на ключевой кадр не ближе цели
+    // в сторону движения и никогда не на текущий. Возвращает выбранную позицию
+    qint64 seekBy(qint64 deltaMs, Mode mode = Exact);
+    // На кадр вперёд (direction > 0) или назад; воспроизведение ставится на паузу
+    void stepFrame(int direction);
+
+    // Куда идёт (или пойдёт) перемотка; без перемотки - позиция плеера
+    qint64 targetPosition() const;
+    bool isSeeking() const { return m_inFlight; }
+
+    // Шаг, если индекса нет или в нём нет видео (25 к/с)
+    static constexpr qint64 FallbackFrameMs = 40;
+    // Сколько ждать кадра у цели, прежде чем считать перемотку законченной
+    static constexpr int SettleTimeoutMs = 250;
+    // Кадр ближе этого к цели означает, что декодер уже там
+    static constexpr qint64 ArrivalToleranceMs = 100;
+
+public slots:
+    // Время показа очередного кадра (мс)
+    void frameArrived(qint64 framePositionMs);
+
+signals:
+    void indexReady(PacketIndexPtr index);
+    // Позиция, реально переданная декодеру (после привязки к ключевому кадру)
+    void seekIssued(qint64 positionMs);
+
+private:
+    void request(qint64 positionMs);
+    void issue(qint64 positionMs);
+    void settle();
+
+    QMediaPlayer *m_player;
+    QThreadPool m_pool;
+    QString m_indexPath;
+    PacketIndexPtr m_index;
+    std::atomic<quint64> m_generation{0};
+    QTimer m_settleTimer;
+    bool m_inFlight = false;
+    bool m_hasPending = false;
+    qint64 m_pending = 0;
+    qint64 m_issued = 0;
+};
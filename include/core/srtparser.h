@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+// Одна реплика субтитров, время в миллисекундах
+struct SubtitleCue {
+    qint64 start = 0;
+    qint64 end = 0;
+    QString text;
+};
+
+// Однопроходный парсер SRT по сырым байтам (без QString и регулярных выражений
+// на этапе разбора структуры). Понимает BOM, CRLF, пропущенные номера и пустые
+// строки между репликами, пропускает битые блоки. Таймкоды WebVTT (точка перед
+// миллисекундами, без часов) тоже принимаются. Если вход не является валидным
+// UTF-8, текст декодируется как cp1251.
+namespace SrtParser {
+
+enum class Encoding { Utf8, Cp1251 };
+
+// Реплика без декодирования текста: смещения в исходном буфере
+struct RawCue {
+    qint64 start;
+    qint64 end;
+    qsizetype textOffset;
+    qsizetype textLength;
+};
+
+// Разбор структуры: только таймкоды и границы текста
+QVector<RawCue> scan(const char *data, qsizetype size);
+
+bool isValidUtf8(const char *data, qsizetype size);
+Encoding detectEncoding(const char *data, qsizetype size);
+
+// Текст реплики: переводы строк заменяются пробелами, края обрезаются
+QString decodeText(const char *data, const RawCue &cue, Encoding encoding);
+
+QList<SubtitleCue> parse(const char *data, qsizetype size);
+QList<SubtitleCue> parse(const QByteArray &data);
+
+} // namespace SrtParser
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Сторож GUI-потока: таймер в цикле событий отмечается каждые HeartbeatMs,
+// отдельный поток следит за отметками. Если цикл событий не отвечает дольше
+// порога, это зависание: запоминается активная операция (см. Scope), сколько
+// она уже идёт, и снимок стека GUI-потока, где это умеет платформа (glibc и
+// macOS: сигнал SIGUSR2 и backtrace() в обработчике). Кроме зависаний
+// считаются отметки, опоздавшие больше чем на кадр, - по ним видно, держится
+// ли GUI-поток в бюджете кадра.
+// Всё, кроме stalls() и Scope, - из GUI-потока.
+namespace StallWatchdog {
+
+constexpr int HeartbeatMs = 16;
+constexpr int FrameBudgetMs = 16;
+constexpr int DefaultThresholdMs = 200;
+
+struct Stall {
+    qint64 atMs = 0;        // от start()
+    qint64 durationMs = 0;
+    QString operation;      // вложенные операции через " > "; пусто - не размечено
+    qint64 operationMs = 0; // сколько операция шла к концу зависания (по последнему опросу)
+    QStringList stack;      // пусто, если снимок недоступен
+};
+
+struct Summary {
+    qint64 uptimeMs = 0;
+    qint64 beats = 0;
+    qint64 lateBeats = 0;   // опоздали больше чем на FrameBudgetMs
+    qint64 maxLatenessMs = 0;
+    int stalls = 0;
+    qint64 stalledMs = 0;
+    qint64 longestMs = 0;
+};
+
+void start(int thresholdMs = DefaultThresholdMs);
+void stop();
+bool isRunning();
+
+QVector<Stall> stalls();
+Summary summary();
+// Сводка и все зависания текстом
+QString report();
+bool writeReport(const QString &path, QString *error = nullptr);
+
+// Разметка долгой операции в GUI-потоке; в других потоках ничего не делает.
+// name должен жить всё время работы программы (строковый литерал)
+class Scope {
+public:
+    explicit Scope(const char *name);
+    ~Scope();
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+private:
+    bool m_active = false;
+};
+
+} // namespace StallWatchdog
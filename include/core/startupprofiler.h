@@ -0,0 +1,29 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+// Замер фаз запуска: от начала main() до первой отрисовки главного окна.
+// Фазы отмечаются по мере прохождения, при первой отрисовке в лог уходит
+// сводка; фазы, отложенные на потом, логируются по одной.
+// Только для GUI-потока.
+namespace StartupProfiler {
+
+struct Phase {
+    QString name;
+    qint64 elapsedNs = 0; // от start()
+};
+
+// Самое начало main(), до QApplication
+void start();
+// Конец фазы с этим именем
+void mark(const QString &name);
+// Первая отрисовка окна; повторные вызовы ничего не делают
+void firstPaint();
+
+bool firstPaintDone();
+// Время до первой отрисовки, мс; -1, пока её не было
+double timeToFirstPaintMs();
+QVector<Phase> phases();
+
+} // namespace StartupProfiler
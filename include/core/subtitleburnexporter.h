@@ -0,0 +1,71 @@
+#pragma once
+
+#include <QObject>
+#include <QList>
+#include <QVector>
+#include <QString>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QFutureWatcher>
+#include <atomic>
+#include <memory>
+#include "core/subtitletrack.h"
+#include "core/packetindex.h"
+
+class QProcess;
+
+// Экспорт видео с вшитыми (hardsub) субтитрами.
+// Таймлайн режется по ключевым кадрам на сегменты, сегменты кодируются
+// параллельно несколькими процессами ffmpeg, затем склеиваются concat-демуксером
+// без перекодирования (звук копируется из исходника).
+class SubtitleBurnExporter : public QObject {
+    Q_OBJECT
+public:
+    explicit SubtitleBurnExporter(QObject *parent = nullptr);
+    ~SubtitleBurnExporter();
+
+    void start(const QString &videoPath, const QString &outputPath, SubtitleTrackPtr track);
+    void cancel();
+    bool isRunning() const { return m_running; }
+
+    // Сколько сегментов кодируется одновременно (по умолчанию - число ядер)
+    void setMaxParallelJobs(int jobs) { m_maxJobs = qMax(1, jobs); }
+
+signals:
+    void progress(int percent, const QString &stage);
+    void finished(bool ok, const QString &error);
+
+private:
+    struct Segment {
+        double start = 0;
+        double end = 0;
+        double encodedSeconds = 0;
+        QProcess *process = nullptr;
+        bool done = false;
+    };
+
+    void onProbeFinished(PacketIndexPtr index, const QString &error);
+    void planSegments(const QVector<double> &keyframes);
+    void launchPendingSegments();
+    void onSegmentFinished(int index, int exitCode);
+    void concatSegments();
+    void reportProgress();
+    void watchStartFailure(QProcess *process, const QString &program);
+    void finish(bool ok, const QString &error);
+    QString segmentFileName(int index) const;
+
+    QString m_videoPath;
+    QString m_outputPath;
+    SubtitleTrackPtr m_track;
+    std::unique_ptr<QTemporaryDir> m_workDir;
+    QFutureWatcher<PacketIndexPtr> *m_probe = nullptr;
+    std::shared_ptr<std::atomic<bool>> m_probeCancelled;
+    QProcess *m_concat = nullptr;
+    QList<Segment> m_segments;
+    QElapsedTimer m_timer;
+    double m_duration = 0;
+    int m_nextSegment = 0;
+    int m_runningJobs = 0;
+    int m_maxJobs;
+    bool m_running = false;
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <QString>
+#include "core/subtitletrack.h"
+
+// Бинарный индекс субтитров рядом с исходным файлом ("movie.srt.subidx").
+// Внутри ровно то, что держит SubtitleTrack: заголовок, отсортированная
+// таблица записей и буфер текстов в UTF-16. Файл отображается в память и
+// используется как есть, без разбора; проверяются только границы.
+// Индекс считается устаревшим, если размер или время изменения исходника
+// не совпадают с записанными в заголовке.
+namespace SubtitleIndex {
+
+QString sidecarPath(const QString &sourcePath);
+
+bool write(const SubtitleTrack &track, const QString &sourcePath, QString *error = nullptr);
+
+// nullptr, если индекса нет, он устарел или повреждён
+SubtitleTrackPtr load(const QString &sourcePath, QString *error = nullptr);
+
+} // namespace SubtitleIndex
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include "core/subtitletrack.h"
+
+// Загрузка субтитров с диска. Функции блокирующие (файл может лежать на
+// сетевом диске и весить сотни мегабайт), поэтому из GUI их зовут в фоне.
+namespace SubtitleLoader {
+
+// Файлы .srt/.vtt рядом с видео: сначала с тем же именем, затем с
+// суффиксом языка вроде "movie.ru.srt"
+QStringList siblingCandidates(const QString &videoPath);
+
+// Дорожка из файла субтитров: из свежего бинарного индекса, если он есть,
+// иначе разбором через отображение в память (индекс после этого пишется
+// рядом). При ошибке - nullptr
+SubtitleTrackPtr loadFile(const QString &path, QString *error = nullptr);
+
+} // namespace SubtitleLoader
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include "core/subtitletrack.h"
+
+// Переключает субтитры точно на границах реплик, а не на тиках positionChanged.
+// Пока приходят кадры видео, ведущим считается их время показа (PTS): реплика
+// меняется на том кадре, который первым перешёл границу. Без кадров (аудио,
+// пауза в потоке) позиция экстраполируется по монотонным часам с учётом
+// скорости, и таймер взводится на ближайшую границу реплики. Отчёты плеера
+// о позиции только подстраивают часы, пока расхождение в пределах допуска.
+class SubtitleScheduler : public QObject {
+    Q_OBJECT
+public:
+    explicit SubtitleScheduler(QObject *parent = nullptr);
+
+    void setTrack(SubtitleTrackPtr track);
+    SubtitleTrackPtr track() const { return m_track; }
+    int currentCue() const { return m_currentCue; }
+    qint64 estimatedPosition() const;
+
+    // Расхождение часов и отчёта плеера, после которого часы переставляются
+    static constexpr qint64 ResyncThresholdMs = 40;
+    // Сколько ждать следующего кадра, прежде чем вернуться к таймеру
+    static constexpr qint64 FrameTimeoutMs = 200;
+
+    // Точность синхронизации. boundary - насколько позже границы реплики (во
+    // времени медиа) она фактически сменилась; drift - насколько positionChanged
+    // расходится с PTS показанных кадров, т.е. ошибка без привязки к кадрам
+    struct SyncStats {
+        int samples = 0;
+        qint64 lastBoundaryErrorMs = 0;
+        qint64 maxBoundaryErrorMs = 0;
+        double meanBoundaryErrorMs = 0;
+        qint64 lastDriftMs = 0;
+        qint64 maxAbsDriftMs = 0;
+    };
+    SyncStats syncStats() const { return m_stats; }
+    void resetSyncStats() { m_stats = SyncStats(); }
+    bool frameDriven() const;
+
+public slots:
+    void syncPosition(qint64 position);
+    // Время показа кадра, только что отданного на экран (мс)
+    void presentFrame(qint64 framePosition);
+    void seek(qint64 position);
+    void setPlaying(bool playing);
+    void setPlaybackRate(double rate);
+
+signals:
+    void cueChanged(int index);
+    void syncMeasured(qint64 boundaryErrorMs);
+
+private:
+    void evaluate(qint64 position);
+    void arm(qint64 position);
+    void onTimeout();
+    void reanchor(qint64 position);
+    void recordBoundaryError(qint64 position);
+
+    SubtitleTrackPtr m_track;
+    SubtitleTrack::Cursor m_cursor;
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    qint64 m_anchor = 0;
+    qint64 m_armedBoundary = -1;
+    double m_rate = 1.0;
+    bool m_playing = false;
+    int m_currentCue = -1;
+    QElapsedTimer m_lastFrame;
+    SyncStats m_stats;
+};
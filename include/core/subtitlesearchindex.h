@@ -0,0 +1,35 @@
+#pragma once
+
+#include <QMap>
+#include <QString>
+#include <QStringView>
+#include <QVector>
+#include "core/subtitletrack.h"
+
+// Обратный индекс по словам реплик для поиска по сказанному. Слова
+// приводятся к нижнему регистру, "ё" сворачивается в "е"; каждое слово
+// запроса ищется как префикс, результат - реплики, где нашлись все слова.
+// Индекс дополняется по мере роста дорожки: appendFrom добавляет только
+// реплики, которых в нём ещё нет.
+class SubtitleSearchIndex {
+public:
+    void clear();
+    // Проиндексировать реплики [indexedCount(), min(track.size(), indexedCount() + maxCues))
+    // Возвращает, сколько реплик добавлено
+    int appendFrom(const SubtitleTrack &track, int maxCues = -1);
+    int indexedCount() const { return m_indexed; }
+
+    // Номера реплик по возрастанию, не больше limit
+    QVector<int> search(QStringView query, int limit = -1) const;
+
+    // Нормализация слова: регистр и ё -> е
+    static QString fold(QStringView word);
+    // Слова текста в нормализованном виде
+    static QVector<QString> tokenize(QStringView text);
+
+private:
+    QVector<int> prefixPostings(const QString &prefix) const;
+
+    QMap<QString, QVector<int>> m_terms;
+    int m_indexed = 0;
+};
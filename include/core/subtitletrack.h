@@ -0,0 +1,72 @@
+#pragma once
+
+#include <QList>
+#include <QString>
+#include <QStringView>
+#include <QVector>
+#include <memory>
+#include "core/srtparser.h"
+
+// Дорожка субтитров в компактном виде: массив записей (начало, конец, текст)
+// подряд в памяти, отсортированный по началу, и один общий буфер со всеми
+// текстами. Поиск реплики - бинарный, а при воспроизведении через Cursor,
+// который обычно сдвигается на соседнюю запись за O(1).
+//
+// Сама дорожка - лёгкое неизменяемое представление: указатели на записи и
+// тексты плюс владелец памяти, в которой они лежат. Поэтому снимок растущей
+// дорожки (LiveSubtitleTrack) не копирует уже накопленные реплики.
+class SubtitleTrack {
+public:
+    struct Entry {
+        qint64 start;
+        qint64 end;
+        quint32 textOffset; // в символах QChar от начала буфера текстов
+        quint32 textLength;
+    };
+
+    // Позиция воспроизведения внутри дорожки
+    class Cursor {
+    public:
+        // Индекс реплики, которая видна в момент position, или -1
+        int seek(const SubtitleTrack &track, qint64 position);
+        void reset() { m_slot = -1; }
+
+    private:
+        int m_slot = -1; // последняя реплика с start <= position
+    };
+
+    SubtitleTrack() = default;
+    // entries должны быть отсортированы по start; storage держит память живой
+    SubtitleTrack(std::shared_ptr<const void> storage, const Entry *entries, int count,
+                  const QChar *text, qsizetype textSize, quint64 version = 0);
+
+    // Сортирует реплики; при одинаковом начале остаётся последняя
+    static SubtitleTrack fromCues(const QList<SubtitleCue> &cues);
+
+    int size() const { return m_count; }
+    bool isEmpty() const { return m_count == 0; }
+    const Entry &entry(int index) const { return m_entries[index]; }
+    qint64 start(int index) const { return m_entries[index].start; }
+    qint64 end(int index) const { return m_entries[index].end; }
+    QStringView text(int index) const;
+    // Сырые данные для бинарного индекса: записи подряд и общий буфер текстов
+    const Entry *entries() const { return m_entries; }
+    QStringView textPool() const { return QStringView(m_text, m_textSize); }
+    // Номер снимка у растущей дорожки, 0 у готовой
+    quint64 version() const { return m_version; }
+
+    // Последняя реплика с началом <= position (или -1)
+    int slotAt(qint64 position) const;
+    // Реплика, видимая в момент position (или -1)
+    int indexAt(qint64 position) const;
+
+private:
+    std::shared_ptr<const void> m_storage;
+    const Entry *m_entries = nullptr;
+    int m_count = 0;
+    const QChar *m_text = nullptr;
+    qsizetype m_textSize = 0;
+    quint64 m_version = 0;
+};
+
+using SubtitleTrackPtr = std::shared_ptr<const SubtitleTrack>;
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <QByteArray>
+#include "core/subtitletrack.h"
+
+// Сериализация дорожки в текстовые форматы. Все функции работают прямо
+// с SubtitleTrack, без промежуточного списка реплик.
+namespace SubtitleWriter {
+
+enum class Format { Srt, Vtt, Ass };
+
+// Формат по расширению файла; неизвестное расширение - SRT
+Format formatForPath(const QString &path);
+
+// Реплики, пересекающие [from, to), обрезаются по границам и сдвигаются на -offset
+// (to < 0 - до конца дорожки)
+QByteArray toSrt(const SubtitleTrack &track, qint64 offset = 0, qint64 from = 0, qint64 to = -1);
+QByteArray toVtt(const SubtitleTrack &track);
+QByteArray toAss(const SubtitleTrack &track);
+QByteArray serialize(const SubtitleTrack &track, Format format);
+
+// Атомарная запись через QSaveFile
+bool writeFile(const QString &path, const QByteArray &data, QString *error = nullptr);
+
+} // namespace SubtitleWriter
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <QImage>
+#include <QRect>
+#include <QString>
+#include <atomic>
+#include <memory>
+
+// Миниатюры кадров через равные промежутки, уложенные сеткой в одну
+// картинку. Кадр под позицией находится делением (indexAt), вывод - это
+// drawImage с прямоугольником плитки, без копирования и без декодера.
+// Плитки дописываются по порядку одним потоком; читать можно из любого
+// потока уже готовые (до readyCount()).
+class ThumbnailAtlas {
+public:
+    static constexpr int TileWidth = 128;
+    static constexpr int TileHeight = 72;
+    static constexpr int Columns = 16;
+    static constexpr int MaxTiles = 400;
+    static constexpr qint64 MinIntervalMs = 5000;
+
+    ThumbnailAtlas(qint64 intervalMs, int tileCount);
+
+    // Шаг, при котором весь файл укладывается в MaxTiles плиток (целые секунды)
+    static qint64 intervalFor(qint64 durationMs);
+
+    qint64 intervalMs() const { return m_intervalMs; }
+    int tileCount() const { return m_tileCount; }
+    int readyCount() const { return m_ready.load(std::memory_order_acquire); }
+
+    // Ближайшая к моменту готовая плитка или -1
+    int indexAt(qint64 positionMs) const;
+    QRect tileRect(int index) const;
+    const QImage &image() const { return m_image; }
+
+    // Следующая плитка: TileWidth x TileHeight пикселей RGB888 подряд
+    void appendTile(const uchar *rgb);
+
+    // Кэш на диске: заголовок и сетка в JPEG
+    bool save(const QString &cachePath, const QString &sourcePath) const;
+    static std::shared_ptr<ThumbnailAtlas> load(const QString &cachePath, const QString &sourcePath);
+
+private:
+    qint64 m_intervalMs;
+    int m_tileCount;
+    QImage m_image;
+    std::atomic<int> m_ready{0};
+};
+
+using ThumbnailAtlasPtr = std::shared_ptr<const ThumbnailAtlas>;
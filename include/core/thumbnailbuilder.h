@@ -0,0 +1,38 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <atomic>
+#include "core/thumbnailatlas.h"
+
+// Строит атлас миниатюр для медиафайла одним процессом ffmpeg: декодируются
+// только ключевые кадры, фильтр fps выбирает по кадру на шаг атласа, кадры
+// приходят сырым RGB через stdout и сразу ложатся в сетку. Готовый атлас
+// кладётся в MediaCache.
+class ThumbnailBuilder : public QObject {
+    Q_OBJECT
+public:
+    explicit ThumbnailBuilder(QObject *parent = nullptr);
+    ~ThumbnailBuilder() override;
+
+    // Повторный вызов с тем же файлом и длительностью ничего не делает
+    void start(const QString &mediaPath, qint64 durationMs);
+    void cancel();
+
+    ThumbnailAtlasPtr atlas() const { return m_atlas; }
+
+signals:
+    void atlasChanged(ThumbnailAtlasPtr atlas);
+    void finished();
+
+private:
+    void build(const QString &path, qint64 durationMs, quint64 generation);
+    void publish(const std::shared_ptr<ThumbnailAtlas> &atlas, quint64 generation, bool last);
+
+    QThreadPool m_pool;
+    QString m_path;
+    qint64 m_durationMs = 0;
+    ThumbnailAtlasPtr m_atlas;
+    std::atomic<quint64> m_generation{0};
+};
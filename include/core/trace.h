@@ -0,0 +1,89 @@
+#pragma once
+
+#include <QString>
+#include <QtGlobal>
+
+// Трассировка: интервалы, мгновенные события и счётчики по категориям.
+// Сборка с -DSIMPLE_PLAYER_TRACING=ON включает макросы ниже, без неё они
+// раскрываются в пустоту и аргументы даже не вычисляются.
+//
+// Каждый поток пишет в свой кольцевой буфер без блокировок (один писатель);
+// при переполнении теряются самые старые события. writeChromeJson() снимает
+// копии всех буферов и сохраняет их в формате Chrome trace
+// (chrome://tracing, Perfetto).
+//
+// Категории и имена - строковые литералы: в буфере хранятся только указатели.
+namespace Trace {
+
+enum class Phase : char {
+    Complete = 'X',   // интервал с длительностью
+    Instant = 'i',
+    Counter = 'C',
+    AsyncBegin = 'b', // интервал, который начинается и кончается в разных вызовах
+    AsyncEnd = 'e',
+};
+
+struct Event {
+    const char *category = nullptr;
+    const char *name = nullptr;
+    qint64 timestampNs = 0; // от первого события процесса
+    qint64 durationNs = 0;  // Complete
+    qint64 value = 0;       // Counter - значение, Async* - идентификатор пары
+    Phase phase = Phase::Instant;
+};
+
+// Ёмкость буфера одного потока, событий
+constexpr int RingCapacity = 1 << 13;
+
+qint64 now();
+void record(const Event &event);
+
+// Все события всех потоков; threadId - порядковый номер буфера
+bool writeChromeJson(const QString &path, QString *error = nullptr);
+
+// Интервал от конструктора до деструктора
+class Scope {
+public:
+    Scope(const char *category, const char *name)
+        : m_category(category), m_name(name), m_start(now()) {}
+    ~Scope()
+    {
+        Event event;
+        event.category = m_category;
+        event.name = m_name;
+        event.timestampNs = m_start;
+        event.durationNs = now() - m_start;
+        event.phase = Phase::Complete;
+        record(event);
+    }
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+private:
+    const char *m_category;
+    const char *m_name;
+    qint64 m_start;
+};
+
+void instant(const char *category, const char *name);
+void counter(const char *category, const char *name, qint64 value);
+void asyncBegin(const char *category, const char *name, qint64 id);
+void asyncEnd(const char *category, const char *name, qint64 id);
+
+} // namespace Trace
+
+#if defined(SIMPLE_PLAYER_TRACING) && SIMPLE_PLAYER_TRACING
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(category, name) const Trace::Scope TRACE_CONCAT(traceScope_, __LINE__)(category, name)
+#define TRACE_INSTANT(category, name) Trace::instant(category, name)
+#define TRACE_COUNTER(category, name, value) Trace::counter(category, name, qint64(value))
+#define TRACE_ASYNC_BEGIN(category, name, id) Trace::asyncBegin(category, name, qint64(id))
+#define TRACE_ASYNC_END(category, name, id) Trace::asyncEnd(category, name, qint64(id))
+#else
+#define TRACE_SCOPE(category, name) do {} while (0)
+#define TRACE_INSTANT(category, name) do {} while (0)
+#define TRACE_COUNTER(category, name, value) do {} while (0)
+#define TRACE_ASYNC_BEGIN(category, name, id) do {} while (0)
+#define TRACE_ASYNC_END(category, name, id) do {} while (0)
+#endif
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <QObject>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <memory>
+#include "core/livesubtitletrack.h"
+
+// Транскрипция медиафайла в живую дорожку без GUI: ffmpeg извлекает
+// PCM 16 кГц моно, WavChunker режет его на перекрывающиеся чанки, whisper
+// обрабатывает до concurrency чанков одновременно, SRT каждого чанка
+// разбирается в фоновом потоке. Чанки могут закончиться в любом порядке,
+// но в дорожку попадают строго по порядку: перекрытие с предыдущим чанком
+// отбрасывает сама LiveSubtitleTrack.
+// Внешние программы задаются в Config, поэтому конвейер можно гонять на
+// заглушках (см. src/bench/pipelinebench.cpp).
+class TranscriptionPipeline : public QObject {
+    Q_OBJECT
+public:
+    struct Config {
+        QString ffmpegPath = QStringLiteral("ffmpeg");
+        QString whisperPath;
+        QString modelPath;
+        QString language = QStringLiteral("ru");
+        // Параметры whisper сверх модели, входа, выхода и языка
+        QStringList whisperArgs{"--max-len", "300", "--split-on-word", "--word-thold", "0.01"};
+        int whisperThreads = 0; // -t; 0 - по умолчанию whisper
+        qint64 chunkMs = 15000;
+        qint64 overlapMs = 2000;
+        int concurrency = 1;    // процессов whisper одновременно
+        QString workDir;        // временные файлы; пусто - системный временный каталог
+    };
+
+    // Время одного чанка по стадиям
+    struct ChunkStats {
+        int index = -1;
+        qint64 audioMs = 0;
+        qint64 sliceNs = 0;   // нарезка WAV
+        qint64 spawnNs = 0;   // от QProcess::start до started
+        qint64 whisperMs = 0; // от запуска до завершения процесса
+        qint64 parseNs = 0;   // разбор SRT и дописывание в дорожку
+        int cues = 0;
+        bool ok = false;
+    };
+
+    struct Stats {
+        qint64 audioMs = 0;
+        qint64 extractMs = 0;
+        qint64 wallMs = 0;
+        int chunks = 0;
+        int failedChunks = 0;
+        int trackUpdates = 0;
+        qint64 sliceNs = 0;
+        qint64 spawnNs = 0;
+        qint64 whisperMs = 0;
+        qint64 parseNs = 0;
+    };
+
+    explicit TranscriptionPipeline(QObject *parent = nullptr);
+    ~TranscriptionPipeline() override;
+
+    void setConfig(const Config &config) { m_config = config; }
+    const Config &config() const { return m_config; }
+
+    // Отменяет текущую транскрипцию и начинает новую
+    void start(const QString &mediaPath);
+    void cancel();
+    bool isRunning() const { return m_run != nullptr; }
+
+    // Дорожка текущей (или последней) транскрипции
+    LiveSubtitleTrackPtr track() const { return m_track; }
+    Stats stats() const { return m_stats; }
+
+signals:
+    // Для учёта памяти и времени дочерних процессов (PerfStats)
+    void processStarted(QProcess *process);
+    void chunkFinished(const TranscriptionPipeline::ChunkStats &chunk);
+    // В дорожке опубликован новый снимок
+    void trackUpdated(LiveSubtitleTrackPtr track);
+    void progressed(int done, int total);
+    void finished(bool ok, const QString &error);
+
+private:
+    struct Run;
+    using RunPtr = std::shared_ptr<Run>;
+
+    void onExtracted(const RunPtr &run, int exitCode, QProcess::ExitStatus status);
+    void launchChunks(const RunPtr &run);
+    void startChunk(const RunPtr &run, int index);
+    void onWhisperFinished(const RunPtr &run, int index, QProcess *process);
+    void onChunkMerged(const RunPtr &run, const ChunkStats &chunk);
+    void finish(const RunPtr &run, bool ok, const QString &error);
+    void killProcesses(const RunPtr &run);
+
+    Config m_config;
+    // Разбор и дописывание в дорожку: у живой дорожки один писатель
+    QThreadPool m_worker;
+    RunPtr m_run;
+    LiveSubtitleTrackPtr m_track;
+    Stats m_stats;
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QString>
+#include <QVector>
+
+// Нарезка PCM WAV на перекрывающиеся куски для whisper без ffmpeg: заголовок
+// читается один раз, каждый кусок - это новый 44-байтный заголовок и
+// диапазон байтов исходника, скопированный блоками.
+namespace WavChunker {
+
+struct Format {
+    int sampleRate = 0;
+    int channels = 0;
+    int bitsPerSample = 0;
+    qint64 dataOffset = 0; // начало отсчётов в файле
+    qint64 dataBytes = 0;
+
+    int bytesPerFrame() const { return channels * bitsPerSample / 8; }
+    qint64 durationMs() const;
+};
+
+struct Chunk {
+    qint64 startMs = 0;
+    qint64 endMs = 0;
+};
+
+// Заголовок RIFF/WAVE с PCM (формат 1 или WAVE_FORMAT_EXTENSIBLE с PCM);
+// прочие чанки RIFF пропускаются
+bool readFormat(QIODevice &source, Format *format, QString *error = nullptr);
+
+// Куски по chunkMs с шагом chunkMs - overlapMs; последний обрезан по длительности
+QVector<Chunk> plan(qint64 durationMs, qint64 chunkMs, qint64 overlapMs);
+
+// Заголовок WAV для dataBytes байтов отсчётов в формате format
+QByteArray header(const Format &format, qint64 dataBytes);
+
+// Смещение и длина куска внутри данных, по границам кадров
+void byteRange(const Format &format, const Chunk &chunk, qint64 *offset, qint64 *length);
+
+// Пишет кусок как самостоятельный WAV; source должен поддерживать seek
+bool writeChunk(QIODevice &source, const Format &format, const Chunk &chunk, QIODevice &target,
+                QString *error = nullptr);
+bool writeChunk(QIODevice &source, const Format &format, const Chunk &chunk, const QString &path,
+                QString *error = nullptr);
+
+} // namespace WavChunker
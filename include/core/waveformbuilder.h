@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <atomic>
+#include "core/waveformpyramid.h"
+
+// Считает пирамиду огибающей для медиафайла. Звук декодируется ffmpeg
+// сегментами (по одному процессу на сегмент, несколько одновременно) прямо
+// в PCM 16 кГц моно; корзины считаются в рабочих потоках. Готовая пирамида
+// кладётся в MediaCache и при следующем открытии файла читается оттуда.
+class WaveformBuilder : public QObject {
+    Q_OBJECT
+public:
+    explicit WaveformBuilder(QObject *parent = nullptr);
+    ~WaveformBuilder() override;
+
+    // Отменяет предыдущий расчёт. durationMs нужна, чтобы заранее разбить файл на сегменты.
+    // Повторный вызов с тем же файлом и длительностью ничего не делает
+    void start(const QString &mediaPath, qint64 durationMs);
+    void cancel();
+
+    WaveformPyramidPtr pyramid() const { return m_pyramid; }
+
+signals:
+    // Появилась новая пирамида (пока пустая или уже из кэша)
+    void pyramidChanged(WaveformPyramidPtr pyramid);
+    // Досчитан очередной сегмент
+    void progressed();
+    void finished();
+
+private:
+    struct Run;
+    using RunPtr = std::shared_ptr<Run>;
+
+    void loadOrSchedule(const RunPtr &run, qint64 durationMs);
+    void computeSegment(const RunPtr &run, int segment);
+    void publish(const RunPtr &run, bool changed, bool last);
+
+    QThreadPool m_pool;
+    QString m_path;
+    qint64 m_durationMs = 0;
+    WaveformPyramidPtr m_pyramid;
+    std::atomic<quint64> m_generation{0};
+};
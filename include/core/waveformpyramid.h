@@ -0,0 +1,63 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Огибающая звука в одном корзине: размах и среднеквадратичное значение
+struct WaveformPeak {
+    qint16 min = 0;
+    qint16 max = 0;
+    quint16 rms = 0;
+};
+
+// Пирамида огибающей: уровень 0 - корзины по BucketSamples отсчётов
+// (16 мс при 16 кГц моно), каждый следующий вдвое грубее. Для столбца любой
+// ширины берётся уровень, где на столбец приходится одна-две корзины, так что
+// отрисовка стоит O(пикселей) при любом масштабе.
+//
+// Звук считается сегментами по SegmentBuckets корзин, независимо и параллельно.
+// Уровни до SegmentLevels - 1 целиком лежат внутри сегмента и строятся сразу,
+// поэтому готовые сегменты видны до окончания расчёта. Верхние уровни
+// появляются после finalize(). Запись - из рабочих потоков, каждый в свой
+// сегмент; чтение - из любого потока.
+class WaveformPyramid {
+public:
+    static constexpr int SampleRate = 16000;
+    static constexpr int BucketSamples = 256;
+    static constexpr int SegmentLevels = 12;
+    static constexpr int SegmentBuckets = 1 << (SegmentLevels - 1);
+
+    explicit WaveformPyramid(qint64 bucketCount);
+
+    qint64 bucketCount() const { return m_levels.empty() ? 0 : qint64(m_levels[0].size()); }
+    qint64 durationMs() const { return bucketCount() * BucketSamples * 1000 / SampleRate; }
+    int segmentCount() const { return m_segmentCount; }
+    bool isSegmentReady(int segment) const;
+    bool isComplete() const { return m_complete.load(std::memory_order_acquire); }
+
+    // Сводка по корзинам уровня 0 в [fromBucket, toBucket); false, если ни одна
+    // из них ещё не посчитана
+    bool peak(qint64 fromBucket, qint64 toBucket, WaveformPeak *out) const;
+
+    // Корзины уровня 0 для сегмента (не больше SegmentBuckets); недостающие - тишина
+    void setSegment(int segment, const QVector<WaveformPeak> &peaks);
+    // Достраивает верхние уровни; вызывать, когда готовы все сегменты
+    void finalize();
+
+    // Кэш на диске: только уровень 0, остальное пересчитывается при загрузке
+    bool save(const QString &cachePath, const QString &sourcePath) const;
+    static std::shared_ptr<WaveformPyramid> load(const QString &cachePath, const QString &sourcePath);
+
+private:
+    void buildLevels(qint64 fromBucket, qint64 toBucket, int lastLevel);
+
+    std::vector<std::vector<WaveformPeak>> m_levels;
+    int m_segmentCount = 0;
+    std::unique_ptr<std::atomic<bool>[]> m_ready;
+    std::atomic<bool> m_complete{false};
+};
+
+using WaveformPyramidPtr = std::shared_ptr<const WaveformPyramid>;
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <QSlider>
+#include <QImage>
+#include "core/waveformpyramid.h"
+#include "core/thumbnailatlas.h"
+
+class QStyleOptionSlider;
+class ThumbnailPreview;
+
+// Ползунок позиции с огибающей звука вместо жёлоба. Волна рисуется в
+// картинку один раз на размер (и на каждый досчитанный сегмент), по столбцу
+// на пиксель; при движении ползунка выводится готовая картинка.
+// При наведении показывает миниатюру кадра из атласа - без обращения к декодеру.
+// Значения ползунка - миллисекунды, как у m_positionSlider раньше.
+class SeekSlider : public QSlider {
+    Q_OBJECT
+
+public:
+    explicit SeekSlider(Qt::Orientation orientation, QWidget *parent = nullptr);
+
+    void setWaveform(WaveformPyramidPtr waveform);
+    // Досчитаны новые сегменты волны
+    void waveformUpdated();
+    void setThumbnails(ThumbnailAtlasPtr atlas);
+
+    QSize sizeHint() const override;
+    QSize minimumSizeHint() const override;
+
+    static constexpr int WaveformHeight = 36;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void sliderChange(SliderChange change) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void leaveEvent(QEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    // Прямоугольник волны и отрезок, по которому ходит центр ручки
+    QRect waveformRect(const QStyleOptionSlider &option, int *spanStart, int *spanLength) const;
+    void renderWaveform(const QStyleOptionSlider &option);
+    void showPreview(int x);
+    void hidePreview();
+
+    WaveformPyramidPtr m_waveform;
+    ThumbnailAtlasPtr m_thumbnails;
+    ThumbnailPreview *m_preview = nullptr;
+    QImage m_background;
+    bool m_backgroundDirty = true;
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QObject>
+#include <QImage>
+#include <QFont>
+#include <QCache>
+#include <QSet>
+#include <QString>
+#include <QThreadPool>
+#include "core/subtitletrack.h"
+
+// Ключ растра реплики: текст + ширина, под которую он переносится.
+// Стиль (шрифт, масштаб) в ключ не входит: при его смене кэш сбрасывается целиком
+struct SubtitleLayoutKey {
+    QString text;
+    int width;
+    bool operator==(const SubtitleLayoutKey &other) const { return width == other.width && text == other.text; }
+};
+
+inline size_t qHash(const SubtitleLayoutKey &key, size_t seed = 0)
+{
+    return qHashMulti(seed, key.text, key.width);
+}
+
+// Готовит картинки реплик (плашка + текст) заранее, в фоновом потоке.
+// Оверлею остаётся только вывести готовый QImage; промах кэша рендерится
+// синхронно, как раньше. Упреждение: следующие LookAhead реплик после
+// показанной и окрестность каждой цели перемотки.
+class SubtitleCueRenderer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit SubtitleCueRenderer(QObject *parent = nullptr);
+    ~SubtitleCueRenderer() override;
+
+    void setTrack(SubtitleTrackPtr track);
+    // Ширина переноса в координатах сцены и масштаб сцена -> пиксели экрана
+    void setGeometry(int textWidth, qreal scale);
+    void setFont(const QFont &font);
+    QFont font() const { return m_font; }
+
+    // Готовая картинка для текста; при промахе рисуется сразу и кладётся в кэш
+    QImage image(const QString &text);
+
+    void prefetchFrom(int index);
+    void prefetchAround(qint64 position);
+
+    static QImage render(const QString &text, const QFont &font, int textWidth, qreal scale);
+
+    static constexpr int LookAhead = 8;
+    static constexpr int LookBehind = 2;
+    static constexpr int CacheLimitKb = 32 * 1024;
+    static constexpr qreal PaddingX = 16;
+    static constexpr qreal PaddingY = 8;
+    static constexpr qreal MinHeight = 32;
+
+signals:
+    // Кэш сброшен (сменились геометрия или стиль) — оверлей должен перерисоваться
+    void invalidated();
+
+private:
+    void schedule(int from, int to);
+    void invalidate();
+    void store(const SubtitleLayoutKey &key, const QImage &image);
+
+    QThreadPool m_pool;
+    QCache<SubtitleLayoutKey, QImage> m_cache;
+    QSet<SubtitleLayoutKey> m_pending;
+    SubtitleTrackPtr m_track;
+    QFont m_font;
+    int m_width = 0;
+    qreal m_scale = 1.0;
+    quint64 m_generation = 0;
+};
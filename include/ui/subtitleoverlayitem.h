@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QGraphicsItem>
+#include <QImage>
+#include <QString>
+
+class SubtitleCueRenderer;
+
+// Постоянный элемент сцены для субтитров: создаётся один раз и только выводит
+// готовую картинку реплики (плашка + текст) из SubtitleCueRenderer. Если текст
+// не изменился, элемент не трогается; при смене перерисовывается только его область.
+class SubtitleOverlayItem : public QGraphicsItem {
+public:
+    explicit SubtitleOverlayItem(SubtitleCueRenderer *renderer, QGraphicsItem *parent = nullptr);
+
+    void setText(const QString &text);
+    // Прямоугольник кадра в координатах сцены; субтитры прижаты к его низу
+    void setFrameRect(const QRectF &frameRect);
+    // Картинка устарела (сменились масштаб или стиль) — взять заново
+    void refresh();
+
+    QRectF boundingRect() const override { return m_rect; }
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
+
+    static constexpr qreal WidthFraction = 0.8;
+    static constexpr qreal BottomMargin = 15;
+
+private:
+    void relayout();
+
+    SubtitleCueRenderer *m_renderer;
+    QString m_text;
+    QRectF m_frameRect;
+    QRectF m_rect;
+    QImage m_image;
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QWidget>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QLabel>
+#include <QTimer>
+#include "core/subtitletrack.h"
+#include "core/subtitlesearchindex.h"
+
+// Панель поиска по репликам: строка запроса и список найденного.
+// Индекс достраивается порциями в цикле событий, поэтому большая дорожка
+// не подвешивает интерфейс, а растущая дорожка живой транскрипции
+// дописывается без переиндексации.
+class SubtitleSearchPanel : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit SubtitleSearchPanel(QWidget *parent = nullptr);
+
+    // extendsPrevious - новая дорожка продолжает прежнюю (снимок той же живой дорожки)
+    void setTrack(SubtitleTrackPtr track, bool extendsPrevious = false);
+    void focusQuery();
+
+    static constexpr int IndexBatch = 2000;
+    static constexpr int MaxResults = 500;
+
+signals:
+    void seekRequested(qint64 position);
+
+private:
+    void indexMore();
+    void runQuery();
+
+    QLineEdit *m_query;
+    QListWidget *m_results;
+    QLabel *m_status;
+    QTimer m_indexTimer;
+    SubtitleTrackPtr m_track;
+    SubtitleSearchIndex m_index;
+};
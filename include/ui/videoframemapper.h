@@ -0,0 +1,58 @@
+#pragma once
+
+#include <QImage>
+#include <QVector>
+#include <QVideoFrame>
+#include <atomic>
+#include <memory>
+
+// Превращает QVideoFrame в QImage с минимумом копирования:
+//  - RGB-кадры в памяти отображаются и оборачиваются в QImage без копии,
+//    кадр снимается с отображения, когда последняя копия QImage освобождена;
+//  - NV12/NV21/YUV420P/YV12 конвертируются в RGB32 в буфер из фиксированного
+//    пула, который переиспользуется, как только картинку перестали держать;
+//  - всё прочее (текстуры GPU, экзотические форматы) - через QVideoFrame::toImage().
+// Если кадр хотя бы вдвое больше области вывода, он здесь же уменьшается
+// усреднением 2x2 (столько раз, сколько нужно), чтобы при отрисовке осталось
+// билинейное масштабирование с коэффициентом меньше двух.
+// Вызывается из одного потока - того, что поставляет кадры.
+class VideoFrameMapper {
+public:
+    explicit VideoFrameMapper(int poolSize = 4);
+
+    // targetSize - прямоугольник вывода кадра в пикселях устройства (пустой - без уменьшения).
+    // Пустой QImage, если кадр пустой или все буферы пула заняты (кадр пропущен)
+    QImage map(const QVideoFrame &frame, const QSize &targetSize = QSize());
+
+    struct Stats {
+        quint64 zeroCopy = 0;
+        quint64 converted = 0;
+        quint64 fallback = 0;
+        quint64 downscaled = 0;
+        quint64 dropped = 0;
+    };
+    Stats stats() const;
+
+private:
+    // Буфер пула; занят, пока жив QImage поверх него
+    struct Buffer {
+        std::unique_ptr<uchar[]> data;
+        QSize size;
+        QImage::Format format = QImage::Format_Invalid;
+        std::atomic<bool> busy{false};
+    };
+    using BufferPtr = std::shared_ptr<Buffer>;
+
+    QImage acquire(const QSize &size, QImage::Format format);
+    QImage toImage(const QVideoFrame &frame);
+    QImage convertYuv(const QVideoFrame &frame);
+    QImage halve(const QImage &image);
+
+    QVector<BufferPtr> m_pool;
+    int m_poolSize;
+    std::atomic<quint64> m_zeroCopy{0};
+    std::atomic<quint64> m_converted{0};
+    std::atomic<quint64> m_fallback{0};
+    std::atomic<quint64> m_downscaled{0};
+    std::atomic<quint64> m_dropped{0};
+};
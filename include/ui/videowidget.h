@@ -14,10 +14,23 @@
 #include <QMimeData>
 #include <QGraphicsView>
 #include <QGraphicsVideoItem>
-#include <QGraphicsTextItem>
-#include <QGraphicsRectItem>
 #include <QString>
+#include <QMutex>
+#include <QVideoSink>
+#include <QVideoFrame>
+#include "core/subtitletrack.h"
+#include "ui/subtitleoverlayitem.h"
+#include "ui/subtitlecuerenderer.h"
+#include "ui/videoframemapper.h"
 
+class PerfStats;
+
+// Программный вывод видео: кадры из собственного QVideoSink отображаются
+// (или конвертируются и уменьшаются) в потоке декодера и рисуются QPainter.
+// Плеер его не создаёт - он выводит видео через VideoGraphicsView, на
+// QGraphicsVideoItem которого висят оверлей субтитров, планировщик реплик,
+// координатор перемотки и оверлей статистики. Поэтому frameStats() в
+// PerfStats не попадает; виджет годится для встраивания без сцены.
 class VideoWidget : public QWidget {
     Q_OBJECT
 
@@ -28,6 +41,9 @@ public:
     void setFrame(const QImage &frame);
     void clear();
     QSize getVideoSize() const { return m_videoSize; }
+    // Приёмник кадров для QMediaPlayer::setVideoOutput
+    QVideoSink *videoSink() const { return m_videoSink; }
+    VideoFrameMapper::Stats frameStats() const { return m_frameMapper.stats(); }
 
 signals:
     void clicked();
@@ -42,11 +58,22 @@ protected:
     void keyPressEvent(QKeyEvent *event) override;
 
 private:
-    void updateScaledImage();
+    void updateTargetRect();
     qint64 positionFromMouse(const QPoint &pos) const;
+    void presentFrame(const QVideoFrame &frame);
+    void takePendingFrame();
+    void showFrame(const QImage &frame, const QSize &videoSize);
 
+    QVideoSink *m_videoSink;
+    VideoFrameMapper m_frameMapper;
+    // Последний подготовленный кадр; промежуточные, если GUI не успевает, затираются
+    QMutex m_pendingMutex;
+    QImage m_pendingFrame;
+    QSize m_pendingVideoSize;
+    bool m_pendingPosted = false;
+    QSize m_targetPixels; // под m_pendingMutex: поток декодера уменьшает кадр под него
     QImage m_currentFrame;
-    QImage m_scaledFrame;
+    QRect m_targetRect; // куда рисуется кадр; пересчитывается при смене размеров
     QSize m_videoSize;
     bool m_hasFrame;
     bool m_keepAspectRatio;
@@ -58,7 +85,7 @@ public:
     explicit DraggableVideoWidget(QWidget *parent = nullptr);
     virtual ~DraggableVideoWidget();
     void setSubtitleText(const QString &text);
-    void setSubtitles(const QMap<qint64, QString> &subtitles);
+    void setSubtitleTrack(SubtitleTrackPtr track);
     void clearSubtitles();
     void updateSubtitlePosition(qint64 position);
 
@@ -73,23 +100,44 @@ protected:
 
 private:
     QString m_subtitleText;
-    QMap<qint64, QString> m_subtitles;
+    SubtitleTrackPtr m_track;
+    SubtitleTrack::Cursor m_cursor;
+    int m_currentCue = -1;
 };
 
 class VideoGraphicsView : public QGraphicsView {
 public:
     explicit VideoGraphicsView(QWidget *parent = nullptr);
-    void setSubtitles(const QMap<qint64, QString> &subtitles);
+    void setSubtitleTrack(SubtitleTrackPtr track);
     void updateSubtitlePosition(qint64 position);
+    void showCue(int index);
+    void prefetchSubtitles(qint64 position);
     void clearSubtitles();
     void setSubtitlesVisible(bool visible);
+    SubtitleTrackPtr subtitleTrack() const { return m_track; }
     QGraphicsVideoItem* videoItem() const;
+    // Оверлей со статистикой в левом верхнем углу (см. PerfStats::format)
+    void setStatsVisible(bool visible);
+    bool statsVisible() const { return m_statsVisible; }
+    void setStatsText(const QString &text);
+    // Куда сообщать цену смены субтитров; nullptr - не замерять
+    void setPerfStats(PerfStats *stats) { m_perfStats = stats; }
 protected:
     void resizeEvent(QResizeEvent *event) override;
+    void drawForeground(QPainter *painter, const QRectF &rect) override;
 private:
+    void updateOverlayGeometry();
+    QRect statsRect() const;
+
     QGraphicsVideoItem *m_videoItem;
-    QGraphicsTextItem *m_subtitleItem;
-    QGraphicsRectItem *m_subtitleBg;
-    QMap<qint64, QString> m_subtitles;
+    SubtitleCueRenderer *m_cueRenderer;
+    SubtitleOverlayItem *m_overlay;
+    SubtitleTrackPtr m_track;
+    SubtitleTrack::Cursor m_cursor;
+    int m_currentCue = -1;
+    bool m_cueStale = false; // дорожка сменилась, m_currentCue относится к прежней
     bool m_subtitlesVisible;
+    PerfStats *m_perfStats = nullptr;
+    bool m_statsVisible = false;
+    QString m_statsText;
 }; 
\ No newline at end of file
@@ -0,0 +1,173 @@
+// Масштабирование экспорта с вшитыми субтитрами (SubtitleBurnExporter) по
+// числу параллельных процессов ffmpeg. Синтетическое видео (testsrc, ключевой
+// кадр каждые --gop секунд) и дорожка с репликой каждые две секунды
+// кодируются при 1, 2, 4 ... задачах вплоть до числа ядер; печатается время
+// и ускорение относительно одной задачи. Нужны ffmpeg и ffprobe в PATH.
+//
+//   simple_player_burn_bench [--seconds 120] [--gop 2] [--size 1280x720] [--jobs 1,2,4,8] [--json <файл>]
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+#include <QVector>
+#include <cstdio>
+#include "core/packetindex.h"
+#include "core/subtitleburnexporter.h"
+#include "core/subtitletrack.h"
+
+namespace {
+
+struct Result {
+    int jobs = 0;
+    bool ok = false;
+    qint64 wallMs = 0;
+};
+
+bool makeVideo(const QString &path, int seconds, int gop, const QString &size)
+{
+    QProcess ffmpeg;
+    ffmpeg.start("ffmpeg", QStringList{"-v", "error", "-nostdin", "-y",
+                                       "-f", "lavfi", "-i", QString("testsrc2=size=%1:rate=25:duration=%2").arg(size).arg(seconds),
+                                       "-f", "lavfi", "-i", QString("sine=frequency=440:duration=%1").arg(seconds),
+                                       "-c:v", "libx264", "-preset", "ultrafast", "-g", QString::number(gop * 25),
+                                       "-c:a", "aac", "-shortest", path});
+    if (!ffmpeg.waitForStarted() || !ffmpeg.waitForFinished(-1)) return false;
+    if (ffmpeg.exitStatus() != QProcess::NormalExit || ffmpeg.exitCode() != 0) {
+        fprintf(stderr, "%s", ffmpeg.readAllStandardError().constData());
+        return false;
+    }
+    return true;
+}
+
+SubtitleTrackPtr makeTrack(int seconds)
+{
+    QList<SubtitleCue> cues;
+    for (int s = 0; s + 2 <= seconds; s += 2) {
+        cues.append(SubtitleCue{qint64(s) * 1000, qint64(s) * 1000 + 1800, QString("Реплика номер %1").arg(s / 2 + 1)});
+    }
+    return std::make_shared<const SubtitleTrack>(SubtitleTrack::fromCues(cues));
+}
+
+QVector<int> defaultJobs()
+{
+    QVector<int> jobs;
+    const int cores = qMax(1, QThread::idealThreadCount());
+    for (int n = 1; n < cores; n *= 2) jobs.append(n);
+    jobs.append(cores);
+    return jobs;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Subtitle burn-in export scaling over parallel ffmpeg jobs");
+    parser.addHelpOption();
+    QCommandLineOption secondsOption("seconds", "Synthetic video length.", "s", "120");
+    QCommandLineOption gopOption("gop", "Keyframe interval in seconds.", "s", "2");
+    QCommandLineOption sizeOption("size", "Frame size.", "WxH", "1280x720");
+    QCommandLineOption jobsOption("jobs", "Comma-separated job counts (default: powers of two up to core count).", "list");
+    QCommandLineOption jsonOption("json", "Write results as JSON to <file>.", "file");
+    parser.addOptions({secondsOption, gopOption, sizeOption, jobsOption, jsonOption});
+    parser.process(app);
+
+    const int seconds = qMax(8, parser.value(secondsOption).toInt());
+    const int gop = qMax(1, parser.value(gopOption).toInt());
+    QVector<int> jobCounts;
+    for (const QString &part : parser.value(jobsOption).split(',', Qt::SkipEmptyParts)) {
+        if (part.toInt() > 0) jobCounts.append(part.toInt());
+    }
+    if (jobCounts.isEmpty()) jobCounts = defaultJobs();
+
+    QTemporaryDir workDir;
+    const QString videoPath = workDir.filePath("source.mp4");
+    if (!workDir.isValid() || !makeVideo(videoPath, seconds, gop, parser.value(sizeOption))) {
+        fprintf(stderr, "cannot create the synthetic video (is ffmpeg in PATH?)\n");
+        return 1;
+    }
+    // Индекс пакетов строится и кэшируется заранее: меряем только кодирование
+    QString probeError;
+    if (!PacketIndex::loadOrBuild(videoPath, &probeError)) {
+        fprintf(stderr, "%s\n", qPrintable(probeError));
+        return 1;
+    }
+    const SubtitleTrackPtr track = makeTrack(seconds);
+
+    QTextStream out(stdout);
+    out << QString("%1 s of %2, keyframe every %3 s, %4 cores\n")
+               .arg(seconds).arg(parser.value(sizeOption)).arg(gop).arg(QThread::idealThreadCount());
+    out << QString("%1 %2 %3").arg("jobs", 5).arg("wall s", 8).arg("speedup", 8) << '\n';
+    out.flush();
+
+    QVector<Result> results;
+    bool allOk = true;
+    for (int jobs : jobCounts) {
+        Result result;
+        result.jobs = jobs;
+        SubtitleBurnExporter exporter;
+        exporter.setMaxParallelJobs(jobs);
+        QEventLoop loop;
+        QObject::connect(&exporter, &SubtitleBurnExporter::finished, [&](bool ok, const QString &error) {
+            result.ok = ok;
+            if (!ok) fprintf(stderr, "%d jobs: %s\n", jobs, qPrintable(error));
+            loop.quit();
+        });
+        QElapsedTimer clock;
+        clock.start();
+        exporter.start(videoPath, workDir.filePath(QString("burned_%1.mp4").arg(jobs)), track);
+        if (exporter.isRunning()) loop.exec();
+        result.wallMs = clock.elapsed();
+        allOk = allOk && result.ok;
+        results.append(result);
+
+        const double base = results.first().wallMs;
+        out << QString("%1 %2 %3").arg(jobs, 5).arg(result.wallMs / 1000.0, 8, 'f', 2)
+                   .arg(result.wallMs > 0 ? base / result.wallMs : 0.0, 8, 'f', 2)
+            << (result.ok ? "" : "  FAILED") << '\n';
+        out.flush();
+        QFile::remove(workDir.filePath(QString("burned_%1.mp4").arg(jobs)));
+    }
+
+    if (parser.isSet(jsonOption)) {
+        QJsonArray runs;
+        for (const Result &r : results) {
+            QJsonObject item;
+            item["jobs"] = r.jobs;
+            item["ok"] = r.ok;
+            item["wall_ms"] = double(r.wallMs);
+            runs.append(item);
+        }
+        QJsonObject machine;
+        machine["host"] = QSysInfo::machineHostName();
+        machine["os"] = QSysInfo::prettyProductName();
+        machine["cpu"] = QSysInfo::currentCpuArchitecture();
+        machine["cores"] = QThread::idealThreadCount();
+        machine["qt"] = QString(qVersion());
+        QJsonObject root;
+        root["machine"] = machine;
+        root["seconds"] = seconds;
+        root["gop"] = gop;
+        root["size"] = parser.value(sizeOption);
+        root["runs"] = runs;
+        QFile file(parser.value(jsonOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            fprintf(stderr, "cannot write %s\n", qPrintable(parser.value(jsonOption)));
+            return 1;
+        }
+        file.write(QJsonDocument(root).toJson());
+    }
+    return allOk ? 0 : 1;
+}
@@ -0,0 +1,257 @@
+// Проверка ModelDownloader на локальном HTTP-сервере (QTcpServer вместо
+// Hugging Face). Сервер отдаёт файл целиком или по Range, сверяет If-Range с
+// текущим ETag и умеет оборвать соединение на середине. Сценарии: докачка
+// с Range/If-Range, смена файла на сервере между попытками, несовпадение
+// контрольной суммы, файл без эталонной суммы и замена уже скачанного файла.
+// Печатает PASS/FAIL по каждому сценарию; код возврата - число провалов.
+//
+//   simple_player_download_check
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QNetworkAccessManager>
+#include <QRandomGenerator>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QTimer>
+#include <QVector>
+#include <cstdio>
+#include "core/modeldownloader.h"
+
+namespace {
+
+// Минимальный HTTP/1.1: один запрос на соединение, Connection: close
+class StandInServer : public QObject {
+public:
+    struct Request {
+        QByteArray range;
+        QByteArray ifRange;
+        int status = 0;
+    };
+
+    QByteArray body;
+    QByteArray etag;       // пустой - заголовок ETag не отправляется
+    qint64 dropAfter = -1; // оборвать следующий ответ после стольких байт тела
+    QVector<Request> requests;
+
+    bool listen()
+    {
+        connect(&m_server, &QTcpServer::newConnection, this, [this]() {
+            while (QTcpSocket *socket = m_server.nextPendingConnection()) {
+                connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+                connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+            }
+        });
+        return m_server.listen(QHostAddress::LocalHost);
+    }
+
+    QUrl url() const { return QUrl(QString("http://127.0.0.1:%1/model.bin").arg(m_server.serverPort())); }
+
+private:
+    void onReadyRead(QTcpSocket *socket)
+    {
+        QByteArray &buffer = m_buffers[socket];
+        buffer += socket->readAll();
+        const int end = buffer.indexOf("\r\n\r\n");
+        if (end < 0) return;
+
+        Request request;
+        for (const QByteArray &line : buffer.left(end).split('\n')) {
+            const int colon = line.indexOf(':');
+            if (colon < 0) continue;
+            const QByteArray name = line.left(colon).trimmed().toLower();
+            const QByteArray value = line.mid(colon + 1).trimmed();
+            if (name == "range") request.range = value;
+            else if (name == "if-range") request.ifRange = value;
+        }
+        m_buffers.remove(socket);
+
+        // If-Range с чужим валидатором - файл изменился, отдаём целиком
+        qint64 start = 0;
+        if (request.range.startsWith("bytes=") && (request.ifRange.isEmpty() || request.ifRange == etag)) {
+            start = request.range.mid(6, request.range.indexOf('-') - 6).toLongLong();
+        }
+        QByteArray head;
+        if (start >= body.size() && start > 0) {
+            request.status = 416;
+            head = "HTTP/1.1 416 Range Not Satisfiable\r\nContent-Range: bytes */" + QByteArray::number(body.size())
+                   + "\r\nContent-Length: 0\r\n";
+        } else if (start > 0) {
+            request.status = 206;
+            head = "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes " + QByteArray::number(start) + "-"
+                   + QByteArray::number(body.size() - 1) + "/" + QByteArray::number(body.size())
+                   + "\r\nContent-Length: " + QByteArray::number(body.size() - start) + "\r\n";
+        } else {
+            request.status = 200;
+            head = "HTTP/1.1 200 OK\r\nContent-Length: " + QByteArray::number(body.size()) + "\r\n";
+        }
+        if (!etag.isEmpty()) head += "ETag: " + etag + "\r\n";
+        head += "Accept-Ranges: bytes\r\nConnection: close\r\n\r\n";
+        requests.append(request);
+
+        QByteArray payload = request.status == 416 ? QByteArray() : body.mid(start);
+        if (dropAfter >= 0) {
+            payload.truncate(int(dropAfter));
+            dropAfter = -1;
+        }
+        socket->write(head + payload);
+        socket->disconnectFromHost();
+    }
+
+    QTcpServer m_server;
+    QHash<QTcpSocket *, QByteArray> m_buffers;
+};
+
+struct Outcome {
+    bool ok = false;
+    bool verified = false;
+    QString error;
+};
+
+Outcome download(QNetworkAccessManager *nam, const QUrl &url, const QString &target,
+                 const QByteArray &expectedSha256 = QByteArray())
+{
+    Outcome outcome;
+    ModelDownloader downloader(nam);
+    QEventLoop loop;
+    bool done = false;
+    QObject::connect(&downloader, &ModelDownloader::finished, [&](bool ok, const QString &error) {
+        outcome.ok = ok;
+        outcome.verified = downloader.isVerified();
+        outcome.error = error;
+        done = true;
+        loop.quit();
+    });
+    // Зависший сценарий не должен вешать весь прогон
+    QTimer::singleShot(30000, &loop, [&]() {
+        outcome.error = "timeout";
+        downloader.abort();
+    });
+    downloader.start(url, target, expectedSha256);
+    if (!done) loop.exec();
+    return outcome;
+}
+
+QByteArray randomBlob(int size, quint32 seed)
+{
+    QByteArray blob(size, Qt::Uninitialized);
+    QRandomGenerator generator(seed);
+    generator.fillRange(reinterpret_cast<quint32 *>(blob.data()), size / int(sizeof(quint32)));
+    return blob;
+}
+
+QByteArray sha256Hex(const QByteArray &data)
+{
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha256).toHex();
+}
+
+QByteArray readFile(const QString &path)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    int failures = 0;
+    auto check = [&](const char *name, bool passed, const QString &detail) {
+        out << (passed ? "PASS " : "FAIL ") << name << (passed || detail.isEmpty() ? QString() : ": " + detail) << '\n';
+        out.flush();
+        if (!passed) ++failures;
+    };
+
+    StandInServer server;
+    if (!server.listen()) {
+        fprintf(stderr, "cannot listen on 127.0.0.1\n");
+        return 1;
+    }
+    QNetworkAccessManager nam;
+    QTemporaryDir dir;
+    const int size = 3 * 1024 * 1024 + 123 * 4;
+    const QByteArray first = randomBlob(size, 1);
+    const QByteArray second = randomBlob(size, 2);
+
+    // 1. Обрыв на середине, затем докачка: Range с места обрыва и If-Range с ETag
+    {
+        const QString target = dir.filePath("resume.bin");
+        server.body = first;
+        server.etag = '"' + sha256Hex(first) + '"';
+        server.requests.clear();
+        server.dropAfter = size / 2 + 7;
+        const Outcome interrupted = download(&nam, server.url(), target);
+        const qint64 partSize = QFileInfo(ModelDownloader::partialPath(target)).size();
+        const Outcome resumed = download(&nam, server.url(), target);
+        const bool headersOk = server.requests.size() == 2
+                               && server.requests[1].range == "bytes=" + QByteArray::number(partSize) + "-"
+                               && server.requests[1].ifRange == server.etag && server.requests[1].status == 206;
+        check("resume with Range/If-Range",
+              !interrupted.ok && partSize == size / 2 + 7 && headersOk && resumed.ok && resumed.verified
+                  && readFile(target) == first && !QFile::exists(ModelDownloader::partialPath(target)),
+              QString("part %1 bytes, %2 requests, resumed: %3").arg(partSize).arg(server.requests.size())
+                  .arg(resumed.ok ? "ok" : resumed.error));
+    }
+
+    // 2. Между попытками файл на сервере сменился: If-Range не совпал, приходит
+    //    200 с новым содержимым, старая часть отбрасывается
+    {
+        const QString target = dir.filePath("changed.bin");
+        server.body = first;
+        server.etag = '"' + sha256Hex(first) + '"';
+        server.requests.clear();
+        server.dropAfter = size / 3;
+        download(&nam, server.url(), target);
+        server.body = second;
+        server.etag = '"' + sha256Hex(second) + '"';
+        const Outcome resumed = download(&nam, server.url(), target);
+        const bool fullResponse = server.requests.size() == 2 && !server.requests[1].range.isEmpty()
+                                  && server.requests[1].status == 200;
+        check("changed validator restarts the download",
+              fullResponse && resumed.ok && resumed.verified && readFile(target) == second,
+              resumed.ok ? QString("file or response mismatch") : resumed.error);
+    }
+
+    // 3. Эталонная сумма не совпала: ошибка, ни .part, ни итогового файла
+    {
+        const QString target = dir.filePath("mismatch.bin");
+        server.body = first;
+        server.etag = "\"v1\"";
+        const Outcome outcome = download(&nam, server.url(), target, sha256Hex(second));
+        check("checksum mismatch is rejected",
+              !outcome.ok && !QFile::exists(target) && !QFile::exists(ModelDownloader::partialPath(target)),
+              outcome.ok ? QString("download accepted") : outcome.error);
+    }
+
+    // 4. Эталона нет нигде: файл принят, но помечен непроверенным
+    {
+        const QString target = dir.filePath("unverified.bin");
+        server.body = first;
+        server.etag = "\"v1\"";
+        const Outcome outcome = download(&nam, server.url(), target);
+        check("no reference checksum is reported as unverified",
+              outcome.ok && !outcome.verified && readFile(target) == first, outcome.error);
+    }
+
+    // 5. Уже скачанный файл заменяется новым
+    {
+        const QString target = dir.filePath("replace.bin");
+        QFile old(target);
+        if (old.open(QIODevice::WriteOnly)) old.write("old model");
+        old.close();
+        server.body = second;
+        server.etag = '"' + sha256Hex(second) + '"';
+        const Outcome outcome = download(&nam, server.url(), target);
+        check("existing file is replaced", outcome.ok && readFile(target) == second, outcome.error);
+    }
+
+    return failures;
+}
@@ -0,0 +1,468 @@
+// Микробенчмарки горячих путей субтитров и аудио на синтетических данных:
+// разбор SRT, построение дорожки и поиск реплик, раскладка плашки оверлея,
+// нарезка PCM на чанки для whisper. Печатает ns/op, выделения памяти на
+// операцию и пропускную способность; --json пишет то же для сравнения
+// прогонов, --compare сравнивает с сохранённым.
+//
+//   simple_player_bench [--quick] [--filter <подстрока>] [--json <файл>] [--compare <файл>]
+
+#include <QByteArray>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFont>
+#include <QGuiApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QSysInfo>
+#include <QTextStream>
+#include <QVector>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include "core/srtparser.h"
+#include "core/subtitletrack.h"
+#include "core/wavchunker.h"
+#include "ui/subtitlecuerenderer.h"
+
+// --- Счётчик выделений памяти ---
+// На glibc перехватывается malloc: через него идут и operator new, и
+// контейнеры Qt. На прочих платформах считается только operator new.
+namespace {
+std::atomic<quint64> g_allocations{0};
+std::atomic<quint64> g_allocatedBytes{0};
+
+inline void countAllocation(size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+}
+}
+
+#if defined(__GLIBC__)
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size)
+{
+    countAllocation(size);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    countAllocation(count * size);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    countAllocation(size);
+    return __libc_realloc(ptr, size);
+}
+}
+#else
+void *operator new(size_t size)
+{
+    countAllocation(size);
+    if (void *p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+    std::free(p);
+}
+#endif
+
+namespace {
+
+struct Result {
+    QString name;
+    qint64 size = 0;       // параметр входа: число реплик, секунд аудио...
+    quint64 ops = 0;       // операций за все замеренные прогоны
+    double nsPerOp = 0;
+    double allocsPerOp = 0;
+    double allocBytesPerOp = 0;
+    double bytesPerSecond = 0; // 0 - не применимо
+};
+
+const qint64 MinRunNs = 300 * 1000 * 1000;
+const int MaxRuns = 1000;
+
+// Прогревочный прогон, затем прогоны, пока не наберётся MinRunNs.
+// run() возвращает число операций за прогон; bytesPerRun - объём входа
+template <typename Fn>
+Result measure(const QString &name, qint64 size, qint64 bytesPerRun, Fn run)
+{
+    run();
+    Result result;
+    result.name = name;
+    result.size = size;
+    const quint64 allocationsBefore = g_allocations.load();
+    const quint64 bytesBefore = g_allocatedBytes.load();
+    QElapsedTimer timer;
+    timer.start();
+    int runs = 0;
+    while (runs < MaxRuns && (runs == 0 || timer.nsecsElapsed() < MinRunNs)) {
+        result.ops += quint64(run());
+        ++runs;
+    }
+    const qint64 elapsed = timer.nsecsElapsed();
+    const double ops = double(qMax<quint64>(result.ops, 1));
+    result.nsPerOp = double(elapsed) / ops;
+    result.allocsPerOp = double(g_allocations.load() - allocationsBefore) / ops;
+    result.allocBytesPerOp = double(g_allocatedBytes.load() - bytesBefore) / ops;
+    if (bytesPerRun > 0 && elapsed > 0) {
+        result.bytesPerSecond = double(bytesPerRun) * runs * 1e9 / double(elapsed);
+    }
+    return result;
+}
+
+// Оптимизатор не должен выбросить результат ядра
+template <typename T>
+void keep(const T &value)
+{
+    static volatile const void *sink;
+    sink = &value;
+}
+
+quint32 nextRandom(quint32 &state)
+{
+    state = state * 1664525u + 1013904223u;
+    return state;
+}
+
+QString srtTime(qint64 ms)
+{
+    return QString("%1:%2:%3,%4")
+        .arg(ms / 3600000, 2, 10, QChar('0'))
+        .arg((ms / 60000) % 60, 2, 10, QChar('0'))
+        .arg((ms / 1000) % 60, 2, 10, QChar('0'))
+        .arg(ms % 1000, 3, 10, QChar('0'));
+}
+
+// Реплики по 2-3 с, кириллица вперемешку с латиницей, иногда в две строки
+QByteArray syntheticSrt(int cues)
+{
+    static const char *const words[] = {
+        "привет", "мир", "субтитры", "video", "player", "сегодня", "мы", "посмотрим",
+        "как", "это", "работает", "frame", "время", "звук", "модель", "whisper",
+    };
+    quint32 state = 12345;
+    QByteArray out;
+    out.reserve(qsizetype(cues) * 90);
+    qint64 time = 0;
+    for (int i = 0; i < cues; ++i) {
+        const qint64 start = time + 100 + nextRandom(state) % 400;
+        const qint64 end = start + 2000 + nextRandom(state) % 1000;
+        time = end;
+        out += QByteArray::number(i + 1) + "\r\n";
+        out += (srtTime(start) + " --> " + srtTime(end)).toLatin1() + "\r\n";
+        const int lines = 1 + int(nextRandom(state) % 2);
+        for (int line = 0; line < lines; ++line) {
+            const int count = 3 + int(nextRandom(state) % 5);
+            for (int w = 0; w < count; ++w) {
+                if (w) out += ' ';
+                out += words[nextRandom(state) % (sizeof(words) / sizeof(words[0]))];
+            }
+            out += "\r\n";
+        }
+        out += "\r\n";
+    }
+    return out;
+}
+
+// PCM 16 кГц моно, как у извлечённой для whisper дорожки; отсчёты генерируются
+// на лету, так что часы аудио не занимают память
+class SyntheticPcm : public QIODevice {
+public:
+    explicit SyntheticPcm(qint64 seconds)
+    {
+        m_format.sampleRate = 16000;
+        m_format.channels = 1;
+        m_format.bitsPerSample = 16;
+        m_format.dataOffset = 44;
+        m_format.dataBytes = seconds * m_format.sampleRate * 2;
+        m_header = WavChunker::header(m_format, m_format.dataBytes);
+        // Пила с периодом 256 отсчётов; шаблон кратен периоду, чтобы копировать блоками
+        m_pattern.resize(64 * 1024);
+        for (int i = 0; i < m_pattern.size() / 2; ++i) {
+            const quint16 value = quint16(qint16((i & 0xff) * 64 - 8192));
+            m_pattern[2 * i] = char(value & 0xff);
+            m_pattern[2 * i + 1] = char(value >> 8);
+        }
+        open(QIODevice::ReadOnly);
+    }
+    bool isSequential() const override { return false; }
+    qint64 size() const override { return 44 + m_format.dataBytes; }
+
+protected:
+    // Копирование из шаблона - то же, что чтение файла из кэша страниц
+    qint64 readData(char *data, qint64 maxSize) override
+    {
+        qint64 position = pos();
+        const qint64 count = qMin(maxSize, size() - position);
+        qint64 done = 0;
+        while (done < count) {
+            qint64 piece;
+            if (position < 44) {
+                piece = qMin(count - done, 44 - position);
+                memcpy(data + done, m_header.constData() + position, size_t(piece));
+            } else {
+                const qint64 offset = (position - 44) % qint64(m_pattern.size());
+                piece = qMin(count - done, qint64(m_pattern.size()) - offset);
+                memcpy(data + done, m_pattern.constData() + offset, size_t(piece));
+            }
+            done += piece;
+            position += piece;
+        }
+        return count;
+    }
+    qint64 writeData(const char *, qint64) override { return -1; }
+
+private:
+    WavChunker::Format m_format;
+    QByteArray m_header;
+    QByteArray m_pattern;
+};
+
+// Приёмник, который всё принимает и ничего не хранит
+class NullDevice : public QIODevice {
+public:
+    NullDevice() { open(QIODevice::WriteOnly); }
+
+protected:
+    qint64 readData(char *, qint64) override { return -1; }
+    qint64 writeData(const char *, qint64 size) override { return size; }
+};
+
+// --- Ядра ---
+
+void benchSrt(QVector<Result> &results, const QVector<int> &sizes, const QString &filter)
+{
+    for (int cues : sizes) {
+        const QByteArray srt = syntheticSrt(cues);
+        if (QString("srt_parse").contains(filter)) {
+            results.append(measure("srt_parse", cues, srt.size(), [&]() {
+                const QList<SubtitleCue> parsed = SrtParser::parse(srt);
+                keep(parsed);
+                return qint64(parsed.size());
+            }));
+        }
+
+        const QList<SubtitleCue> parsed = SrtParser::parse(srt);
+        if (QString("track_build").contains(filter)) {
+            results.append(measure("track_build", cues, 0, [&]() {
+                const SubtitleTrack track = SubtitleTrack::fromCues(parsed);
+                keep(track);
+                return qint64(track.size());
+            }));
+        }
+
+        const SubtitleTrack track = SubtitleTrack::fromCues(parsed);
+        const qint64 duration = track.isEmpty() ? 0 : track.end(track.size() - 1);
+        if (QString("track_cursor_playback").contains(filter)) {
+            // Воспроизведение: позиция растёт на кадр (40 мс)
+            results.append(measure("track_cursor_playback", cues, 0, [&]() {
+                SubtitleTrack::Cursor cursor;
+                qint64 lookups = 0;
+                int visible = 0;
+                for (qint64 position = 0; position < duration; position += 40, ++lookups) {
+                    visible += cursor.seek(track, position) >= 0;
+                }
+                keep(visible);
+                return lookups;
+            }));
+        }
+        if (QString("track_random_lookup").contains(filter)) {
+            // Перемотки: произвольные позиции, бинарный поиск
+            results.append(measure("track_random_lookup", cues, 0, [&]() {
+                quint32 state = 777;
+                const int lookups = 100000;
+                int visible = 0;
+                for (int i = 0; i < lookups; ++i) {
+                    visible += track.indexAt(qint64(nextRandom(state) % quint32(qMax<qint64>(duration, 1)))) >= 0;
+                }
+                keep(visible);
+                return qint64(lookups);
+            }));
+        }
+    }
+}
+
+void benchOverlayLayout(QVector<Result> &results, const QString &filter)
+{
+    if (!QString("overlay_layout").contains(filter)) return;
+    const QList<SubtitleCue> cues = SrtParser::parse(syntheticSrt(500));
+    QFont font;
+    font.setPointSize(20);
+    font.setBold(true);
+    // Ширина переноса и масштаб - как у окна 1280 px на экране с плотностью 2
+    results.append(measure("overlay_layout", cues.size(), 0, [&]() {
+        qint64 pixels = 0;
+        for (const SubtitleCue &cue : cues) {
+            pixels += SubtitleCueRenderer::render(cue.text, font, 1024, 2.0).sizeInBytes();
+        }
+        keep(pixels);
+        return qint64(cues.size());
+    }));
+}
+
+void benchChunkSlicing(QVector<Result> &results, const QVector<qint64> &durations, const QString &filter)
+{
+    if (!QString("wav_chunk_slice").contains(filter)) return;
+    for (qint64 seconds : durations) {
+        SyntheticPcm source(seconds);
+        NullDevice sink;
+        WavChunker::Format format;
+        if (!WavChunker::readFormat(source, &format)) {
+            fprintf(stderr, "synthetic WAV rejected\n");
+            continue;
+        }
+        const QVector<WavChunker::Chunk> chunks = WavChunker::plan(format.durationMs(), 15000, 2000);
+        // Каждый чанк читается целиком, с перекрытием, как для whisper
+        qint64 bytes = 0;
+        for (const WavChunker::Chunk &chunk : chunks) {
+            qint64 offset = 0;
+            qint64 length = 0;
+            WavChunker::byteRange(format, chunk, &offset, &length);
+            bytes += length;
+        }
+        results.append(measure("wav_chunk_slice", seconds, bytes, [&]() {
+            for (const WavChunker::Chunk &chunk : chunks) {
+                WavChunker::writeChunk(source, format, chunk, sink);
+            }
+            return qint64(chunks.size());
+        }));
+    }
+}
+
+QString resultKey(const QString &name, qint64 size)
+{
+    return name + '/' + QString::number(size);
+}
+
+QJsonDocument toJson(const QVector<Result> &results)
+{
+    QJsonArray benchmarks;
+    for (const Result &r : results) {
+        QJsonObject item;
+        item["name"] = r.name;
+        item["size"] = r.size;
+        item["ops"] = double(r.ops);
+        item["ns_per_op"] = r.nsPerOp;
+        item["allocs_per_op"] = r.allocsPerOp;
+        item["alloc_bytes_per_op"] = r.allocBytesPerOp;
+        if (r.bytesPerSecond > 0) item["bytes_per_second"] = r.bytesPerSecond;
+        benchmarks.append(item);
+    }
+    QJsonObject machine;
+    machine["host"] = QSysInfo::machineHostName();
+    machine["os"] = QSysInfo::prettyProductName();
+    machine["cpu"] = QSysInfo::currentCpuArchitecture();
+    machine["qt"] = QString(qVersion());
+    QJsonObject root;
+    root["machine"] = machine;
+    root["benchmarks"] = benchmarks;
+    return QJsonDocument(root);
+}
+
+QMap<QString, double> loadBaseline(const QString &path)
+{
+    QMap<QString, double> baseline;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return baseline;
+    const QJsonArray benchmarks = QJsonDocument::fromJson(file.readAll()).object().value("benchmarks").toArray();
+    for (const QJsonValue &value : benchmarks) {
+        const QJsonObject item = value.toObject();
+        baseline.insert(resultKey(item.value("name").toString(), qint64(item.value("size").toDouble())),
+                        item.value("ns_per_op").toDouble());
+    }
+    return baseline;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    // Раскладка текста требует QGuiApplication, но не экрана
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Microbenchmarks for subtitle and audio hot paths");
+    parser.addHelpOption();
+    QCommandLineOption quickOption("quick", "Small inputs only (for a smoke run).");
+    QCommandLineOption filterOption("filter", "Run only benchmarks whose name contains <text>.", "text");
+    QCommandLineOption jsonOption("json", "Write results as JSON to <file>.", "file");
+    QCommandLineOption compareOption("compare", "Compare ns/op with a previous --json <file>.", "file");
+    parser.addOptions({quickOption, filterOption, jsonOption, compareOption});
+    parser.process(app);
+
+    const bool quick = parser.isSet(quickOption);
+    const QString filter = parser.value(filterOption);
+    const QVector<int> cueCounts = quick ? QVector<int>{10000} : QVector<int>{10000, 100000, 1000000};
+    // 10 минут, 1 час и 4 часа аудио
+    const QVector<qint64> pcmSeconds = quick ? QVector<qint64>{600} : QVector<qint64>{600, 3600, 4 * 3600};
+
+    QVector<Result> results;
+    benchSrt(results, cueCounts, filter);
+    benchOverlayLayout(results, filter);
+    benchChunkSlicing(results, pcmSeconds, filter);
+
+    const QMap<QString, double> baseline = parser.isSet(compareOption)
+        ? loadBaseline(parser.value(compareOption)) : QMap<QString, double>();
+    QTextStream out(stdout);
+    out << QString("%1 %2 %3 %4 %5 %6")
+               .arg("benchmark", -24).arg("size", 9).arg("ns/op", 12).arg("allocs/op", 10)
+               .arg("MB/s", 9).arg(baseline.isEmpty() ? QString() : QString("vs base"), 9)
+        << '\n';
+    for (const Result &r : results) {
+        QString delta;
+        const double base = baseline.value(resultKey(r.name, r.size), 0);
+        if (base > 0) delta = QString("%1%2%").arg(r.nsPerOp >= base ? "+" : "").arg((r.nsPerOp / base - 1) * 100, 0, 'f', 1);
+        out << QString("%1 %2 %3 %4 %5 %6")
+                   .arg(r.name, -24).arg(r.size, 9).arg(r.nsPerOp, 12, 'f', 1).arg(r.allocsPerOp, 10, 'f', 2)
+                   .arg(r.bytesPerSecond > 0 ? QString::number(r.bytesPerSecond / (1024 * 1024), 'f', 0) : QString("-"), 9)
+                   .arg(delta, 9)
+            << '\n';
+    }
+    out.flush();
+
+    if (parser.isSet(jsonOption)) {
+        QFile file(parser.value(jsonOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            fprintf(stderr, "cannot write %s\n", qPrintable(parser.value(jsonOption)));
+            return 1;
+        }
+        file.write(toJson(results).toJson());
+    }
+    return 0;
+}
@@ -0,0 +1,346 @@
+// Сравнение моделей whisper по скорости, памяти и точности на локальном
+// корпусе. Каждый медиафайл каталога (эталон - субтитры рядом, как их ищет
+// плеер: movie.srt или movie.ru.srt) расшифровывается каждой скачанной
+// моделью при каждой настройке нарезки тем же конвейером, что и в плеере.
+// Итоговая таблица на модель и нарезку: realtime factor (весь конвейер и
+// только whisper), пиковая RSS дочерних процессов и WER по корпусу.
+// Файлы без эталона учитываются в скорости и памяти, WER для них нет.
+//
+//   simple_player_model_compare [--corpus <каталог>] [--models-dir <каталог>] [--models tiny,base]
+//                               [--chunking 15000/2000,30000/2000] [--concurrency N]
+//                               [--whisper <путь>] [--ffmpeg <путь>] [--language ru] [--json <файл>]
+//
+// Для проверки на дыму хватит корня репозитория: test_video.mp4 и
+// test_audio.mp3 (эталонов у них нет, WER будет пустым).
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QRegularExpression>
+#include <QSysInfo>
+#include <QTextStream>
+#include <QVector>
+#include <cstdio>
+#include <utility>
+#include "core/subtitleloader.h"
+#include "core/transcriptionpipeline.h"
+#include "rsssampler.h"
+
+namespace {
+
+struct Chunking {
+    qint64 chunkMs = 0;
+    qint64 overlapMs = 0;
+
+    QString label() const { return QString("%1/%2").arg(chunkMs / 1000.0).arg(overlapMs / 1000.0); }
+};
+
+struct Run {
+    QString media;
+    QString model;
+    Chunking chunking;
+    bool ok = false;
+    qint64 audioMs = 0;
+    qint64 wallMs = 0;
+    qint64 whisperMs = 0;
+    qint64 peakRss = 0;
+    int referenceWords = -1; // -1 - нет эталона
+    int errors = 0;          // замены + вставки + удаления
+};
+
+// Слова для WER: без регистра, пунктуации и пометок вроде "[музыка]", ё = е
+QStringList words(const SubtitleTrack &track)
+{
+    static const QRegularExpression annotations(R"(\[[^\]]*\]|\([^)]*\))");
+    QStringList result;
+    for (int i = 0; i < track.size(); ++i) {
+        QString text = track.text(i).toString().toLower();
+        text.remove(annotations);
+        text.replace(QChar(0x0451), QChar(0x0435));
+        QString word;
+        for (const QChar c : text) {
+            if (c.isLetterOrNumber()) {
+                word.append(c);
+            } else if (!word.isEmpty()) {
+                result.append(word);
+                word.clear();
+            }
+        }
+        if (!word.isEmpty()) result.append(word);
+    }
+    return result;
+}
+
+// Расстояние Левенштейна по словам, две строки таблицы
+int editDistance(const QStringList &reference, const QStringList &hypothesis)
+{
+    QVector<int> previous(hypothesis.size() + 1);
+    QVector<int> current(hypothesis.size() + 1);
+    for (int j = 0; j <= hypothesis.size(); ++j) previous[j] = j;
+    for (int i = 1; i <= reference.size(); ++i) {
+        current[0] = i;
+        for (int j = 1; j <= hypothesis.size(); ++j) {
+            const int substitution = previous[j - 1] + (reference[i - 1] == hypothesis[j - 1] ? 0 : 1);
+            current[j] = qMin(substitution, qMin(previous[j], current[j - 1]) + 1);
+        }
+        std::swap(previous, current);
+    }
+    return previous[hypothesis.size()];
+}
+
+QStringList corpusFiles(const QString &dir)
+{
+    const QStringList patterns{"*.mp4", "*.mkv", "*.avi", "*.mov", "*.webm", "*.m4v",
+                               "*.mp3", "*.wav", "*.m4a", "*.flac", "*.ogg", "*.opus"};
+    QStringList files;
+    const QDir corpus(dir);
+    for (const QString &name : corpus.entryList(patterns, QDir::Files | QDir::Readable, QDir::Name)) {
+        files.append(corpus.absoluteFilePath(name));
+    }
+    return files;
+}
+
+// Скачанные модели ggml-<имя>.bin; недокачанные файлы настройки Whisper сюда не попадают
+QMap<QString, QString> downloadedModels(const QString &dir, const QStringList &only)
+{
+    QMap<QString, QString> models;
+    const QDir modelDir(dir);
+    for (const QString &name : modelDir.entryList({"ggml-*.bin"}, QDir::Files | QDir::Readable, QDir::Name)) {
+        const QString model = name.mid(5, name.size() - 9);
+        if (only.isEmpty() || only.contains(model)) models.insert(model, modelDir.absoluteFilePath(name));
+    }
+    return models;
+}
+
+QVector<Chunking> parseChunking(const QString &text)
+{
+    QVector<Chunking> settings;
+    for (const QString &item : text.split(',', Qt::SkipEmptyParts)) {
+        const QStringList parts = item.split('/');
+        Chunking chunking;
+        chunking.chunkMs = parts.value(0).trimmed().toLongLong();
+        chunking.overlapMs = parts.value(1).trimmed().toLongLong();
+        if (chunking.chunkMs > 0 && chunking.overlapMs >= 0 && chunking.overlapMs < chunking.chunkMs) {
+            settings.append(chunking);
+        }
+    }
+    return settings;
+}
+
+Run transcribe(const QString &media, const QString &model, const QString &modelPath, const Chunking &chunking,
+               TranscriptionPipeline::Config config, const QStringList &reference)
+{
+    Run run;
+    run.media = media;
+    run.model = model;
+    run.chunking = chunking;
+
+    config.modelPath = modelPath;
+    config.chunkMs = chunking.chunkMs;
+    config.overlapMs = chunking.overlapMs;
+    TranscriptionPipeline pipeline;
+    pipeline.setConfig(config);
+
+    RssSampler sampler;
+    QObject::connect(&pipeline, &TranscriptionPipeline::processStarted, [&](QProcess *process) {
+        sampler.watch(process);
+    });
+    QEventLoop loop;
+    QObject::connect(&pipeline, &TranscriptionPipeline::finished, [&](bool ok, const QString &error) {
+        run.ok = ok;
+        if (!ok) fprintf(stderr, "  %s: %s\n", qPrintable(model), qPrintable(error));
+        loop.quit();
+    });
+    sampler.start();
+    pipeline.start(media);
+    loop.exec();
+    sampler.stop();
+
+    const TranscriptionPipeline::Stats stats = pipeline.stats();
+    run.audioMs = stats.audioMs;
+    run.wallMs = stats.wallMs;
+    run.whisperMs = stats.whisperMs;
+    run.peakRss = sampler.peakBytes();
+    if (!reference.isEmpty()) {
+        const QStringList hypothesis = words(*pipeline.track()->snapshot());
+        run.referenceWords = reference.size();
+        run.errors = editDistance(reference, hypothesis);
+    }
+    return run;
+}
+
+QJsonObject toJson(const Run &run)
+{
+    QJsonObject item;
+    item["media"] = run.media;
+    item["model"] = run.model;
+    item["chunk_ms"] = double(run.chunking.chunkMs);
+    item["overlap_ms"] = double(run.chunking.overlapMs);
+    item["ok"] = run.ok;
+    item["audio_ms"] = double(run.audioMs);
+    item["wall_ms"] = double(run.wallMs);
+    item["whisper_ms"] = double(run.whisperMs);
+    item["peak_children_rss_bytes"] = double(run.peakRss);
+    if (run.referenceWords >= 0) {
+        item["reference_words"] = run.referenceWords;
+        item["word_errors"] = run.errors;
+    }
+    return item;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Compare whisper models by speed, memory and WER on a local corpus");
+    parser.addHelpOption();
+    QCommandLineOption corpusOption("corpus", "Directory with media files and reference subtitles.", "dir",
+                                    QDir::currentPath());
+    QCommandLineOption modelsDirOption("models-dir", "Directory with ggml-<model>.bin files.", "dir",
+                                       QDir::currentPath() + "/models/whisper");
+    QCommandLineOption modelsOption("models", "Comma-separated model names (default: all downloaded).", "list");
+    QCommandLineOption chunkingOption("chunking", "Comma-separated chunk/overlap settings in ms.", "list",
+                                      "15000/2000,30000/2000");
+    QCommandLineOption concurrencyOption("concurrency", "Whisper processes at once.", "n", "1");
+    QCommandLineOption whisperOption("whisper", "whisper executable.", "path",
+                                     QDir::currentPath() + "/../tools/whisper/whisper");
+    QCommandLineOption ffmpegOption("ffmpeg", "ffmpeg executable.", "path", "ffmpeg");
+    QCommandLineOption languageOption("language", "Transcription language.", "code", "ru");
+    QCommandLineOption jsonOption("json", "Write every run and the summary as JSON to <file>.", "file");
+    parser.addOptions({corpusOption, modelsDirOption, modelsOption, chunkingOption, concurrencyOption,
+                       whisperOption, ffmpegOption, languageOption, jsonOption});
+    parser.process(app);
+
+    const QStringList media = corpusFiles(parser.value(corpusOption));
+    const QMap<QString, QString> models = downloadedModels(parser.value(modelsDirOption),
+                                                           parser.value(modelsOption).split(',', Qt::SkipEmptyParts));
+    const QVector<Chunking> chunkings = parseChunking(parser.value(chunkingOption));
+    if (media.isEmpty() || models.isEmpty() || chunkings.isEmpty()) {
+        fprintf(stderr, "nothing to compare: %lld media files, %lld models, %lld chunking settings\n",
+                qlonglong(media.size()), qlonglong(models.size()), qlonglong(chunkings.size()));
+        return 1;
+    }
+
+    TranscriptionPipeline::Config config;
+    config.ffmpegPath = parser.value(ffmpegOption);
+    config.whisperPath = parser.value(whisperOption);
+    config.language = parser.value(languageOption);
+    config.concurrency = qMax(1, parser.value(concurrencyOption).toInt());
+
+    QVector<Run> runs;
+    for (const QString &file : media) {
+        // Эталон читается один раз на файл
+        QStringList reference;
+        const QStringList candidates = SubtitleLoader::siblingCandidates(file);
+        if (!candidates.isEmpty()) {
+            if (SubtitleTrackPtr track = SubtitleLoader::loadFile(candidates.first())) reference = words(*track);
+        }
+        fprintf(stderr, "%s (%s)\n", qPrintable(QFileInfo(file).fileName()),
+                reference.isEmpty() ? "no reference" : qPrintable(QString("%1 reference words").arg(reference.size())));
+        for (auto model = models.cbegin(); model != models.cend(); ++model) {
+            for (const Chunking &chunking : chunkings) {
+                const Run run = transcribe(file, model.key(), model.value(), chunking, config, reference);
+                fprintf(stderr, "  %-16s %-8s %7.2fs  RTF %.3f%s\n", qPrintable(run.model), qPrintable(chunking.label()),
+                        run.wallMs / 1000.0, run.audioMs > 0 ? double(run.wallMs) / run.audioMs : 0.0,
+                        run.referenceWords > 0
+                            ? qPrintable(QString("  WER %1%").arg(100.0 * run.errors / run.referenceWords, 0, 'f', 1))
+                            : "");
+                runs.append(run);
+            }
+        }
+    }
+
+    // Итог на модель и нарезку: RTF по сумме времени, WER по сумме ошибок корпуса
+    QTextStream out(stdout);
+    out << QString("%1 %2 %3 %4 %5 %6 %7 %8 %9")
+               .arg("model", -16).arg("chunk/ov s", 10).arg("files", 5).arg("failed", 6).arg("audio min", 9)
+               .arg("RTF", 7).arg("whisper RTF", 11).arg("peak RSS MB", 11).arg("WER %", 7)
+        << '\n';
+    QJsonArray summary;
+    for (auto model = models.cbegin(); model != models.cend(); ++model) {
+        for (const Chunking &chunking : chunkings) {
+            int files = 0;
+            int failed = 0;
+            qint64 audioMs = 0;
+            qint64 wallMs = 0;
+            qint64 whisperMs = 0;
+            qint64 peakRss = 0;
+            qint64 referenceWords = 0;
+            qint64 errors = 0;
+            for (const Run &run : runs) {
+                if (run.model != model.key() || run.chunking.chunkMs != chunking.chunkMs
+                    || run.chunking.overlapMs != chunking.overlapMs) {
+                    continue;
+                }
+                ++files;
+                if (!run.ok) {
+                    ++failed;
+                    continue;
+                }
+                audioMs += run.audioMs;
+                wallMs += run.wallMs;
+                whisperMs += run.whisperMs;
+                peakRss = qMax(peakRss, run.peakRss);
+                if (run.referenceWords > 0) {
+                    referenceWords += run.referenceWords;
+                    errors += run.errors;
+                }
+            }
+            const double rtf = audioMs > 0 ? double(wallMs) / audioMs : 0;
+            const double whisperRtf = audioMs > 0 ? double(whisperMs) / audioMs : 0;
+            const double wer = referenceWords > 0 ? 100.0 * errors / referenceWords : -1;
+            out << QString("%1 %2 %3 %4 %5 %6 %7 %8 %9")
+                       .arg(model.key(), -16).arg(chunking.label(), 10).arg(files, 5).arg(failed, 6)
+                       .arg(audioMs / 60000.0, 9, 'f', 1).arg(rtf, 7, 'f', 3).arg(whisperRtf, 11, 'f', 3)
+                       .arg(peakRss / (1024.0 * 1024.0), 11, 'f', 0)
+                       .arg(wer >= 0 ? QString::number(wer, 'f', 1) : QString("-"), 7)
+                << '\n';
+
+            QJsonObject item;
+            item["model"] = model.key();
+            item["chunk_ms"] = double(chunking.chunkMs);
+            item["overlap_ms"] = double(chunking.overlapMs);
+            item["files"] = files;
+            item["failed"] = failed;
+            item["audio_ms"] = double(audioMs);
+            item["rtf"] = rtf;
+            item["whisper_rtf"] = whisperRtf;
+            item["peak_children_rss_bytes"] = double(peakRss);
+            if (wer >= 0) item["wer"] = wer / 100.0;
+            summary.append(item);
+        }
+    }
+    out.flush();
+
+    if (parser.isSet(jsonOption)) {
+        QJsonArray all;
+        for (const Run &run : runs) all.append(toJson(run));
+        QJsonObject machine;
+        machine["host"] = QSysInfo::machineHostName();
+        machine["os"] = QSysInfo::prettyProductName();
+        machine["cpu"] = QSysInfo::currentCpuArchitecture();
+        machine["qt"] = QString(qVersion());
+        QJsonObject root;
+        root["machine"] = machine;
+        root["concurrency"] = config.concurrency;
+        root["runs"] = all;
+        root["summary"] = summary;
+        QFile file(parser.value(jsonOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            fprintf(stderr, "cannot write %s\n", qPrintable(parser.value(jsonOption)));
+            return 1;
+        }
+        file.write(QJsonDocument(root).toJson());
+    }
+    return 0;
+}
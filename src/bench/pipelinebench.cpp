@@ -0,0 +1,236 @@
+// Бенчмарк конвейера транскрипции (TranscriptionPipeline) на заглушках
+// stub_ffmpeg и stub_whisper: без моделей, сети и настоящего медиа. Для
+// каждой длины медиа и каждого числа одновременных процессов whisper
+// печатает время от запуска до готовой дорожки, накладные расходы конвейера
+// на чанк (всё, что сверх работы whisper) и пиковую память своего процесса
+// и дочерних.
+//
+//   simple_player_pipeline_bench [--quick] [--minutes 1,10,60] [--concurrency 1,2,4]
+//                                [--startup-ms N] [--rtf X] [--rss-mb N] [--json <файл>]
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QTextStream>
+#include <QVector>
+#include <cstdio>
+#include "core/transcriptionpipeline.h"
+#include "rsssampler.h"
+
+namespace {
+
+struct Result {
+    int minutes = 0;
+    int concurrency = 0;
+    int chunks = 0;
+    int cues = 0;
+    bool ok = false;
+    qint64 wallMs = 0;
+    qint64 extractMs = 0;
+    qint64 whisperMs = 0;       // сумма по чанкам
+    double overheadMsPerChunk = 0;
+    double sliceUsPerChunk = 0;
+    double spawnUsPerChunk = 0;
+    double parseUsPerChunk = 0;
+    qint64 peakChildrenRss = 0; // сумма RSS одновременно живых дочерних процессов
+    qint64 peakSelfRss = 0;
+};
+
+QString toolPath(const QString &name)
+{
+#if defined(Q_OS_WIN)
+    return QCoreApplication::applicationDirPath() + "/" + name + ".exe";
+#else
+    return QCoreApplication::applicationDirPath() + "/" + name;
+#endif
+}
+
+Result runOnce(const QString &workDir, int minutes, int concurrency)
+{
+    Result result;
+    result.minutes = minutes;
+    result.concurrency = concurrency;
+
+    const QString mediaPath = QString("%1/stub_%2min.media").arg(workDir).arg(minutes);
+    QFile media(mediaPath);
+    if (media.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        media.write(QString("STUB-MEDIA duration_ms=%1\n").arg(qint64(minutes) * 60000).toUtf8());
+        media.close();
+    }
+
+    TranscriptionPipeline pipeline;
+    TranscriptionPipeline::Config config;
+    config.ffmpegPath = toolPath("stub_ffmpeg");
+    config.whisperPath = toolPath("stub_whisper");
+    config.modelPath = "stub.bin";
+    config.concurrency = concurrency;
+    config.workDir = workDir;
+    pipeline.setConfig(config);
+
+    RssSampler sampler;
+    QObject::connect(&pipeline, &TranscriptionPipeline::processStarted, [&](QProcess *process) {
+        sampler.watch(process);
+    });
+
+    QEventLoop loop;
+    QObject::connect(&pipeline, &TranscriptionPipeline::finished, [&](bool ok, const QString &error) {
+        result.ok = ok;
+        if (!ok) fprintf(stderr, "%d min x%d: %s\n", minutes, concurrency, qPrintable(error));
+        loop.quit();
+    });
+    sampler.start();
+    pipeline.start(mediaPath);
+    loop.exec();
+    sampler.stop();
+    result.peakChildrenRss = sampler.peakBytes();
+
+    const TranscriptionPipeline::Stats stats = pipeline.stats();
+    result.chunks = stats.chunks;
+    result.cues = pipeline.track() ? pipeline.track()->snapshot()->size() : 0;
+    result.wallMs = stats.wallMs;
+    result.extractMs = stats.extractMs;
+    result.whisperMs = stats.whisperMs;
+    if (stats.chunks > 0) {
+        // Идеальный конвейер: извлечение, затем whisper без простоев на всех процессах
+        const double ideal = stats.extractMs + double(stats.whisperMs) / concurrency;
+        result.overheadMsPerChunk = (stats.wallMs - ideal) / stats.chunks;
+        result.sliceUsPerChunk = stats.sliceNs / 1000.0 / stats.chunks;
+        result.spawnUsPerChunk = stats.spawnNs / 1000.0 / stats.chunks;
+        result.parseUsPerChunk = stats.parseNs / 1000.0 / stats.chunks;
+    }
+    result.peakSelfRss = RssSampler::lifetimeMaxBytes(false);
+    QFile::remove(mediaPath);
+    return result;
+}
+
+QVector<int> parseList(const QString &text)
+{
+    QVector<int> values;
+    for (const QString &part : text.split(',', Qt::SkipEmptyParts)) {
+        const int value = part.trimmed().toInt();
+        if (value > 0) values.append(value);
+    }
+    return values;
+}
+
+QJsonDocument toJson(const QVector<Result> &results, const QJsonObject &settings)
+{
+    QJsonArray runs;
+    for (const Result &r : results) {
+        QJsonObject item;
+        item["minutes"] = r.minutes;
+        item["concurrency"] = r.concurrency;
+        item["ok"] = r.ok;
+        item["chunks"] = r.chunks;
+        item["cues"] = r.cues;
+        item["wall_ms"] = double(r.wallMs);
+        item["extract_ms"] = double(r.extractMs);
+        item["whisper_ms"] = double(r.whisperMs);
+        item["overhead_ms_per_chunk"] = r.overheadMsPerChunk;
+        item["slice_us_per_chunk"] = r.sliceUsPerChunk;
+        item["spawn_us_per_chunk"] = r.spawnUsPerChunk;
+        item["parse_us_per_chunk"] = r.parseUsPerChunk;
+        item["peak_children_rss_bytes"] = double(r.peakChildrenRss);
+        item["peak_self_rss_bytes"] = double(r.peakSelfRss);
+        runs.append(item);
+    }
+    QJsonObject machine;
+    machine["host"] = QSysInfo::machineHostName();
+    machine["os"] = QSysInfo::prettyProductName();
+    machine["cpu"] = QSysInfo::currentCpuArchitecture();
+    machine["cores"] = QThread::idealThreadCount();
+    machine["qt"] = QString(qVersion());
+    QJsonObject root;
+    root["machine"] = machine;
+    root["settings"] = settings;
+    root["runs"] = runs;
+    return QJsonDocument(root);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Transcription pipeline benchmark on stub ffmpeg/whisper");
+    parser.addHelpOption();
+    QCommandLineOption quickOption("quick", "1 and 10 minute media only (for a smoke run).");
+    QCommandLineOption minutesOption("minutes", "Comma-separated media lengths in minutes.", "list", "1,10,60");
+    QCommandLineOption concurrencyOption("concurrency", "Comma-separated whisper process counts.", "list", "1,2,4");
+    QCommandLineOption startupOption("startup-ms", "Stub whisper model load time.", "ms", "200");
+    QCommandLineOption rtfOption("rtf", "Stub whisper realtime factor.", "x", "0.05");
+    QCommandLineOption rssOption("rss-mb", "Memory each stub whisper process touches.", "mb", "64");
+    QCommandLineOption jsonOption("json", "Write results as JSON to <file>.", "file");
+    parser.addOptions({quickOption, minutesOption, concurrencyOption, startupOption, rtfOption, rssOption, jsonOption});
+    parser.process(app);
+
+    if (!QFile::exists(toolPath("stub_ffmpeg")) || !QFile::exists(toolPath("stub_whisper"))) {
+        fprintf(stderr, "stub_ffmpeg/stub_whisper not found next to %s\n", qPrintable(QCoreApplication::applicationFilePath()));
+        return 1;
+    }
+    // Заглушки наследуют окружение
+    qputenv("STUB_WHISPER_STARTUP_MS", parser.value(startupOption).toUtf8());
+    qputenv("STUB_WHISPER_RTF", parser.value(rtfOption).toUtf8());
+    qputenv("STUB_WHISPER_RSS_MB", parser.value(rssOption).toUtf8());
+
+    QVector<int> minutes = parseList(parser.value(minutesOption));
+    if (parser.isSet(quickOption)) minutes = {1, 10};
+    const QVector<int> concurrencies = parseList(parser.value(concurrencyOption));
+
+    QTemporaryDir workDir;
+    if (!workDir.isValid()) {
+        fprintf(stderr, "cannot create a temporary directory\n");
+        return 1;
+    }
+
+    QTextStream out(stdout);
+    out << QString("%1 %2 %3 %4 %5 %6 %7 %8 %9")
+               .arg("minutes", 7).arg("procs", 5).arg("chunks", 6).arg("wall s", 8).arg("overhead ms/chunk", 17)
+               .arg("spawn us", 9).arg("parse us", 9).arg("children MB", 11).arg("self MB", 8)
+        << '\n';
+    out.flush();
+
+    QVector<Result> results;
+    bool allOk = true;
+    for (int length : minutes) {
+        for (int concurrency : concurrencies) {
+            const Result r = runOnce(workDir.path(), length, concurrency);
+            allOk = allOk && r.ok;
+            results.append(r);
+            out << QString("%1 %2 %3 %4 %5 %6 %7 %8 %9")
+                       .arg(r.minutes, 7).arg(r.concurrency, 5).arg(r.chunks, 6)
+                       .arg(r.wallMs / 1000.0, 8, 'f', 2).arg(r.overheadMsPerChunk, 17, 'f', 2)
+                       .arg(r.spawnUsPerChunk, 9, 'f', 0).arg(r.parseUsPerChunk, 9, 'f', 0)
+                       .arg(r.peakChildrenRss / (1024.0 * 1024.0), 11, 'f', 1).arg(r.peakSelfRss / (1024.0 * 1024.0), 8, 'f', 1)
+                << (r.ok ? "" : "  FAILED") << '\n';
+            out.flush();
+        }
+    }
+    out << QString("largest waited-for child: %1 MB").arg(RssSampler::lifetimeMaxBytes(true) / (1024.0 * 1024.0), 0, 'f', 1) << '\n';
+    out.flush();
+
+    if (parser.isSet(jsonOption)) {
+        QJsonObject settings;
+        settings["startup_ms"] = parser.value(startupOption).toDouble();
+        settings["rtf"] = parser.value(rtfOption).toDouble();
+        settings["rss_mb"] = parser.value(rssOption).toDouble();
+        QFile file(parser.value(jsonOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            fprintf(stderr, "cannot write %s\n", qPrintable(parser.value(jsonOption)));
+            return 1;
+        }
+        file.write(toJson(results, settings).toJson());
+    }
+    return allOk ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <QPointer>
+#include <QProcess>
+#include <QTimer>
+#include <QVector>
+#include <algorithm>
+#include "core/perfstats.h"
+
+#if defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
+
+// Пиковая суммарная RSS одновременно живых дочерних процессов. PerfStats
+// снимает память раз в секунду, а процесс whisper на коротком чанке (или
+// заглушка) живёт доли секунды, поэтому здесь опрос частый.
+class RssSampler {
+public:
+    explicit RssSampler(int intervalMs = 20)
+    {
+        m_timer.setInterval(intervalMs);
+        QObject::connect(&m_timer, &QTimer::timeout, [this]() { sample(); });
+    }
+
+    void watch(QProcess *process) { m_processes.append(process); }
+    void start()
+    {
+        m_peak = 0;
+        m_timer.start();
+    }
+    void stop()
+    {
+        sample();
+        m_timer.stop();
+        m_processes.clear();
+    }
+    qint64 peakBytes() const { return m_peak; }
+
+    // Пиковая RSS за время жизни процесса (для дочерних - наибольшая из
+    // дождавшихся); 0, если платформа не сообщает
+    static qint64 lifetimeMaxBytes(bool children)
+    {
+#if defined(Q_OS_UNIX)
+        rusage usage{};
+        if (getrusage(children ? RUSAGE_CHILDREN : RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(Q_OS_MACOS)
+        return qint64(usage.ru_maxrss);
+#else
+        return qint64(usage.ru_maxrss) * 1024;
+#endif
+#else
+        Q_UNUSED(children);
+        return 0;
+#endif
+    }
+
+private:
+    void sample()
+    {
+        qint64 total = 0;
+        for (const QPointer<QProcess> &process : m_processes) {
+            if (process && process->state() == QProcess::Running) {
+                total += qMax<qint64>(0, PerfStats::processRssBytes(process->processId()));
+            }
+        }
+        m_peak = qMax(m_peak, total);
+        m_processes.erase(std::remove_if(m_processes.begin(), m_processes.end(),
+                                         [](const QPointer<QProcess> &process) { return process.isNull(); }),
+                          m_processes.end());
+    }
+
+    QTimer m_timer;
+    QVector<QPointer<QProcess>> m_processes;
+    qint64 m_peak = 0;
+};
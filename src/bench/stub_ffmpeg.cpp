@@ -0,0 +1,109 @@
+// Заглушка ffmpeg для бенчмарка конвейера транскрипции: понимает только
+// вызов извлечения аудио из TranscriptionPipeline
+//   stub_ffmpeg -i <вход> ... <выход.wav> -y
+// Вход - текстовый файл "STUB-MEDIA duration_ms=<N>" (тогда пишется
+// синтетический PCM 16 кГц моно нужной длины) или готовый WAV (копируется).
+// STUB_FFMPEG_DELAY_MS - дополнительная задержка перед выходом.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int SampleRate = 16000;
+
+void putLe(std::vector<char> &out, uint32_t value, int bytes)
+{
+    for (int i = 0; i < bytes; ++i) out.push_back(char((value >> (8 * i)) & 0xff));
+}
+
+bool writeSyntheticWav(const std::string &path, int64_t durationMs)
+{
+    const uint64_t dataBytes = uint64_t(durationMs) * SampleRate / 1000 * 2;
+    std::vector<char> header;
+    header.insert(header.end(), {'R', 'I', 'F', 'F'});
+    putLe(header, uint32_t(36 + dataBytes), 4);
+    header.insert(header.end(), {'W', 'A', 'V', 'E', 'f', 'm', 't', ' '});
+    putLe(header, 16, 4);
+    putLe(header, 1, 2); // PCM
+    putLe(header, 1, 2); // моно
+    putLe(header, SampleRate, 4);
+    putLe(header, SampleRate * 2, 4);
+    putLe(header, 2, 2);
+    putLe(header, 16, 2);
+    header.insert(header.end(), {'d', 'a', 't', 'a'});
+    putLe(header, uint32_t(dataBytes), 4);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    out.write(header.data(), std::streamsize(header.size()));
+
+    // Пилообразный сигнал блоками по 64 КБ
+    std::vector<int16_t> block(32768);
+    for (size_t i = 0; i < block.size(); ++i) block[i] = int16_t((int(i % 200) - 100) * 80);
+    uint64_t left = dataBytes;
+    while (left > 0) {
+        const uint64_t n = left < block.size() * 2 ? left : block.size() * 2;
+        out.write(reinterpret_cast<const char *>(block.data()), std::streamsize(n));
+        left -= n;
+    }
+    return bool(out);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    std::string input;
+    std::string output;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "-i" && i + 1 < argc) {
+            input = argv[++i];
+        } else if ((arg == "-acodec" || arg == "-ar" || arg == "-ac") && i + 1 < argc) {
+            ++i;
+        } else if (arg.empty() || arg[0] != '-') {
+            output = arg;
+        }
+    }
+    if (input.empty() || output.empty()) {
+        std::fprintf(stderr, "stub_ffmpeg: usage: -i <input> ... <output.wav>\n");
+        return 1;
+    }
+
+    std::ifstream in(input, std::ios::binary);
+    if (!in) {
+        std::fprintf(stderr, "stub_ffmpeg: %s: cannot open\n", input.c_str());
+        return 1;
+    }
+    const std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    bool ok = false;
+    const std::string stubTag = "STUB-MEDIA";
+    if (content.compare(0, stubTag.size(), stubTag) == 0) {
+        const size_t pos = content.find("duration_ms=");
+        const int64_t durationMs = pos == std::string::npos ? 0 : std::atoll(content.c_str() + pos + 12);
+        ok = durationMs > 0 && writeSyntheticWav(output, durationMs);
+    } else if (content.compare(0, 4, "RIFF") == 0) {
+        std::ofstream out(output, std::ios::binary | std::ios::trunc);
+        out.write(content.data(), std::streamsize(content.size()));
+        ok = bool(out);
+    }
+    if (!ok) {
+        std::fprintf(stderr, "stub_ffmpeg: %s: unsupported input\n", input.c_str());
+        return 1;
+    }
+
+    if (const char *delay = std::getenv("STUB_FFMPEG_DELAY_MS")) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(std::atoll(delay)));
+    }
+    return 0;
+}
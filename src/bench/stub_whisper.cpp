@@ -0,0 +1,105 @@
+// Заглушка whisper-cli для бенчмарка конвейера транскрипции:
+//   stub_whisper -m <модель> -f <чанк.wav> -osrt -of <префикс> ...
+// Читает длительность из заголовка WAV, держит занятую память и спит
+// startup + длительность * rtf, затем пишет <префикс>.srt с репликой
+// каждые три секунды. Модель не читается.
+//   STUB_WHISPER_STARTUP_MS - загрузка модели, по умолчанию 200
+//   STUB_WHISPER_RTF        - realtime factor, по умолчанию 0.05
+//   STUB_WHISPER_RSS_MB     - сколько памяти занять и потрогать, по умолчанию 64
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+double envNumber(const char *name, double fallback)
+{
+    const char *value = std::getenv(name);
+    return value && *value ? std::atof(value) : fallback;
+}
+
+uint32_t readLe(const unsigned char *p, int bytes)
+{
+    uint32_t value = 0;
+    for (int i = bytes - 1; i >= 0; --i) value = (value << 8) | p[i];
+    return value;
+}
+
+// Длительность по заголовку RIFF: byte rate из fmt, размер из data
+int64_t wavDurationMs(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    unsigned char riff[12];
+    if (!in.read(reinterpret_cast<char *>(riff), 12) || std::memcmp(riff, "RIFF", 4) != 0) return -1;
+    uint32_t byteRate = 0;
+    unsigned char chunk[8];
+    while (in.read(reinterpret_cast<char *>(chunk), 8)) {
+        const uint32_t size = readLe(chunk + 4, 4);
+        if (std::memcmp(chunk, "fmt ", 4) == 0) {
+            unsigned char fmt[16];
+            if (size < 16 || !in.read(reinterpret_cast<char *>(fmt), 16)) return -1;
+            byteRate = readLe(fmt + 8, 4);
+            in.seekg(size - 16 + (size & 1), std::ios::cur);
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            return byteRate > 0 ? int64_t(size) * 1000 / byteRate : -1;
+        } else {
+            in.seekg(size + (size & 1), std::ios::cur);
+        }
+    }
+    return -1;
+}
+
+std::string timecode(int64_t ms)
+{
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%02d:%02d:%02d,%03d", int(ms / 3600000), int(ms / 60000 % 60),
+                  int(ms / 1000 % 60), int(ms % 1000));
+    return buffer;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    std::string input;
+    std::string outputPrefix;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "-f" && i + 1 < argc) input = argv[++i];
+        else if (arg == "-of" && i + 1 < argc) outputPrefix = argv[++i];
+    }
+    if (input.empty() || outputPrefix.empty()) {
+        std::fprintf(stderr, "stub_whisper: usage: -f <input.wav> -of <prefix>\n");
+        return 1;
+    }
+
+    const int64_t durationMs = wavDurationMs(input);
+    if (durationMs < 0) {
+        std::fprintf(stderr, "stub_whisper: %s: not a WAV file\n", input.c_str());
+        return 1;
+    }
+
+    // Память модели: страницы трогаются, чтобы попасть в RSS
+    const size_t rssBytes = size_t(envNumber("STUB_WHISPER_RSS_MB", 64) * 1024 * 1024);
+    std::vector<char> model(rssBytes);
+    for (size_t i = 0; i < model.size(); i += 4096) model[i] = char(i);
+
+    const double workMs = envNumber("STUB_WHISPER_STARTUP_MS", 200) + durationMs * envNumber("STUB_WHISPER_RTF", 0.05);
+    std::this_thread::sleep_for(std::chrono::microseconds(int64_t(workMs * 1000)));
+
+    std::ofstream out(outputPrefix + ".srt", std::ios::binary | std::ios::trunc);
+    int number = 1;
+    for (int64_t start = 0; start + 500 <= durationMs; start += 3000, ++number) {
+        const int64_t end = start + 2500 < durationMs ? start + 2500 : durationMs;
+        out << number << "\n" << timecode(start) << " --> " << timecode(end) << "\n"
+            << "Stub cue " << number << " of " << input.substr(input.find_last_of("/\\") + 1) << "\n\n";
+    }
+    return out ? 0 : 1;
+}
@@ -17,6 +17,9 @@
 #include <QDesktopServices>
 #include <QUrl>
 #include <QRegularExpression>
+#include <QFileInfo>
+#include <QTimer>
+#include "core/modeldownloader.h"
 
 // Функция для парсинга размера модели в байты
 qint64 parseModelSize(const QString &sizeStr) {
@@ -61,7 +64,8 @@ WhisperModelSettingsDialog::WhisperModelSettingsDialog(QWidget *parent)
     sortModelsBySize(m_models);
     
     setupUi();
-    checkModelFiles();
+    // Каталог моделей может быть на медленном диске: проверяем файлы, когда диалог уже показан
+    QTimer::singleShot(0, this, &WhisperModelSettingsDialog::checkModelFiles);
 }
 
 void WhisperModelSettingsDialog::setupUi()
@@ -131,14 +135,18 @@ void WhisperModelSettingsDialog::setupUi()
 
 void WhisperModelSettingsDialog::checkModelFiles()
 {
+    // Каталог создаётся только при скачивании (downloadModel), просмотр его не трогает
     QDir modelDir(m_modelDir);
-    if (!modelDir.exists()) modelDir.mkpath(".");
     for (const auto &modelInfo : m_models) {
         QString filePath = modelDir.filePath("ggml-" + modelInfo.name + ".bin");
         if (QFile::exists(filePath)) {
             m_statusLabels[modelInfo.name]->setText("Скачано");
             m_downloadButtons[modelInfo.name]->setEnabled(false);
             m_deleteButtons[modelInfo.name]->setEnabled(true);
+        } else if (QFile::exists(ModelDownloader::partialPath(filePath))) {
+            m_statusLabels[modelInfo.name]->setText("Скачано частично");
+            m_downloadButtons[modelInfo.name]->setEnabled(true);
+            m_deleteButtons[modelInfo.name]->setEnabled(false);
         } else {
             m_statusLabels[modelInfo.name]->setText("Не скачано");
             m_downloadButtons[modelInfo.name]->setEnabled(true);
@@ -159,15 +167,13 @@ void WhisperModelSettingsDialog::onCustomDownloadClicked()
         QMessageBox::warning(this, "Ошибка", "Введите ссылку на модель");
         return;
     }
-    QString fileName = url.section('/', -1);
+    QString fileName = QUrl(url).fileName();
     if (!fileName.endsWith(".bin")) {
         QMessageBox::warning(this, "Ошибка", "Ссылка должна указывать на .bin файл модели");
         return;
     }
     QDir modelDir(m_modelDirEdit->text());
-    if (!modelDir.exists()) modelDir.mkpath(".");
-    QString filePath = modelDir.filePath(fileName);
-    downloadModel(fileName, url);
+    downloadModel(fileName, QUrl(url), modelDir.filePath(fileName));
 }
 
 void WhisperModelSettingsDialog::onModelDirBrowseClicked()
@@ -182,34 +188,36 @@ void WhisperModelSettingsDialog::onModelDirBrowseClicked()
     }
 }
 
-void WhisperModelSettingsDialog::downloadModel(const QString &modelName, const QString &url)
+void WhisperModelSettingsDialog::downloadModel(const QString &displayName, const QUrl &url, const QString &filePath)
 {
-    QDir modelDir(m_modelDirEdit ? m_modelDirEdit->text() : m_modelDir);
-    QString filePath = modelDir.filePath("ggml-" + modelName + ".bin");
-    QNetworkAccessManager *nam = new QNetworkAccessManager(this);
-    QNetworkReply *reply = nam->get(QNetworkRequest(QUrl(url)));
-    QProgressDialog *progress = new QProgressDialog("Скачивание " + modelName, "Отмена", 0, 100, this);
+    QDir modelDir = QFileInfo(filePath).absoluteDir();
+    if (!modelDir.exists()) modelDir.mkpath(".");
+    if (!m_nam) m_nam = new QNetworkAccessManager(this);
+
+    // Пишем потоком в "<файл>.part"; при повторном запуске загрузка продолжится
+    ModelDownloader *downloader = new ModelDownloader(m_nam, this);
+    QProgressDialog *progress = new QProgressDialog("Скачивание " + displayName, "Отмена", 0, 1000, this);
     progress->setWindowModality(Qt::WindowModal);
-    connect(reply, &QNetworkReply::downloadProgress, this, [progress](qint64 rec, qint64 total) {
-        if (total > 0) progress->setValue(int(100.0 * rec / total));
+    progress->setAttribute(Qt::WA_DeleteOnClose);
+    connect(downloader, &ModelDownloader::progress, progress, [progress](qint64 rec, qint64 total) {
+        if (total > 0) progress->setValue(int(1000.0 * rec / total));
     });
-    connect(progress, &QProgressDialog::canceled, reply, &QNetworkReply::abort);
-    connect(reply, &QNetworkReply::finished, this, [=]() {
+    connect(progress, &QProgressDialog::canceled, downloader, &ModelDownloader::abort);
+    connect(downloader, &ModelDownloader::finished, this, [=](bool ok, const QString &error) {
         progress->close();
-        if (reply->error() == QNetworkReply::NoError) {
-            QFile f(filePath);
-            if (f.open(QIODevice::WriteOnly)) {
-                f.write(reply->readAll());
-                f.close();
-                QMessageBox::information(this, "Успех", "Модель " + modelName + " скачана!");
-            }
+        if (ok && downloader->isVerified()) {
+            QMessageBox::information(this, "Успех", "Модель " + displayName + " скачана!");
+        } else if (ok) {
+            QMessageBox::warning(this, "Не проверено",
+                                 "Модель " + displayName + " скачана, но контрольная сумма не проверена: "
+                                 "сервер не сообщил SHA-256.\nSHA-256 файла: " + QString::fromLatin1(downloader->actualSha256()));
         } else {
-            QMessageBox::warning(this, "Ошибка", "Ошибка скачивания: " + reply->errorString());
+            QMessageBox::warning(this, "Ошибка", error);
         }
-        reply->deleteLater();
-        nam->deleteLater();
+        downloader->deleteLater();
         updateModelStatus();
     });
+    downloader->start(url, filePath);
     progress->show();
 }
 
@@ -230,32 +238,7 @@ void WhisperModelSettingsDialog::onDownloadClicked(const QString &modelName)
     }
     
     QDir modelDir(m_modelDirEdit ? m_modelDirEdit->text() : m_modelDir);
-    QString filePath = modelDir.filePath("ggml-" + modelName + ".bin");
-    QNetworkAccessManager *nam = new QNetworkAccessManager(this);
-    QNetworkReply *reply = nam->get(QNetworkRequest(QUrl(url)));
-    QProgressDialog *progress = new QProgressDialog("Скачивание " + modelName, "Отмена", 0, 100, this);
-    progress->setWindowModality(Qt::WindowModal);
-    connect(reply, &QNetworkReply::downloadProgress, this, [progress](qint64 rec, qint64 total) {
-        if (total > 0) progress->setValue(int(100.0 * rec / total));
-    });
-    connect(progress, &QProgressDialog::canceled, reply, &QNetworkReply::abort);
-    connect(reply, &QNetworkReply::finished, this, [=]() {
-        progress->close();
-        if (reply->error() == QNetworkReply::NoError) {
-            QFile f(filePath);
-            if (f.open(QIODevice::WriteOnly)) {
-                f.write(reply->readAll());
-                f.close();
-                QMessageBox::information(this, "Успех", "Модель " + modelName + " скачана!");
-            }
-        } else {
-            QMessageBox::warning(this, "Ошибка", "Ошибка скачивания: " + reply->errorString());
-        }
-        reply->deleteLater();
-        nam->deleteLater();
-        updateModelStatus();
-    });
-    progress->show();
+    downloadModel(modelName, QUrl(url), modelDir.filePath("ggml-" + modelName + ".bin"));
 }
 
 void WhisperModelSettingsDialog::onModelSelected()
@@ -9,6 +9,8 @@ class QRadioButton;
 class QLabel;
 class QLineEdit;
 class QFileDialog;
+class QNetworkAccessManager;
+class QUrl;
 
 struct ModelInfo {
     QString name;
@@ -36,7 +38,7 @@ private slots:
 private:
     void setupUi();
     void checkModelFiles();
-    void downloadModel(const QString &modelName, const QString &url);
+    void downloadModel(const QString &displayName, const QUrl &url, const QString &filePath);
     void deleteModel(const QString &modelName);
 
     QList<ModelInfo> m_models; // отсортированный список моделей
@@ -50,4 +52,5 @@ private:
     QLineEdit *m_modelDirEdit;
     QPushButton *m_modelDirBrowseBtn;
     QString m_modelDir;
+    QNetworkAccessManager *m_nam = nullptr;
 }; 
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include "core/livesubtitletrack.h"
+#include <algorithm>
+
+namespace {
+const qsizetype kInitialCues = 256;
+const qsizetype kInitialChars = 16 * 1024;
+}
+
+template <typename T>
+void LiveSubtitleTrack::ensureCapacity(std::shared_ptr<Block<T>> &block, qsizetype used, qsizetype needed)
+{
+    const qsizetype initial = std::is_same_v<T, QChar> ? kInitialChars : kInitialCues;
+    if (block && needed <= block->capacity) return;
+    qsizetype capacity = block ? block->capacity * 2 : initial;
+    while (capacity < needed) capacity *= 2;
+    // Старый блок не трогаем: его держат уже выданные снимки
+    auto grown = std::make_shared<Block<T>>(capacity);
+    if (block) {
+        std::copy(block->data.get(), block->data.get() + used, grown->data.get());
+    }
+    block = std::move(grown);
+}
+
+bool LiveSubtitleTrack::append(qint64 start, qint64 end, QStringView text)
+{
+    if (start < m_lastEnd || text.isEmpty()) return false;
+
+    ensureCapacity(m_entries, m_count, m_count + 1);
+    ensureCapacity(m_text, m_textSize, m_textSize + text.size());
+
+    std::copy(text.begin(), text.end(), m_text->data.get() + m_textSize);
+    SubtitleTrack::Entry &entry = m_entries->data[m_count];
+    entry.start = start;
+    entry.end = qMax(start, end);
+    entry.textOffset = quint32(m_textSize);
+    entry.textLength = quint32(text.size());
+
+    ++m_count;
+    m_textSize += text.size();
+    m_lastEnd = entry.end;
+    return true;
+}
+
+void LiveSubtitleTrack::publish()
+{
+    const quint64 version = m_version.load(std::memory_order_relaxed) + 1;
+    SubtitleTrackPtr next;
+    if (m_count == 0) {
+        next = std::make_shared<const SubtitleTrack>();
+    } else {
+        // Снимок держит оба блока; сами данные не копируются
+        using Blocks = std::pair<std::shared_ptr<const Block<SubtitleTrack::Entry>>, std::shared_ptr<const Block<QChar>>>;
+        auto keeper = std::make_shared<const Blocks>(m_entries, m_text);
+        next = std::make_shared<const SubtitleTrack>(
+            keeper, m_entries->data.get(), int(m_count), m_text->data.get(), m_textSize, version);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_publishedMutex);
+        m_published.swap(next);
+    }
+    // Прежний снимок (если его больше никто не держит) освобождается вне мьютекса
+    next.reset();
+    m_version.store(version, std::memory_order_release);
+}
+
+SubtitleTrackPtr LiveSubtitleTrack::snapshot() const
+{
+    std::lock_guard<std::mutex> lock(m_publishedMutex);
+    return m_published;
+}
@@ -0,0 +1,29 @@
+#include "core/mediacache.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QStandardPaths>
+
+namespace MediaCache {
+
+QString pathFor(const QString &sourcePath, const QString &suffix)
+{
+    const QString root = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (root.isEmpty()) return QString();
+    QDir dir(root + "/media");
+    if (!dir.exists() && !dir.mkpath(".")) return QString();
+
+    const QByteArray key = QFileInfo(sourcePath).absoluteFilePath().toUtf8();
+    const QString name = QString::fromLatin1(QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex());
+    return dir.filePath(name + '.' + suffix);
+}
+
+SourceStamp SourceStamp::of(const QFileInfo &source)
+{
+    SourceStamp stamp;
+    stamp.size = quint64(source.size());
+    stamp.modified = source.lastModified().toMSecsSinceEpoch();
+    return stamp;
+}
+
+} // namespace MediaCache
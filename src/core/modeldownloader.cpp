@@ -0,0 +1,348 @@
+#include "core/modeldownloader.h"
+#include "core/stallwatchdog.h"
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QFileInfo>
+#include <QDebug>
+#include <QtConcurrent/QtConcurrent>
+#include <cctype>
+#include <cstdio>
+
+namespace {
+
+// SHA-256 в заголовке ETag/X-Linked-ETag (так отдаёт LFS-файлы Hugging Face)
+QByteArray sha256FromEtag(QByteArray etag)
+{
+    etag = etag.trimmed();
+    if (etag.startsWith("W/")) etag = etag.mid(2);
+    if (etag.startsWith('"') && etag.endsWith('"') && etag.size() >= 2) etag = etag.mid(1, etag.size() - 2);
+    if (etag.size() != 64) return QByteArray();
+    for (char c : etag) {
+        if (!std::isxdigit(static_cast<unsigned char>(c))) return QByteArray();
+    }
+    return etag.toLower();
+}
+
+// "bytes 100-199/1000" -> 100
+qint64 contentRangeStart(const QByteArray &header)
+{
+    const QByteArray value = header.trimmed();
+    if (!value.startsWith("bytes ")) return -1;
+    const int dash = value.indexOf('-');
+    if (dash < 0) return -1;
+    bool ok = false;
+    const qint64 start = value.mid(6, dash - 6).toLongLong(&ok);
+    return ok ? start : -1;
+}
+
+// Замена итогового файла без окна, в котором его нет: rename() поверх
+// существующего атомарен в POSIX. Где поверх переименовать нельзя (Windows),
+// старый файл сначала отодвигается в сторону и возвращается при неудаче
+bool replaceFile(const QString &from, const QString &to)
+{
+    if (std::rename(QFile::encodeName(from).constData(), QFile::encodeName(to).constData()) == 0) return true;
+    if (!QFile::exists(to)) return QFile::rename(from, to);
+    const QString aside = to + ".old";
+    QFile::remove(aside);
+    if (!QFile::rename(to, aside)) return false;
+    if (!QFile::rename(from, to)) {
+        QFile::rename(aside, to);
+        return false;
+    }
+    QFile::remove(aside);
+    return true;
+}
+
+} // namespace
+
+ModelDownloader::ModelDownloader(QNetworkAccessManager *nam, QObject *parent)
+    : QObject(parent)
+    , m_nam(nam)
+    , m_hash(QCryptographicHash::Sha256)
+{
+    connect(&m_hashWatcher, &QFutureWatcher<bool>::finished, this, [this]() {
+        if (m_aborted) {
+            emit finished(false, "Скачивание отменено");
+            return;
+        }
+        if (!m_hashWatcher.result()) {
+            // Частичный файл не читается - начинаем заново
+            restartFromScratch();
+        }
+        sendRequest();
+    });
+}
+
+ModelDownloader::~ModelDownloader()
+{
+    if (m_reply) {
+        m_reply->disconnect(this);
+        m_reply->abort();
+        m_reply->deleteLater();
+        m_reply = nullptr;
+    }
+    // Фоновый подсчёт хеша пишет в m_hash - останавливаем и дожидаемся его
+    m_aborted = true;
+    StallWatchdog::Scope stallScope("ModelDownloader: hash waitForFinished");
+    m_hashWatcher.waitForFinished();
+}
+
+QString ModelDownloader::partialPath(const QString &targetPath)
+{
+    return targetPath + ".part";
+}
+
+QString ModelDownloader::metaPath() const
+{
+    return partialPath(m_targetPath) + ".meta";
+}
+
+void ModelDownloader::start(const QUrl &url, const QString &targetPath, const QByteArray &expectedSha256)
+{
+    Q_ASSERT(!isRunning());
+    m_url = url;
+    m_targetPath = targetPath;
+    m_expectedSha256 = expectedSha256.trimmed().toLower();
+    m_serverSha256.clear();
+    m_validator.clear();
+    m_actualSha256.clear();
+    m_verified = false;
+    m_aborted = false;
+    m_restartPending = false;
+    m_hash.reset();
+
+    const QString partPath = partialPath(targetPath);
+    m_offset = QFileInfo(partPath).size();
+
+    QFile meta(metaPath());
+    if (m_offset > 0 && meta.open(QIODevice::ReadOnly)) {
+        m_validator = meta.readLine().trimmed();
+    }
+
+    if (m_offset <= 0) {
+        sendRequest();
+        return;
+    }
+
+    // Докачка: хеш уже скачанной части считаем в фоне, чтобы не блокировать UI
+    qDebug() << "ModelDownloader: resuming" << targetPath << "from" << m_offset << "bytes";
+    const qint64 expectedBytes = m_offset;
+    m_hashWatcher.setFuture(QtConcurrent::run([this, partPath, expectedBytes]() {
+        QFile part(partPath);
+        if (!part.open(QIODevice::ReadOnly)) return false;
+        QByteArray block;
+        qint64 remaining = expectedBytes;
+        while (remaining > 0) {
+            if (m_aborted) return false;
+            block = part.read(qMin(remaining, ReadBufferSize));
+            if (block.isEmpty()) return false;
+            m_hash.addData(block);
+            remaining -= block.size();
+        }
+        return true;
+    }));
+}
+
+void ModelDownloader::abort()
+{
+    m_aborted = true;
+    if (m_reply) {
+        m_reply->abort();
+    }
+}
+
+bool ModelDownloader::restartFromScratch()
+{
+    m_hash.reset();
+    m_offset = 0;
+    m_requestBase = 0;
+    m_validator.clear();
+    QFile::remove(metaPath());
+    if (m_file.isOpen()) {
+        return m_file.resize(0) && m_file.seek(0);
+    }
+    QFile::remove(partialPath(m_targetPath));
+    return true;
+}
+
+void ModelDownloader::sendRequest()
+{
+    m_headersChecked = false;
+    if (!m_file.isOpen()) {
+        m_file.setFileName(partialPath(m_targetPath));
+        if (!m_file.open(QIODevice::ReadWrite)) {
+            fail("Не удалось открыть файл для записи: " + m_file.fileName());
+            return;
+        }
+    }
+    // Всё, что за пределами уже посчитанного хеша, отбрасываем
+    m_file.resize(m_offset);
+    m_file.seek(m_offset);
+
+    QNetworkRequest request(m_url);
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+    if (m_offset > 0) {
+        request.setRawHeader("Range", "bytes=" + QByteArray::number(m_offset) + "-");
+        if (!m_validator.isEmpty()) {
+            request.setRawHeader("If-Range", m_validator);
+        }
+    }
+
+    m_requestBase = m_offset;
+    m_reply = m_nam->get(request);
+    m_reply->setReadBufferSize(ReadBufferSize);
+    connect(m_reply, &QNetworkReply::metaDataChanged, this, &ModelDownloader::onMetaDataChanged);
+    connect(m_reply, &QNetworkReply::readyRead, this, &ModelDownloader::onReadyRead);
+    connect(m_reply, &QNetworkReply::finished, this, &ModelDownloader::onReplyFinished);
+    connect(m_reply, &QNetworkReply::downloadProgress, this, [this](qint64 received, qint64 total) {
+        emit progress(m_requestBase + received, total > 0 ? m_requestBase + total : -1);
+    });
+}
+
+void ModelDownloader::onMetaDataChanged()
+{
+    if (!m_reply || m_headersChecked) return;
+    const int status = m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status >= 300 && status < 400) return; // редирект - ждём итоговый ответ
+    m_headersChecked = true;
+
+    if (status == 206) {
+        const qint64 start = contentRangeStart(m_reply->rawHeader("Content-Range"));
+        if (start != m_offset) {
+            // Сервер вернул не тот диапазон - перезапрашиваем файл целиком
+            qDebug() << "ModelDownloader: unexpected Content-Range, restarting from scratch";
+            restartFromScratch();
+            m_restartPending = true;
+            m_reply->abort();
+            return;
+        }
+    } else if (status == 200 || status == 0) {
+        // Полный ответ (Range не поддерживается или файл на сервере изменился)
+        if (m_offset > 0) {
+            qDebug() << "ModelDownloader: server sent full content, discarding partial file";
+            restartFromScratch();
+        }
+    } else {
+        return; // 416 и ошибки разбираются в onReplyFinished
+    }
+
+    QByteArray validator = m_reply->rawHeader("ETag");
+    if (validator.isEmpty() || validator.startsWith("W/")) {
+        validator = m_reply->rawHeader("Last-Modified");
+    }
+    if (!validator.isEmpty() && validator != m_validator) {
+        m_validator = validator;
+        QFile meta(metaPath());
+        if (meta.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            meta.write(m_validator + '\n');
+        }
+    }
+
+    m_serverSha256 = sha256FromEtag(m_reply->rawHeader("X-Linked-ETag"));
+    if (m_serverSha256.isEmpty()) {
+        m_serverSha256 = sha256FromEtag(m_reply->rawHeader("ETag"));
+    }
+}
+
+void ModelDownloader::onReadyRead()
+{
+    if (!m_reply) return;
+    if (!m_headersChecked) onMetaDataChanged();
+    if (m_restartPending) return;
+    const int status = m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status != 200 && status != 206 && status != 0) {
+        return; // тело ошибки в файл не пишем
+    }
+    while (m_reply->bytesAvailable() > 0) {
+        const QByteArray chunk = m_reply->read(ReadBufferSize);
+        if (m_file.write(chunk) != chunk.size()) {
+            fail("Ошибка записи на диск: " + m_file.errorString());
+            return;
+        }
+        m_hash.addData(chunk);
+        m_offset += chunk.size();
+    }
+}
+
+void ModelDownloader::onReplyFinished()
+{
+    QNetworkReply *reply = m_reply;
+    if (!reply) return;
+    onReadyRead();
+    if (!m_reply) return; // ошибка записи уже обработана в fail()
+    m_reply = nullptr;
+    reply->deleteLater();
+
+    if (m_restartPending && !m_aborted) {
+        m_restartPending = false;
+        sendRequest();
+        return;
+    }
+
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    m_file.flush();
+
+    if (m_aborted) {
+        m_file.close(); // .part остаётся для докачки
+        emit finished(false, "Скачивание отменено");
+        return;
+    }
+    // 416: запрошенный диапазон за концом файла - вероятно, .part уже полный
+    const bool alreadyComplete = status == 416 && m_offset > 0;
+    if (reply->error() != QNetworkReply::NoError && !alreadyComplete) {
+        m_file.close();
+        emit finished(false, "Ошибка скачивания: " + reply->errorString());
+        return;
+    }
+    m_file.close();
+
+    const QByteArray actual = m_hash.result().toHex();
+    const QByteArray expected = expectedChecksum();
+    if (!expected.isEmpty() && expected != actual) {
+        QFile::remove(partialPath(m_targetPath));
+        QFile::remove(metaPath());
+        emit finished(false, QString("Контрольная сумма не совпадает (ожидалось %1, получено %2). Файл удалён.")
+                                 .arg(QString::fromLatin1(expected), QString::fromLatin1(actual)));
+        return;
+    }
+    // Сверять не с чем - файл принимается, но вызывающий видит это в isVerified()
+    m_actualSha256 = actual;
+    m_verified = !expected.isEmpty();
+    if (!m_verified) {
+        qWarning() << "ModelDownloader: no reference checksum, file is unverified, sha256 =" << actual;
+    }
+
+    // Итоговый файл появляется только целиком: rename в том же каталоге
+    if (!replaceFile(partialPath(m_targetPath), m_targetPath)) {
+        emit finished(false, "Не удалось переименовать файл в " + m_targetPath);
+        return;
+    }
+    QFile::remove(metaPath());
+    emit finished(true, QString());
+}
+
+void ModelDownloader::fail(const QString &error)
+{
+    if (m_reply) {
+        QNetworkReply *reply = m_reply;
+        m_reply = nullptr;
+        reply->disconnect(this);
+        reply->abort();
+        reply->deleteLater();
+    }
+    m_file.close();
+    emit finished(false, error);
+}
+
+QByteArray ModelDownloader::expectedChecksum() const
+{
+    if (!m_expectedSha256.isEmpty()) return m_expectedSha256;
+    QFile sidecar(m_targetPath + ".sha256");
+    if (sidecar.open(QIODevice::ReadOnly)) {
+        const QByteArray line = sidecar.readLine().trimmed();
+        const QByteArray hex = line.left(line.indexOf(' ') < 0 ? line.size() : line.indexOf(' '));
+        if (hex.size() == 64) return hex.toLower();
+    }
+    return m_serverSha256;
+}
@@ -0,0 +1,200 @@
+#include "core/packetindex.h"
+#include "core/mediacache.h"
+#include "core/stallwatchdog.h"
+#include <QFile>
+#include <QProcess>
+#include <QSaveFile>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+const char kMagic[8] = {'P', 'K', 'T', 'I', 'D', 'X', '\0', '\0'};
+const quint32 kFormatVersion = 1;
+const quint32 kByteOrderMark = 0x01020304;
+
+struct Header {
+    char magic[8];
+    quint32 formatVersion;
+    quint32 byteOrder;
+    quint64 sourceSize;
+    qint64 sourceModified;
+    qint64 durationUs;
+    quint64 frameCount;
+    quint64 keyframeCount;
+};
+
+qint64 secondsToUs(double seconds)
+{
+    return qint64(std::llround(seconds * 1e6));
+}
+
+} // namespace
+
+PacketIndex::PacketIndex(QVector<qint64> framesUs, QVector<qint64> keyframesUs, qint64 durationUs)
+    : m_frames(std::move(framesUs))
+    , m_keyframes(std::move(keyframesUs))
+    , m_durationUs(durationUs)
+{
+    // ffprobe отдаёт пакеты в порядке декодирования: с B-кадрами время скачет
+    std::sort(m_frames.begin(), m_frames.end());
+    std::sort(m_keyframes.begin(), m_keyframes.end());
+}
+
+QStringList PacketIndex::probeArguments(const QString &mediaPath)
+{
+    return QStringList{"-v", "error", "-select_streams", "v:0",
+                       "-show_entries", "format=duration:packet=pts_time,flags",
+                       "-of", "csv", mediaPath};
+}
+
+std::shared_ptr<PacketIndex> PacketIndex::fromProbeOutput(const QByteArray &csv)
+{
+    QVector<qint64> frames;
+    QVector<qint64> keyframes;
+    double duration = 0;
+    const QList<QByteArray> lines = csv.split('\n');
+    for (const QByteArray &line : lines) {
+        const QList<QByteArray> fields = line.trimmed().split(',');
+        if (fields.size() >= 3 && fields[0] == "packet") {
+            bool ok = false;
+            const double t = fields[1].toDouble(&ok);
+            if (!ok) continue; // pts_time=N/A
+            frames.append(secondsToUs(t));
+            if (fields[2].contains('K')) keyframes.append(secondsToUs(t));
+        } else if (fields.size() >= 2 && fields[0] == "format") {
+            duration = fields[1].toDouble();
+        }
+    }
+    if (duration <= 0) return nullptr;
+    return std::make_shared<PacketIndex>(std::move(frames), std::move(keyframes), secondsToUs(duration));
+}
+
+std::shared_ptr<const PacketIndex> PacketIndex::loadOrBuild(const QString &mediaPath, QString *error,
+                                                           const std::function<bool()> &cancelled)
+{
+    const QString cachePath = MediaCache::pathFor(mediaPath, "packets");
+    if (auto cached = load(cachePath, mediaPath)) return cached;
+
+    // Если всё же позвали из GUI-потока, зависание припишут ffprobe
+    StallWatchdog::Scope stallScope("PacketIndex: ffprobe");
+    QProcess probe;
+    probe.start("ffprobe", probeArguments(mediaPath));
+    if (!probe.waitForStarted()) {
+        if (error) *error = "Не удалось запустить ffprobe. Убедитесь, что он установлен и доступен в PATH.";
+        return nullptr;
+    }
+    // Весь файл проходит через демуксер; на длинных файлах (и по сети) это
+    // секунды, поэтому ждём порциями и бросаем, как только результат не нужен
+    while (!probe.waitForFinished(ProbePollMs) && probe.state() != QProcess::NotRunning) {
+        if (cancelled && cancelled()) {
+            probe.kill();
+            probe.waitForFinished();
+            if (error) *error = "Построение индекса отменено";
+            return nullptr;
+        }
+    }
+    if (probe.exitStatus() != QProcess::NormalExit || probe.exitCode() != 0) {
+        if (error) *error = "ffprobe завершился с ошибкой:\n" + QString::fromUtf8(probe.readAllStandardError());
+        return nullptr;
+    }
+    auto index = fromProbeOutput(probe.readAllStandardOutput());
+    if (!index) {
+        if (error) *error = "Не удалось определить длительность видео";
+        return nullptr;
+    }
+    index->save(cachePath, mediaPath);
+    return index;
+}
+
+bool PacketIndex::save(const QString &cachePath, const QString &sourcePath) const
+{
+    const MediaCache::SourceStamp stamp = MediaCache::SourceStamp::of(QFileInfo(sourcePath));
+    Header header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.formatVersion = kFormatVersion;
+    header.byteOrder = kByteOrderMark;
+    header.sourceSize = stamp.size;
+    header.sourceModified = stamp.modified;
+    header.durationUs = m_durationUs;
+    header.frameCount = quint64(m_frames.size());
+    header.keyframeCount = quint64(m_keyframes.size());
+
+    QSaveFile file(cachePath);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    const qint64 frameBytes = qint64(m_frames.size()) * qint64(sizeof(qint64));
+    const qint64 keyBytes = qint64(m_keyframes.size()) * qint64(sizeof(qint64));
+    bool ok = file.write(reinterpret_cast<const char *>(&header), sizeof(header)) == qint64(sizeof(header));
+    ok = ok && (frameBytes == 0 || file.write(reinterpret_cast<const char *>(m_frames.constData()), frameBytes) == frameBytes);
+    ok = ok && (keyBytes == 0 || file.write(reinterpret_cast<const char *>(m_keyframes.constData()), keyBytes) == keyBytes);
+    if (!ok || !file.commit()) {
+        file.cancelWriting();
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<PacketIndex> PacketIndex::load(const QString &cachePath, const QString &sourcePath)
+{
+    QFile file(cachePath);
+    if (!file.open(QIODevice::ReadOnly)) return nullptr;
+    Header header;
+    if (file.read(reinterpret_cast<char *>(&header), sizeof(header)) != qint64(sizeof(header))) return nullptr;
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.formatVersion != kFormatVersion
+        || header.byteOrder != kByteOrderMark) {
+        return nullptr;
+    }
+    MediaCache::SourceStamp stamp;
+    stamp.size = header.sourceSize;
+    stamp.modified = header.sourceModified;
+    if (stamp != MediaCache::SourceStamp::of(QFileInfo(sourcePath))) return nullptr;
+    const quint64 payload = quint64(file.size()) - sizeof(header);
+    if (header.frameCount + header.keyframeCount != payload / sizeof(qint64) || payload % sizeof(qint64) != 0) {
+        return nullptr;
+    }
+
+    auto index = std::make_shared<PacketIndex>();
+    index->m_durationUs = header.durationUs;
+    index->m_frames.resize(qsizetype(header.frameCount));
+    index->m_keyframes.resize(qsizetype(header.keyframeCount));
+    const qint64 frameBytes = qint64(header.frameCount) * qint64(sizeof(qint64));
+    const qint64 keyBytes = qint64(header.keyframeCount) * qint64(sizeof(qint64));
+    if (file.read(reinterpret_cast<char *>(index->m_frames.data()), frameBytes) != frameBytes
+        || file.read(reinterpret_cast<char *>(index->m_keyframes.data()), keyBytes) != keyBytes) {
+        return nullptr;
+    }
+    // Списки записаны отсортированными; чужой или битый файл сюда не пройдёт
+    if (!std::is_sorted(index->m_frames.cbegin(), index->m_frames.cend())
+        || !std::is_sorted(index->m_keyframes.cbegin(), index->m_keyframes.cend())) {
+        return nullptr;
+    }
+    return index;
+}
+
+int PacketIndex::frameAt(qint64 positionUs) const
+{
+    auto it = std::upper_bound(m_frames.cbegin(), m_frames.cend(), positionUs);
+    return int(it - m_frames.cbegin()) - 1;
+}
+
+qint64 PacketIndex::keyframeAtOrBefore(qint64 positionUs) const
+{
+    auto it = std::upper_bound(m_keyframes.cbegin(), m_keyframes.cend(), positionUs);
+    return it == m_keyframes.cbegin() ? 0 : *(it - 1);
+}
+
+qint64 PacketIndex::keyframeAtOrAfter(qint64 positionUs) const
+{
+    auto it = std::lower_bound(m_keyframes.cbegin(), m_keyframes.cend(), positionUs);
+    return it == m_keyframes.cend() ? -1 : *it;
+}
+
+qint64 PacketIndex::nearestKeyframe(qint64 positionUs) const
+{
+    if (m_keyframes.isEmpty()) return positionUs;
+    auto it = std::lower_bound(m_keyframes.cbegin(), m_keyframes.cend(), positionUs);
+    if (it == m_keyframes.cend()) return m_keyframes.last();
+    if (it == m_keyframes.cbegin()) return *it;
+    return positionUs - *(it - 1) <= *it - positionUs ? *(it - 1) : *it;
+}
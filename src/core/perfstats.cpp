@@ -0,0 +1,227 @@
+#include "core/perfstats.h"
+#include <QDateTime>
+#include <QFileInfo>
+#include <QStringList>
+#include <QSysInfo>
+#include <QTextStream>
+
+#if defined(Q_OS_LINUX)
+#include <unistd.h>
+#elif defined(Q_OS_MACOS)
+#include <libproc.h>
+#endif
+
+namespace {
+
+// Поле CSV в кавычках, если в нём есть разделитель или кавычка
+QString csvField(const QString &value)
+{
+    if (!value.contains(',') && !value.contains('"') && !value.contains('\n')) return value;
+    QString quoted = value;
+    quoted.replace('"', "\"\"");
+    return '"' + quoted + '"';
+}
+
+} // namespace
+
+PerfStats::PerfStats(QObject *parent)
+    : QObject(parent)
+{
+    m_timer.setInterval(SampleIntervalMs);
+    connect(&m_timer, &QTimer::timeout, this, &PerfStats::takeSample);
+}
+
+void PerfStats::setActive(bool active)
+{
+    if (active == isActive()) return;
+    if (active) {
+        m_frames = 0;
+        m_lastFramePts = -1;
+        m_frameStepMs = 0;
+        m_dropped = 0;
+        m_subtitleUpdates = 0;
+        m_subtitleTotalNs = 0;
+        m_subtitleMaxNs = 0;
+        m_interval.start();
+        m_timer.start();
+    } else {
+        m_timer.stop();
+    }
+}
+
+void PerfStats::setSyncSource(std::function<SubtitleScheduler::SyncStats()> source)
+{
+    m_syncSource = std::move(source);
+}
+
+void PerfStats::setContext(const QString &mediaFile, const QString &model)
+{
+    m_mediaFile = mediaFile;
+    m_model = model;
+}
+
+bool PerfStats::setCsvPath(const QString &path, QString *error)
+{
+    if (m_csv.isOpen()) m_csv.close();
+    if (path.isEmpty()) return true;
+    m_csv.setFileName(path);
+    if (!m_csv.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        if (error) *error = m_csv.errorString();
+        return false;
+    }
+    if (m_csv.size() == 0) {
+        m_csv.write("timestamp,host,file,model,fps,dropped_frames,subtitle_updates,subtitle_mean_us,subtitle_max_us,"
+                    "whisper_rtf,child_processes,child_rss_mb,child_peak_rss_mb,"
+                    "sync_samples,sync_boundary_mean_ms,sync_boundary_max_ms,sync_drift_ms,sync_drift_max_ms\n");
+        m_csv.flush();
+    }
+    return true;
+}
+
+void PerfStats::frameShown(qint64 position)
+{
+    ++m_frames;
+    if (m_lastFramePts >= 0) {
+        const qint64 step = position - m_lastFramePts;
+        if (step <= 0) {
+            // Перемотка назад или новый файл - частота кадров могла смениться
+            m_frameStepMs = 0;
+        } else {
+            if (m_frameStepMs == 0 || step < m_frameStepMs) m_frameStepMs = step;
+            // Разрыв больше полутора кадров - пропущенные кадры (перемотки не считаем)
+            if (step < 1000 && 2 * step > 3 * m_frameStepMs) {
+                m_dropped += quint64((step + m_frameStepMs / 2) / m_frameStepMs - 1);
+            }
+        }
+    }
+    m_lastFramePts = position;
+}
+
+void PerfStats::subtitleUpdated(qint64 costNs)
+{
+    ++m_subtitleUpdates;
+    m_subtitleTotalNs += costNs;
+    m_subtitleMaxNs = qMax(m_subtitleMaxNs, costNs);
+}
+
+void PerfStats::transcribed(qint64 audioMs, qint64 wallMs)
+{
+    if (audioMs <= 0) return;
+    m_audioMs += audioMs;
+    m_wallMs += wallMs;
+}
+
+void PerfStats::watchProcess(QProcess *process)
+{
+    m_processes.append(process);
+}
+
+void PerfStats::resetTranscription()
+{
+    m_audioMs = 0;
+    m_wallMs = 0;
+    m_peakRss = 0;
+}
+
+qint64 PerfStats::processRssBytes(qint64 pid)
+{
+    if (pid <= 0) return -1;
+#if defined(Q_OS_LINUX)
+    // Вторая колонка statm - резидентные страницы
+    QFile statm(QString("/proc/%1/statm").arg(pid));
+    if (!statm.open(QIODevice::ReadOnly)) return -1;
+    const QList<QByteArray> fields = statm.readAll().split(' ');
+    if (fields.size() < 2) return -1;
+    return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+#elif defined(Q_OS_MACOS)
+    proc_taskinfo info;
+    if (proc_pidinfo(int(pid), PROC_PIDTASKINFO, 0, &info, sizeof(info)) != int(sizeof(info))) return -1;
+    return qint64(info.pti_resident_size);
+#else
+    return -1;
+#endif
+}
+
+void PerfStats::takeSample()
+{
+    Sample sample;
+    sample.timestampMs = QDateTime::currentMSecsSinceEpoch();
+    const qint64 elapsed = m_interval.restart();
+    sample.fps = elapsed > 0 ? m_frames * 1000.0 / elapsed : 0;
+    sample.droppedFrames = m_dropped;
+    sample.subtitleUpdates = m_subtitleUpdates;
+    sample.subtitleMeanUs = m_subtitleUpdates > 0 ? m_subtitleTotalNs / 1000.0 / m_subtitleUpdates : 0;
+    sample.subtitleMaxUs = m_subtitleMaxNs / 1000.0;
+    sample.whisperRtf = m_audioMs > 0 ? double(m_wallMs) / m_audioMs : -1;
+
+    for (auto it = m_processes.begin(); it != m_processes.end();) {
+        QProcess *process = *it;
+        if (!process || process->state() == QProcess::NotRunning) {
+            it = m_processes.erase(it);
+            continue;
+        }
+        const qint64 rss = processRssBytes(process->processId());
+        if (rss > 0) {
+            sample.childRssBytes += rss;
+            ++sample.childProcesses;
+        }
+        ++it;
+    }
+    m_peakRss = qMax(m_peakRss, sample.childRssBytes);
+    sample.childPeakRssBytes = m_peakRss;
+    if (m_syncSource) sample.sync = m_syncSource();
+
+    m_frames = 0;
+    m_subtitleUpdates = 0;
+    m_subtitleTotalNs = 0;
+    m_subtitleMaxNs = 0;
+
+    m_last = sample;
+    writeCsv(sample);
+    emit sampled(sample);
+}
+
+void PerfStats::writeCsv(const Sample &sample)
+{
+    if (!m_csv.isOpen()) return;
+    const double mb = 1024.0 * 1024.0;
+    QTextStream out(&m_csv);
+    out << QDateTime::fromMSecsSinceEpoch(sample.timestampMs, Qt::UTC).toString(Qt::ISODateWithMs) << ','
+        << csvField(QSysInfo::machineHostName()) << ','
+        << csvField(QFileInfo(m_mediaFile).fileName()) << ','
+        << csvField(m_model) << ','
+        << QString::number(sample.fps, 'f', 2) << ','
+        << sample.droppedFrames << ','
+        << sample.subtitleUpdates << ','
+        << QString::number(sample.subtitleMeanUs, 'f', 1) << ','
+        << QString::number(sample.subtitleMaxUs, 'f', 1) << ','
+        << (sample.whisperRtf >= 0 ? QString::number(sample.whisperRtf, 'f', 3) : QString()) << ','
+        << sample.childProcesses << ','
+        << QString::number(sample.childRssBytes / mb, 'f', 1) << ','
+        << QString::number(sample.childPeakRssBytes / mb, 'f', 1) << ','
+        << sample.sync.samples << ','
+        << QString::number(sample.sync.meanBoundaryErrorMs, 'f', 1) << ','
+        << sample.sync.maxBoundaryErrorMs << ','
+        << sample.sync.lastDriftMs << ','
+        << sample.sync.maxAbsDriftMs << '\n';
+    out.flush();
+}
+
+QString PerfStats::format(const Sample &sample)
+{
+    QStringList lines;
+    lines << QString("FPS %1   dropped %2").arg(sample.fps, 0, 'f', 1).arg(sample.droppedFrames);
+    lines << QString("subtitle update %1 µs (max %2 µs, %3/s)")
+                 .arg(sample.subtitleMeanUs, 0, 'f', 1).arg(sample.subtitleMaxUs, 0, 'f', 1).arg(sample.subtitleUpdates);
+    lines << QString("sync boundary %1 ms (max %2)   drift %3 ms (max %4)")
+                 .arg(sample.sync.meanBoundaryErrorMs, 0, 'f', 1).arg(sample.sync.maxBoundaryErrorMs)
+                 .arg(sample.sync.lastDriftMs).arg(sample.sync.maxAbsDriftMs);
+    if (sample.whisperRtf >= 0 || sample.childProcesses > 0) {
+        lines << QString("whisper RTF %1   children %2, RSS %3 MB (peak %4)")
+                     .arg(sample.whisperRtf >= 0 ? QString::number(sample.whisperRtf, 'f', 2) : QString("-"))
+                     .arg(sample.childProcesses)
+                     .arg(sample.childRssBytes / (1024 * 1024))
+                     .arg(sample.childPeakRssBytes / (1024 * 1024));
+    }
+    return lines.join('\n');
+}
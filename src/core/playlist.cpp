@@ -0,0 +1,30 @@
+#include "core/playlist.h"
+
+void Playlist::setItems(const QStringList &items, int current)
+{
+    m_items = items;
+    m_current = m_items.isEmpty() ? -1 : qBound(0, current, int(m_items.size()) - 1);
+}
+
+void Playlist::clear()
+{
+    m_items.clear();
+    m_current = -1;
+}
+
+QString Playlist::current() const
+{
+    return m_current >= 0 ? m_items.at(m_current) : QString();
+}
+
+QString Playlist::next() const
+{
+    return hasNext() ? m_items.at(m_current + 1) : QString();
+}
+
+bool Playlist::advance()
+{
+    if (!hasNext()) return false;
+    ++m_current;
+    return true;
+}
@@ -0,0 +1,169 @@
+#include "core/seekcoordinator.h"
+#include <QDebug>
+#include <QMediaPlayer>
+#include <QtConcurrent>
+
+SeekCoordinator::SeekCoordinator(QMediaPlayer *player, QObject *parent)
+    : QObject(parent)
+    , m_player(player)
+{
+    m_pool.setMaxThreadCount(1);
+    m_settleTimer.setSingleShot(true);
+    m_settleTimer.setInterval(SettleTimeoutMs);
+    connect(&m_settleTimer, &QTimer::timeout, this, &SeekCoordinator::settle);
+}
+
+SeekCoordinator::~SeekCoordinator()
+{
+    ++m_generation;
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+void SeekCoordinator::loadIndex(const QString &mediaPath)
+{
+    if (mediaPath == m_indexPath) return;
+    ++m_generation;
+    m_pool.clear();
+    m_indexPath = mediaPath;
+    m_index.reset();
+    if (mediaPath.isEmpty()) return;
+
+    const quint64 generation = m_generation;
+    QtConcurrent::run(&m_pool, [this, mediaPath, generation]() {
+        if (generation != m_generation) return;
+        QString error;
+        // Новый файл или деструктор меняют поколение - ffprobe прежнего тут же убивается
+        PacketIndexPtr index = PacketIndex::loadOrBuild(mediaPath, &error, [this, generation]() {
+            return generation != m_generation;
+        });
+        if (!index) qDebug() << "SeekCoordinator: no packet index:" << error;
+        // Деструктор дожидается пула, так что this переживает задачу
+        QMetaObject::invokeMethod(this, [this, index, generation]() {
+            if (generation != m_generation || !index) return;
+            m_index = index;
+            qDebug() << "SeekCoordinator: index ready," << index->frameCount() << "frames,"
+                     << index->keyframes().size() << "keyframes";
+            emit indexReady(m_index);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void SeekCoordinator::setIndex(const QString &mediaPath, PacketIndexPtr index)
+{
+    if (!index) {
+        loadIndex(mediaPath);
+        return;
+    }
+    ++m_generation;
+    m_pool.clear();
+    m_indexPath = mediaPath;
+    m_index = std::move(index);
+    emit indexReady(m_index);
+}
+
+void SeekCoordinator::setPlayer(QMediaPlayer *player)
+{
+    // Перемотки прежнего плеера к новому не относятся
+    m_player = player;
+    m_settleTimer.stop();
+    m_inFlight = false;
+    m_hasPending = false;
+}
+
+qint64 SeekCoordinator::targetPosition() const
+{
+    if (m_hasPending) return m_pending;
+    if (m_inFlight) return m_issued;
+    return m_player->position();
+}
+
+void SeekCoordinator::seek(qint64 positionMs, Mode mode)
+{
+    positionMs = qMax<qint64>(0, positionMs);
+    if (mode == Fast && m_index && !m_index->keyframes().isEmpty()) {
+        positionMs = (m_index->nearestKeyframe(positionMs * 1000) + 999) / 1000;
+    }
+    request(positionMs);
+}
+
+qint64 SeekCoordinator::seekBy(qint64 deltaMs, Mode mode)
+{
+    const qint64 current = targetPosition();
+    qint64 target = qMax<qint64>(0, current + deltaMs);
+    if (m_player->duration() > 0) target = qMin(target, m_player->duration());
+    if (mode == Fast && deltaMs != 0 && m_index && !m_index->keyframes().isEmpty()) {
+        // Ближайший ключевой кадр при GOP длиннее шага - текущий, и зажатая
+        // клавиша топталась бы на месте. Берём первый в сторону движения
+        const qint64 currentUs = current * 1000;
+        qint64 keyUs = -1;
+        if (deltaMs > 0) {
+            keyUs = m_index->keyframeAtOrAfter(qMax(target * 1000, currentUs + 1));
+        } else {
+            // Позиция после быстрой перемотки - ключевой кадр, округлённый вверх до мс
+            const qint64 currentKey = m_index->keyframeAtOrBefore(currentUs);
+            const qint64 limit = currentUs - currentKey < 1000 ? currentKey - 1 : currentUs - 1;
+            keyUs = limit < 0 ? 0 : m_index->keyframeAtOrBefore(qMin(target * 1000, limit));
+        }
+        // За последним ключевым кадром вперёд - просто в цель
+        if (keyUs >= 0) target = (keyUs + 999) / 1000;
+    }
+    request(target);
+    return target;
+}
+
+void SeekCoordinator::request(qint64 positionMs)
+{
+    if (m_inFlight) {
+        // Декодер ещё занят - запоминаем только последнюю цель
+        m_pending = positionMs;
+        m_hasPending = true;
+        return;
+    }
+    issue(positionMs);
+}
+
+void SeekCoordinator::stepFrame(int direction)
+{
+    if (direction == 0) return;
+    if (m_player->playbackState() == QMediaPlayer::PlayingState) m_player->pause();
+
+    const qint64 current = targetPosition();
+    qint64 target = current + (direction > 0 ? FallbackFrameMs : -FallbackFrameMs);
+    if (m_index && m_index->hasVideo()) {
+        // Позиция плеера в мс округлена вниз: кадр, начавшийся внутри этой
+        // миллисекунды, уже считается текущим
+        const int frame = m_index->frameAt(current * 1000 + 999);
+        const int next = qBound(0, frame + (direction > 0 ? 1 : -1), m_index->frameCount() - 1);
+        // Вверх до мс, чтобы попасть внутрь кадра, а не на конец предыдущего
+        target = (m_index->frameTime(next) + 999) / 1000;
+    }
+    seek(target, Exact);
+}
+
+void SeekCoordinator::issue(qint64 positionMs)
+{
+    m_inFlight = true;
+    m_issued = positionMs;
+    // Без видео кадров не будет: звук перематывается дёшево, ждём недолго
+    m_settleTimer.start(m_index && !m_index->hasVideo() ? SettleTimeoutMs / 5 : SettleTimeoutMs);
+    m_player->setPosition(positionMs);
+    emit seekIssued(positionMs);
+}
+
+void SeekCoordinator::frameArrived(qint64 framePositionMs)
+{
+    if (m_inFlight && qAbs(framePositionMs - m_issued) <= ArrivalToleranceMs) {
+        settle();
+    }
+}
+
+void SeekCoordinator::settle()
+{
+    m_settleTimer.stop();
+    m_inFlight = false;
+    if (m_hasPending) {
+        m_hasPending = false;
+        if (m_pending != m_issued) issue(m_pending);
+    }
+}
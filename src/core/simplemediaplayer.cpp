@@ -12,7 +12,6 @@
 #include <QSettings>
 #include <QPainter>
 #include <QTextDocument>
-#include <QRegularExpression>
 #include <QTimer>
 #include <QMutex>
 #include <QMutexLocker>
@@ -21,7 +20,30 @@
 #include <QFutureWatcher>
 #include <QLabel>
 #include "ui/videowidget.h"
+#include "core/subtitleburnexporter.h"
+#include "core/srtparser.h"
+#include "core/subtitlescheduler.h"
+#include "core/livesubtitletrack.h"
+#include "core/subtitleloader.h"
+#include "core/subtitleindex.h"
+#include "core/subtitlewriter.h"
+#include "ui/subtitlesearchpanel.h"
+#include "ui/seekslider.h"
+#include "core/waveformbuilder.h"
+#include "core/thumbnailbuilder.h"
+#include "core/seekcoordinator.h"
+#include "core/packetindex.h"
+#include "core/mediacache.h"
+#include "core/startupprofiler.h"
+#include "core/trace.h"
+#include "core/perfstats.h"
+#include "core/transcriptionpipeline.h"
+#include "core/stallwatchdog.h"
+#include <QElapsedTimer>
+#include <QThreadPool>
 #include <QGraphicsVideoItem>
+#include <QVideoSink>
+#include <QVideoFrame>
 #include <QComboBox>
 #include <QIcon>
 
@@ -36,17 +58,39 @@ SimpleMediaPlayer::SimpleMediaPlayer(QWidget *parent)
     // Set focus policy to receive keyboard events
     setFocusPolicy(Qt::StrongFocus);
     
-    // Создаем медиаплеер
+    // Создаем медиаплеер. Аудио- и видеовыход подключаются в ensureOutputs():
+    // до первой отрисовки окна они не нужны, а поднимаются заметное время
     m_mediaPlayer = new QMediaPlayer(this);
     
-    // Создаем аудиовыход
-    m_audioOutput = new QAudioOutput(this);
-    m_mediaPlayer->setAudioOutput(m_audioOutput);
-    
     // Создаем виджет для видео
     m_videoWidget = new VideoGraphicsView(this);
-    QGraphicsVideoItem *videoItem = static_cast<VideoGraphicsView*>(m_videoWidget)->videoItem();
-    m_mediaPlayer->setVideoOutput(videoItem);
+    QGraphicsVideoItem *videoItem = m_videoWidget->videoItem();
+    StartupProfiler::mark("player: media and scene");
+    
+    // Субтитры переключаются по таймеру на границах реплик, а не на каждом positionChanged
+    m_subtitleScheduler = new SubtitleScheduler(this);
+    connect(m_subtitleScheduler, &SubtitleScheduler::cueChanged, m_videoWidget, &VideoGraphicsView::showCue);
+    // Все перемотки идут через координатор: пока декодер занят, выполняется только последняя
+    m_seekCoordinator = new SeekCoordinator(m_mediaPlayer, this);
+    connect(m_seekCoordinator, &SeekCoordinator::seekIssued, m_subtitleScheduler, &SubtitleScheduler::seek);
+    // Счётчики для оверлея статистики и телеметрии; считают, только пока включены
+    m_perfStats = new PerfStats(this);
+    m_perfStats->setSyncSource([this]() { return m_subtitleScheduler->syncStats(); });
+    // Реплики меняются по времени показа кадров, пришедших в sink видеоэлемента.
+    // Кадр может прийти из потока декодера - тогда доставка встанет в очередь
+    // GUI-потока рядом с обновлением самого видеоэлемента
+    connect(videoItem->videoSink(), &QVideoSink::videoFrameChanged, m_subtitleScheduler, [this](const QVideoFrame &frame) {
+        if (frame.isValid() && frame.startTime() >= 0) {
+            m_subtitleScheduler->presentFrame(frame.startTime() / 1000);
+            m_seekCoordinator->frameArrived(frame.startTime() / 1000);
+            if (m_perfStats->isActive()) m_perfStats->frameShown(frame.startTime() / 1000);
+        }
+    });
+    // Фоновая загрузка и разбор субтитров. Один поток: у живой дорожки
+    // транскрипции должен быть единственный писатель
+    m_subtitleWorker = new QThreadPool(this);
+    m_subtitleWorker->setMaxThreadCount(1);
+    StartupProfiler::mark("player: subtitle and seek core");
     
     // Создаем UI элементы
     m_playButton = new QPushButton(this);
@@ -65,6 +109,11 @@ SimpleMediaPlayer::SimpleMediaPlayer(QWidget *parent)
     m_resetButton->setIcon(style()->standardIcon(QStyle::SP_DialogResetButton));
     m_resetButton->setToolTip("Reset");
     
+    m_nextButton = new QPushButton(this);
+    m_nextButton->setText("⏭");
+    m_nextButton->setToolTip("Следующий файл плейлиста");
+    m_nextButton->setEnabled(false);
+    
     m_settingsButton = new QPushButton(this);
     m_settingsButton->setIcon(style()->standardIcon(QStyle::SP_FileDialogDetailedView));
     m_settingsButton->setToolTip("Настройки");
@@ -77,12 +126,25 @@ SimpleMediaPlayer::SimpleMediaPlayer(QWidget *parent)
     m_subtitlesOverlayButton->setText("📝");
     m_subtitlesOverlayButton->setToolTip("Создать субтитры поверх видео (Whisper)");
     
+    m_exportSubtitlesButton = new QPushButton(this);
+    m_exportSubtitlesButton->setText("💾");
+    m_exportSubtitlesButton->setToolTip("Экспорт субтитров (SRT, WebVTT, ASS)");
+    
+    m_burnSubtitlesButton = new QPushButton(this);
+    m_burnSubtitlesButton->setText("🎞");
+    m_burnSubtitlesButton->setToolTip("Экспорт видео с вшитыми субтитрами");
+    
+    m_searchButton = new QPushButton(this);
+    m_searchButton->setText("🔍");
+    m_searchButton->setToolTip("Поиск по субтитрам");
+    m_searchButton->setCheckable(true);
+    
     m_showSubtitlesCheckBox = new QCheckBox(this);
     m_showSubtitlesCheckBox->setText("Показать субтитры");
     m_showSubtitlesCheckBox->setToolTip("Показать/скрыть субтитры");
     m_showSubtitlesCheckBox->setChecked(true); // По умолчанию субтитры показаны
     
-    m_positionSlider = new QSlider(Qt::Horizontal, this);
+    m_positionSlider = new SeekSlider(Qt::Horizontal, this);
     m_positionSlider->setMinimum(0);
     m_positionSlider->setMaximum(0);
     m_positionSlider->setSingleStep(1);
@@ -120,6 +182,7 @@ SimpleMediaPlayer::SimpleMediaPlayer(QWidget *parent)
     QVBoxLayout *mainLayout = new QVBoxLayout(this);
     mainLayout->addWidget(m_videoWidget);
     mainLayout->addWidget(m_infoLabel);
+    // Панель поиска встаёт сюда при первом открытии (ensureSearchPanel)
 
     // Новый layout для слайдера, времени и громкости
     QHBoxLayout *sliderLayout = new QHBoxLayout();
@@ -138,16 +201,18 @@ SimpleMediaPlayer::SimpleMediaPlayer(QWidget *parent)
     controlsLayout->addWidget(m_stopButton);
     controlsLayout->addWidget(m_openButton);
     controlsLayout->addWidget(m_resetButton);
+    controlsLayout->addWidget(m_nextButton);
     controlsLayout->addWidget(m_settingsButton);
     controlsLayout->addWidget(m_subtitlesButton);
     controlsLayout->addWidget(m_subtitlesOverlayButton);
+    controlsLayout->addWidget(m_exportSubtitlesButton);
+    controlsLayout->addWidget(m_burnSubtitlesButton);
+    controlsLayout->addWidget(m_searchButton);
     controlsLayout->addWidget(m_showSubtitlesCheckBox);
     mainLayout->addLayout(controlsLayout);
     
     // Подключаем сигналы
-    connect(m_mediaPlayer, &QMediaPlayer::positionChanged, this, &SimpleMediaPlayer::onPositionChanged);
-    connect(m_mediaPlayer, &QMediaPlayer::durationChanged, this, &SimpleMediaPlayer::onDurationChanged);
-    connect(m_mediaPlayer, &QMediaPlayer::playbackStateChanged, this, &SimpleMediaPlayer::onPlaybackStateChanged);
+    connectPlayer(m_mediaPlayer);
     
     connect(m_playButton, &QPushButton::clicked, [this]() {
         if (m_mediaPlayer->playbackState() == QMediaPlayer::PlayingState) {
@@ -160,23 +225,27 @@ SimpleMediaPlayer::SimpleMediaPlayer(QWidget *parent)
     connect(m_stopButton, &QPushButton::clicked, this, &SimpleMediaPlayer::stop);
     
     connect(m_openButton, &QPushButton::clicked, [this]() {
-        QString filePath = QFileDialog::getOpenFileName(this, 
+        // Несколько выбранных файлов играются подряд, в порядке выбора
+        QStringList filePaths = QFileDialog::getOpenFileNames(this, 
             "Open Media File", 
             QDir::homePath(),
             "Media Files (*.mp4 *.avi *.mkv *.mov *.wmv *.flv *.webm *.mp3 *.wav *.flac *.m4a *.aac)");
         
-        if (!filePath.isEmpty()) {
-            openFile(filePath);
+        if (!filePaths.isEmpty()) {
+            openPlaylist(filePaths);
         }
     });
     
     connect(m_resetButton, &QPushButton::clicked, this, &SimpleMediaPlayer::reset);
+    connect(m_nextButton, &QPushButton::clicked, this, &SimpleMediaPlayer::playNext);
     
     connect(m_positionSlider, &QSlider::sliderPressed, this, &SimpleMediaPlayer::onSliderPressed);
     connect(m_positionSlider, &QSlider::sliderReleased, this, &SimpleMediaPlayer::onSliderReleased);
     connect(m_positionSlider, &QSlider::sliderMoved, this, &SimpleMediaPlayer::onSliderMoved);
     
-    connect(m_volumeSlider, &QSlider::valueChanged, m_audioOutput, &QAudioOutput::setVolume);
+    connect(m_volumeSlider, &QSlider::valueChanged, this, [this](int value) {
+        if (m_audioOutput) m_audioOutput->setVolume(value);
+    });
     
     connect(m_settingsButton, &QPushButton::clicked, this, [this]() {
         WhisperModelSettingsDialog dlg(this);
@@ -187,26 +256,148 @@ SimpleMediaPlayer::SimpleMediaPlayer(QWidget *parent)
     
     connect(m_subtitlesOverlayButton, &QPushButton::clicked, this, &SimpleMediaPlayer::createSubtitlesOverlay);
     
+    connect(m_exportSubtitlesButton, &QPushButton::clicked, this, &SimpleMediaPlayer::exportSubtitles);
+    
+    connect(m_searchButton, &QPushButton::toggled, this, [this](bool checked) {
+        if (checked) {
+            ensureSearchPanel();
+            m_searchPanel->show();
+            m_searchPanel->focusQuery();
+        } else {
+            if (m_searchPanel) m_searchPanel->hide();
+            setFocus();
+        }
+    });
+    connect(m_burnSubtitlesButton, &QPushButton::clicked, this, &SimpleMediaPlayer::exportBurnedSubtitles);
+    
     connect(m_showSubtitlesCheckBox, &QCheckBox::toggled, this, &SimpleMediaPlayer::toggleSubtitlesVisibility);
     
     // Устанавливаем размер окна
     resize(800, 600);
     setWindowTitle("Simple Media Player");
     m_videoWidget->hide(); // Скрываем видео по умолчанию
+    connect(m_perfStats, &PerfStats::sampled, this, [this](const PerfStats::Sample &sample) {
+        m_videoWidget->setStatsText(PerfStats::format(sample));
+    });
+    // Телеметрия в CSV для сравнения моделей, файлов и машин
+    const QString telemetryPath = qEnvironmentVariable("SIMPLE_PLAYER_TELEMETRY_CSV");
+    if (!telemetryPath.isEmpty()) {
+        QString error;
+        if (m_perfStats->setCsvPath(telemetryPath, &error)) {
+            updatePerfStatsActive();
+        } else {
+            qDebug() << "SimpleMediaPlayer: telemetry CSV not opened:" << telemetryPath << error;
+        }
+    }
+    
+    StartupProfiler::mark("player: widgets and layout");
+}
+
+void SimpleMediaPlayer::toggleStatsOverlay()
+{
+    m_videoWidget->setStatsVisible(!m_videoWidget->statsVisible());
+    updatePerfStatsActive();
+}
+
+void SimpleMediaPlayer::updatePerfStatsActive()
+{
+    // Сбор нужен оверлею или телеметрии
+    const bool active = m_videoWidget->statsVisible() || !qEnvironmentVariable("SIMPLE_PLAYER_TELEMETRY_CSV").isEmpty();
+    m_perfStats->setActive(active);
+    m_videoWidget->setPerfStats(active ? m_perfStats : nullptr);
+    if (active) m_videoWidget->setStatsText(PerfStats::format(m_perfStats->lastSample()));
+}
+
+void SimpleMediaPlayer::paintEvent(QPaintEvent *event)
+{
+    QWidget::paintEvent(event);
+    if (!StartupProfiler::firstPaintDone()) {
+        StartupProfiler::firstPaint();
+        // Окно на экране - теперь можно поднять выходы, не задерживая его показ
+        QTimer::singleShot(0, this, &SimpleMediaPlayer::ensureOutputs);
+    }
+}
+
+void SimpleMediaPlayer::ensureOutputs()
+{
+    if (m_audioOutput) return;
+    m_audioOutput = new QAudioOutput(this);
+    m_audioOutput->setVolume(m_volumeSlider->value());
+    m_mediaPlayer->setAudioOutput(m_audioOutput);
+    m_mediaPlayer->setVideoOutput(m_videoWidget->videoItem());
+    StartupProfiler::mark("audio and video outputs");
+}
+
+void SimpleMediaPlayer::ensureSearchPanel()
+{
+    if (m_searchPanel) return;
+    m_searchPanel = new SubtitleSearchPanel(this);
+    m_searchPanel->setMaximumHeight(180);
+    m_searchPanel->hide();
+    // Под видео и информационной меткой, над ползунком
+    static_cast<QVBoxLayout *>(layout())->insertWidget(2, m_searchPanel);
+    connect(m_searchPanel, &SubtitleSearchPanel::seekRequested, this, &SimpleMediaPlayer::seek);
+    m_searchPanel->setTrack(m_subtitleScheduler->track());
+}
+
+void SimpleMediaPlayer::ensureOverviewBuilders()
+{
+    if (m_waveformBuilder) return;
+    // Волна и миниатюры для ползунка позиции считаются в фоне, когда стала известна длительность
+    m_waveformBuilder = new WaveformBuilder(this);
+    m_thumbnailBuilder = new ThumbnailBuilder(this);
+    connect(m_waveformBuilder, &WaveformBuilder::pyramidChanged, m_positionSlider, &SeekSlider::setWaveform);
+    connect(m_waveformBuilder, &WaveformBuilder::progressed, m_positionSlider, &SeekSlider::waveformUpdated);
+    connect(m_thumbnailBuilder, &ThumbnailBuilder::atlasChanged, m_positionSlider, &SeekSlider::setThumbnails);
+}
+
+void SimpleMediaPlayer::clearOverview()
+{
+    if (m_waveformBuilder) {
+        m_waveformBuilder->cancel();
+        m_thumbnailBuilder->cancel();
+    }
+    m_positionSlider->setWaveform(nullptr);
+    m_positionSlider->setThumbnails(nullptr);
 }
 
 SimpleMediaPlayer::~SimpleMediaPlayer()
 {
     qDebug() << "SimpleMediaPlayer::~SimpleMediaPlayer() called";
+    m_subtitleWorker->clear();
+    m_subtitleWorker->waitForDone();
 }
 
 bool SimpleMediaPlayer::openFile(const QString &filePath)
 {
-    if (filePath.isEmpty()) {
+    return openPlaylist(QStringList{filePath});
+}
+
+bool SimpleMediaPlayer::openPlaylist(const QStringList &filePaths)
+{
+    QStringList items;
+    for (const QString &path : filePaths) {
+        if (!path.isEmpty()) items.append(path);
+    }
+    if (items.isEmpty()) {
         return false;
     }
     
+    m_playlist.setItems(items);
+    loadItem(m_playlist.current());
+    preloadNext();
+    return true;
+}
+
+void SimpleMediaPlayer::loadItem(const QString &filePath)
+{
+    ensureOutputs();
     m_mediaPlayer->setSource(QUrl::fromLocalFile(filePath));
+    m_seekCoordinator->loadIndex(filePath);
+    m_perfStats->setContext(filePath, QString());
+    clearOverview();
+    // Субтитры прежнего видео к новому не относятся; соседние ищем в фоне
+    loadSiblingSubtitles(filePath);
     
     // Скрываем информационную метку при загрузке файла
     m_infoLabel->hide();
@@ -214,8 +405,115 @@ bool SimpleMediaPlayer::openFile(const QString &filePath)
     
     qDebug() << "SimpleMediaPlayer: opened file:" << filePath;
     emit fileLoaded(filePath);
-    
-    return true;
+}
+
+void SimpleMediaPlayer::connectPlayer(QMediaPlayer *player)
+{
+    connect(player, &QMediaPlayer::positionChanged, this, &SimpleMediaPlayer::onPositionChanged);
+    connect(player, &QMediaPlayer::durationChanged, this, &SimpleMediaPlayer::onDurationChanged);
+    connect(player, &QMediaPlayer::playbackStateChanged, this, &SimpleMediaPlayer::onPlaybackStateChanged);
+    connect(player, &QMediaPlayer::mediaStatusChanged, this, &SimpleMediaPlayer::onMediaStatusChanged);
+}
+
+void SimpleMediaPlayer::onMediaStatusChanged(QMediaPlayer::MediaStatus status)
+{
+    if (status == QMediaPlayer::EndOfMedia && m_playlist.hasNext()) {
+        playNext();
+    }
+}
+
+void SimpleMediaPlayer::playNext()
+{
+    if (!m_playlist.advance()) return;
+    const QString path = m_playlist.current();
+    const QMediaPlayer::MediaStatus status = m_preloadPlayer ? m_preloadPlayer->mediaStatus() : QMediaPlayer::NoMedia;
+    if (path == m_preloadedPath && (status == QMediaPlayer::LoadedMedia || status == QMediaPlayer::BufferedMedia)) {
+        switchToPreloaded();
+    } else {
+        // Предзагрузка не успела (или не удалась) - обычное открытие
+        dropPreloaded();
+        loadItem(path);
+        play();
+    }
+    preloadNext();
+}
+
+void SimpleMediaPlayer::switchToPreloaded()
+{
+    const QString path = m_preloadedPath;
+    QMediaPlayer *previous = m_mediaPlayer;
+    QMediaPlayer *next = m_preloadPlayer;
+    QGraphicsVideoItem *videoItem = m_videoWidget->videoItem();
+
+    // Выходы переносятся на уже открытый плеер - демуксер не открывается заново
+    disconnect(previous, nullptr, this, nullptr);
+    previous->stop();
+    previous->setVideoOutput(nullptr);
+    previous->setAudioOutput(nullptr);
+    next->setAudioOutput(m_audioOutput);
+    next->setVideoOutput(videoItem);
+    next->setPlaybackRate(m_playbackRate);
+    m_mediaPlayer = next;
+    m_preloadPlayer = previous;
+    connectPlayer(m_mediaPlayer);
+    m_seekCoordinator->setPlayer(m_mediaPlayer);
+    m_seekCoordinator->setIndex(path, m_preloadedIndex);
+    m_perfStats->setContext(path, QString());
+
+    // Субтитры уже разобраны заранее; если их не нашлось - ищем как обычно
+    clearOverview();
+    if (m_preloadedSubtitles) {
+        ++m_subtitleLoadGeneration;
+        m_liveTrack.reset();
+        setSubtitleTrack(m_preloadedSubtitles);
+    } else {
+        loadSiblingSubtitles(path);
+    }
+    m_mediaPlayer->play();
+    // durationChanged у предзагруженного плеера уже был - повторяем его обработку
+    onDurationChanged(m_mediaPlayer->duration());
+
+    qDebug() << "SimpleMediaPlayer: switched to preloaded file:" << path;
+    dropPreloaded();
+    emit fileLoaded(path);
+}
+
+void SimpleMediaPlayer::dropPreloaded()
+{
+    ++m_preloadGeneration;
+    m_preloadedPath.clear();
+    m_preloadedSubtitles.reset();
+    m_preloadedIndex.reset();
+    if (m_preloadPlayer) m_preloadPlayer->setSource(QUrl());
+}
+
+void SimpleMediaPlayer::preloadNext()
+{
+    dropPreloaded();
+    m_nextButton->setEnabled(m_playlist.hasNext());
+    if (!m_playlist.hasNext()) return;
+
+    const QString path = m_playlist.next();
+    m_preloadedPath = path;
+    if (!m_preloadPlayer) m_preloadPlayer = new QMediaPlayer(this);
+    m_preloadPlayer->setSource(QUrl::fromLocalFile(path));
+    // Субтитры и индекс пакетов - только то, что берётся из готовых файлов:
+    // ffprobe и разбор без индекса дождутся переключения
+    const quint64 generation = m_preloadGeneration;
+    QtConcurrent::run(m_subtitleWorker, [this, path, generation]() {
+        SubtitleTrackPtr subtitles;
+        for (const QString &candidate : SubtitleLoader::siblingCandidates(path)) {
+            if (generation != m_preloadGeneration.load()) return;
+            subtitles = SubtitleLoader::loadFile(candidate);
+            if (subtitles) break;
+        }
+        PacketIndexPtr index = PacketIndex::load(MediaCache::pathFor(path, "packets"), path);
+        QMetaObject::invokeMethod(this, [this, subtitles, index, generation]() {
+            if (generation != m_preloadGeneration.load()) return;
+            m_preloadedSubtitles = subtitles;
+            m_preloadedIndex = index;
+        }, Qt::QueuedConnection);
+    });
 }
 
 void SimpleMediaPlayer::play()
@@ -235,17 +533,34 @@ void SimpleMediaPlayer::stop()
 
 void SimpleMediaPlayer::reset()
 {
+    m_playlist.clear();
+    dropPreloaded();
+    m_nextButton->setEnabled(false);
     m_mediaPlayer->stop();
     m_mediaPlayer->setSource(QUrl());
     m_infoLabel->show();  // Показываем информационную метку
     m_timeLabel->setText("00:00 / 00:00");
     m_positionSlider->setRange(0, 0);
+    m_seekCoordinator->loadIndex(QString());
+    clearOverview();
     m_videoWidget->hide(); // Скрываем видео
 }
 
 void SimpleMediaPlayer::seek(qint64 position)
 {
-    m_mediaPlayer->setPosition(position);
+    m_videoWidget->prefetchSubtitles(position);
+    m_seekCoordinator->seek(position, SeekCoordinator::Exact);
+}
+
+void SimpleMediaPlayer::scrub(qint64 position)
+{
+    m_videoWidget->prefetchSubtitles(position);
+    m_seekCoordinator->seek(position, SeekCoordinator::Fast);
+}
+
+SubtitleScheduler::SyncStats SimpleMediaPlayer::subtitleSyncStats() const
+{
+    return m_subtitleScheduler->syncStats();
 }
 
 qint64 SimpleMediaPlayer::position() const
@@ -268,9 +583,7 @@ void SimpleMediaPlayer::onPositionChanged(qint64 position)
     if (!m_sliderPressed) {
         m_positionSlider->setValue(position);
     }
-    if (m_videoWidget) {
-        m_videoWidget->updateSubtitlePosition(position);
-    }
+    m_subtitleScheduler->syncPosition(position);
     qint64 duration = m_mediaPlayer->duration();
     QString timeText = QString("%1:%2 / %3:%4")
         .arg(position / 60000, 2, 10, QChar('0'))
@@ -284,11 +597,21 @@ void SimpleMediaPlayer::onPositionChanged(qint64 position)
 void SimpleMediaPlayer::onDurationChanged(qint64 duration)
 {
     m_positionSlider->setRange(0, duration);
+    const QUrl source = m_mediaPlayer->source();
+    if (duration > 0 && source.isLocalFile()) {
+        ensureOverviewBuilders();
+        m_waveformBuilder->start(source.toLocalFile(), duration);
+        m_thumbnailBuilder->start(source.toLocalFile(), duration);
+    }
     emit durationChanged(duration);
 }
 
 void SimpleMediaPlayer::onPlaybackStateChanged(QMediaPlayer::PlaybackState state)
 {
+    m_subtitleScheduler->setPlaying(state == QMediaPlayer::PlayingState);
+    if (state != QMediaPlayer::PlayingState) {
+        m_subtitleScheduler->seek(m_mediaPlayer->position());
+    }
     switch (state) {
         case QMediaPlayer::PlayingState:
             m_playButton->setIcon(style()->standardIcon(QStyle::SP_MediaPause));
@@ -310,12 +633,14 @@ void SimpleMediaPlayer::onSliderPressed()
 void SimpleMediaPlayer::onSliderReleased()
 {
     m_sliderPressed = false;
-    m_mediaPlayer->setPosition(m_positionSlider->value());
+    seek(m_positionSlider->value());
 }
 
 void SimpleMediaPlayer::onSliderMoved(int value)
 {
     if (m_sliderPressed) {
+        // Кадр под ползунком показываем сразу (по ключевым кадрам), точно встаём при отпускании
+        scrub(value);
         qint64 duration = m_mediaPlayer->duration();
         QString timeText = QString("%1:%2 / %3:%4")
             .arg(value / 60000, 2, 10, QChar('0'))
@@ -329,7 +654,7 @@ void SimpleMediaPlayer::onSliderMoved(int value)
 
 void SimpleMediaPlayer::dragEnterEvent(QDragEnterEvent *event)
 {
-    qDebug() << "SimpleMediaPlayer::dragEnterEvent called";
+    TRACE_INSTANT("ui", "SimpleMediaPlayer::dragEnterEvent");
     
     if (event->mimeData()->hasUrls()) {
         QList<QUrl> urls = event->mimeData()->urls();
@@ -349,7 +674,7 @@ void SimpleMediaPlayer::dragEnterEvent(QDragEnterEvent *event)
 
 void SimpleMediaPlayer::dragMoveEvent(QDragMoveEvent *event)
 {
-    qDebug() << "SimpleMediaPlayer::dragMoveEvent called";
+    TRACE_INSTANT("ui", "SimpleMediaPlayer::dragMoveEvent");
     
     if (event->mimeData()->hasUrls()) {
         QList<QUrl> urls = event->mimeData()->urls();
@@ -368,10 +693,14 @@ void SimpleMediaPlayer::dropEvent(QDropEvent *event)
         qDebug() << "SimpleMediaPlayer::dropEvent - found" << urls.size() << "URLs";
         
         if (!urls.isEmpty() && urls.first().isLocalFile()) {
-            QString filePath = urls.first().toLocalFile();
-            qDebug() << "SimpleMediaPlayer::dropEvent - opening file:" << filePath;
+            // Несколько файлов - плейлист в порядке перетаскивания
+            QStringList filePaths;
+            for (const QUrl &url : urls) {
+                if (url.isLocalFile()) filePaths.append(url.toLocalFile());
+            }
+            qDebug() << "SimpleMediaPlayer::dropEvent - opening files:" << filePaths;
             
-            if (openFile(filePath)) {
+            if (openPlaylist(filePaths)) {
                 qDebug() << "SimpleMediaPlayer::dropEvent - file opened successfully, starting playback";
                 play();
             } else {
@@ -400,24 +729,33 @@ void SimpleMediaPlayer::keyPressEvent(QKeyEvent *event)
         event->accept();
         break;
     case Qt::Key_Left:
-        // Seek back 10 seconds
+        // Seek back 10 seconds. Отсчёт от цели ещё не законченной перемотки,
+        // чтобы зажатая клавиша не топталась на месте; при автоповторе - быстрая перемотка
         if (m_mediaPlayer) {
-            qint64 currentPos = m_mediaPlayer->position();
-            qint64 newPos = qMax(0LL, currentPos - 10000);
-            m_mediaPlayer->setPosition(newPos);
+            const qint64 newPos = m_seekCoordinator->seekBy(-10000, event->isAutoRepeat() ? SeekCoordinator::Fast : SeekCoordinator::Exact);
+            m_videoWidget->prefetchSubtitles(newPos);
         }
         event->accept();
         break;
     case Qt::Key_Right:
         // Seek forward 10 seconds
         if (m_mediaPlayer) {
-            qint64 currentPos = m_mediaPlayer->position();
-            qint64 duration = m_mediaPlayer->duration();
-            qint64 newPos = qMin(duration, currentPos + 10000);
-            m_mediaPlayer->setPosition(newPos);
+            const qint64 newPos = m_seekCoordinator->seekBy(10000, event->isAutoRepeat() ? SeekCoordinator::Fast : SeekCoordinator::Exact);
+            m_videoWidget->prefetchSubtitles(newPos);
         }
         event->accept();
         break;
+    case Qt::Key_I:
+        // Оверлей статистики производительности
+        toggleStatsOverlay();
+        event->accept();
+        break;
+    case Qt::Key_Comma:
+    case Qt::Key_Period:
+        // Покадровый шаг назад/вперёд (с паузой)
+        m_seekCoordinator->stepFrame(event->key() == Qt::Key_Period ? 1 : -1);
+        event->accept();
+        break;
     case Qt::Key_Up:
         // Increase volume
         if (m_volumeSlider) {
@@ -553,16 +891,28 @@ void SimpleMediaPlayer::createSubtitles()
     QStringList ffmpegArgs;
     ffmpegArgs << "-i" << videoPath << "-vn" << "-acodec" << "pcm_s16le" << "-ar" << "16000" << "-ac" << "1" << tempAudioPath << "-y";
     
+    TRACE_ASYNC_BEGIN("process", "ffmpeg extract audio", 0);
     ffmpegProcess->start("ffmpeg", ffmpegArgs);
     
-    if (!ffmpegProcess->waitForStarted()) {
+    // Ожидания ниже блокируют цикл событий - размечены для сторожа зависаний
+    bool ffmpegStarted = false;
+    bool ffmpegFinished = false;
+    {
+        StallWatchdog::Scope stallScope("createSubtitles: ffmpeg waitForFinished");
+        ffmpegStarted = ffmpegProcess->waitForStarted();
+        // Ждем завершения извлечения аудио, 30 секунд таймаут
+        ffmpegFinished = ffmpegStarted && ffmpegProcess->waitForFinished(30000);
+    }
+    // Интервал закрывается здесь, до ранних выходов по ошибке: иначе в трассе
+    // остался бы незакрытым
+    TRACE_ASYNC_END("process", "ffmpeg extract audio", 0);
+    if (!ffmpegStarted) {
         QMessageBox::critical(this, "Ошибка", "Не удалось запустить ffmpeg для извлечения аудио.");
         ffmpegProcess->deleteLater();
         return;
     }
     
-    // Ждем завершения извлечения аудио
-    if (!ffmpegProcess->waitForFinished(30000)) { // 30 секунд таймаут
+    if (!ffmpegFinished) {
         QMessageBox::critical(this, "Ошибка", "Таймаут при извлечении аудио.");
         ffmpegProcess->deleteLater();
         return;
@@ -595,17 +945,21 @@ void SimpleMediaPlayer::createSubtitles()
     connect(whisperProcess, &QProcess::readyReadStandardOutput, [whisperProcess, &srtData]() {
         QByteArray output = whisperProcess->readAllStandardOutput();
         srtData.append(output);
-        qDebug() << "Whisper stdout:" << QString::fromUtf8(output);
+        TRACE_COUNTER("process", "whisper stdout bytes", srtData.size());
     });
     
     connect(whisperProcess, &QProcess::readyReadStandardError, [whisperProcess]() {
-        QString error = QString::fromUtf8(whisperProcess->readAllStandardError());
-        qDebug() << "Whisper stderr:" << error;
+        // Прогресс whisper печатает в stderr; сам текст нужен только при ошибке
+        const QByteArray error = whisperProcess->readAllStandardError();
+        TRACE_COUNTER("process", "whisper stderr bytes", error.size());
     });
     
+    QElapsedTimer whisperClock;
     connect(whisperProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-        [this, &progress, whisperProcess, tempAudioPath, &srtData](int exitCode, QProcess::ExitStatus) {
+        [this, &progress, whisperProcess, tempAudioPath, subtitlesSrtPath, &srtData, &whisperClock](int exitCode, QProcess::ExitStatus) {
             progress.setValue(100);
+            TRACE_ASYNC_END("process", "whisper", 0);
+            if (exitCode == 0) m_perfStats->transcribed(m_mediaPlayer->duration(), whisperClock.elapsed());
             qDebug() << "Whisper process finished with exit code:" << exitCode;
             
             // Удаляем временные файлы
@@ -618,9 +972,11 @@ void SimpleMediaPlayer::createSubtitles()
             
             if (exitCode == 0 && !srtData.isEmpty()) {
                 // Парсим субтитры и отображаем их
-                QMap<qint64, QString> subtitles = parseSrtData(srtData);
+                QList<SubtitleCue> subtitles = parseSrtData(srtData);
                 if (!subtitles.isEmpty()) {
                     displaySubtitles(subtitles);
+                    // whisper дописывает .srt к пути из -of
+                    writeSubtitleIndex(subtitlesSrtPath + ".srt", m_subtitleScheduler->track());
                 } else {
                     QMessageBox::warning(this, "Предупреждение", "Субтитры созданы, но не удалось их распарсить.");
                 }
@@ -645,6 +1001,7 @@ void SimpleMediaPlayer::createSubtitles()
     
     // Подключаем отмену
     connect(&progress, &QProgressDialog::canceled, [whisperProcess, ffmpegProcess, tempAudioPath, &progress]() {
+        StallWatchdog::Scope cancelScope("createSubtitles: cancel waitForFinished");
         if (whisperProcess && whisperProcess->state() == QProcess::Running) {
             whisperProcess->terminate();
             whisperProcess->waitForFinished(5000);
@@ -681,15 +1038,19 @@ void SimpleMediaPlayer::createSubtitles()
     progress.setLabelText("Обработка аудио Whisper для субтитров поверх видео...");
     progress.setValue(50);
     
-    qDebug() << "Starting Whisper for overlay subtitles with args:" << args;
-    qDebug() << "Whisper path:" << whisperPath;
-    qDebug() << "Model path:" << modelPath;
-    qDebug() << "Audio path:" << tempAudioPath;
-    qDebug() << "Output path:" << subtitlesSrtPath;
+    qDebug() << "Starting Whisper:" << whisperPath << args;
     
+    TRACE_ASYNC_BEGIN("process", "whisper", 0);
+    m_perfStats->resetTranscription();
+    m_perfStats->setContext(videoPath, selectedModel);
+    whisperClock.start();
     whisperProcess->start(whisperPath, args);
+    m_perfStats->watchProcess(whisperProcess);
     
+    StallWatchdog::Scope whisperScope("createSubtitles: whisper waitForFinished");
     if (!whisperProcess->waitForStarted()) {
+        // finished не придёт - интервал закрываем сами
+        TRACE_ASYNC_END("process", "whisper", 0);
         progress.setValue(100);
         progress.close();
         QMessageBox::critical(this, "Ошибка", 
@@ -704,6 +1065,8 @@ void SimpleMediaPlayer::createSubtitles()
         whisperProcess->terminate();
         whisperProcess->waitForFinished(10000);
         whisperProcess->kill();
+        // Дожидаемся finished: он закрывает интервал whisper в трассе
+        whisperProcess->waitForFinished(1000);
         QMessageBox::critical(this, "Ошибка", "Whisper не завершился в течение 5 минут. Процесс прерван.");
         return;
     }
@@ -714,7 +1077,6 @@ void SimpleMediaPlayer::createSubtitles()
 
 void SimpleMediaPlayer::createSubtitlesOverlay()
 {
-    qDebug() << "createSubtitlesOverlay: starting...";
     if (m_mediaPlayer->source().isEmpty()) {
         QMessageBox::warning(this, "Ошибка", "Сначала откройте видео файл");
         return;
@@ -724,7 +1086,6 @@ void SimpleMediaPlayer::createSubtitlesOverlay()
         QMessageBox::warning(this, "Ошибка", "Не удалось получить путь к видео файлу");
         return;
     }
-    qDebug() << "createSubtitlesOverlay: video path:" << videoPath;
     QSettings settings;
     QString selectedModel = settings.value("whisper/selected_model", "base").toString();
     QString projectDir = QDir::currentPath();
@@ -733,146 +1094,223 @@ void SimpleMediaPlayer::createSubtitlesOverlay()
         QMessageBox::warning(this, "Ошибка", QString("Модель '%1' не найдена по пути: %2\nСначала скачайте её в настройках Whisper.").arg(selectedModel).arg(modelPath));
         return;
     }
-    qDebug() << "createSubtitlesOverlay: model path:" << modelPath;
-    QString tempAudioPath = QDir::tempPath() + "/" + QFileInfo(videoPath).baseName() + "_temp.wav";
-    qDebug() << "createSubtitlesOverlay: extracting audio to:" << tempAudioPath;
-    // Извлекаем аудио
-    QProcess ffmpegProcess;
-    QStringList ffmpegArgs;
-    ffmpegArgs << "-i" << videoPath << "-vn" << "-acodec" << "pcm_s16le" << "-ar" << "16000" << "-ac" << "1" << tempAudioPath << "-y";
-    ffmpegProcess.start("ffmpeg", ffmpegArgs);
-    if (!ffmpegProcess.waitForStarted() || !ffmpegProcess.waitForFinished(30000) || ffmpegProcess.exitCode() != 0) {
-        QMessageBox::critical(this, "Ошибка", "Не удалось извлечь аудио");
+    if (!m_transcription) {
+        m_transcription = new TranscriptionPipeline(this);
+        // Чанки дописываются в живую дорожку в фоновом потоке; вид подхватывает
+        // опубликованные снимки без копирования накопленных реплик
+        connect(m_transcription, &TranscriptionPipeline::trackUpdated, this, &SimpleMediaPlayer::adoptLiveTrack);
+        connect(m_transcription, &TranscriptionPipeline::processStarted, m_perfStats, &PerfStats::watchProcess);
+        connect(m_transcription, &TranscriptionPipeline::chunkFinished, this,
+                [this](const TranscriptionPipeline::ChunkStats &chunk) {
+                    if (chunk.whisperMs > 0) m_perfStats->transcribed(chunk.audioMs, chunk.whisperMs);
+                });
+        connect(m_transcription, &TranscriptionPipeline::finished, this, [this](bool ok, const QString &error) {
+            const LiveSubtitleTrackPtr liveTrack = m_transcription->track();
+            if (liveTrack != m_liveTrack) return;
+            const int count = liveTrack->snapshot()->size();
+            qDebug() << "createSubtitlesOverlay: final subtitles count:" << count;
+            if (count > 0) {
+                adoptLiveTrack(liveTrack);
+            } else if (!ok) {
+                QMessageBox::critical(this, "Ошибка", error);
+            } else {
+                QMessageBox::warning(this, "Предупреждение", "Не удалось создать субтитры.");
+            }
+        });
+    }
+    TranscriptionPipeline::Config config;
+    config.whisperPath = QDir::currentPath() + "/../tools/whisper/whisper";
+    config.modelPath = modelPath;
+    // Несколько процессов whisper ускоряют длинные файлы ценой памяти на каждую копию модели
+    config.concurrency = qBound(1, settings.value("whisper/concurrency", 1).toInt(), QThread::idealThreadCount());
+    m_transcription->setConfig(config);
+
+    if (m_videoWidget) m_videoWidget->clearSubtitles();
+    m_subtitleScheduler->setTrack(nullptr);
+    m_perfStats->resetTranscription();
+    m_perfStats->setContext(videoPath, selectedModel);
+    m_transcription->start(videoPath);
+    m_liveTrack = m_transcription->track();
+    ++m_subtitleLoadGeneration;
+}
+
+void SimpleMediaPlayer::exportSubtitles()
+{
+    SubtitleTrackPtr track = m_videoWidget->subtitleTrack();
+    if (!track || track->isEmpty()) {
+        QMessageBox::warning(this, "Ошибка", "Нет субтитров для экспорта. Сначала создайте или загрузите субтитры.");
         return;
     }
-    qDebug() << "createSubtitlesOverlay: audio extraction completed";
-    // Получаем длительность
-    QProcess durationProcess;
-    durationProcess.start("ffprobe", QStringList{"-i", tempAudioPath, "-show_entries", "format=duration", "-v", "quiet", "-of", "csv=p=0"});
-    durationProcess.waitForFinished(5000);
-    double totalDuration = durationProcess.readAllStandardOutput().trimmed().toDouble();
-    if (totalDuration <= 0) {
-        QMessageBox::critical(this, "Ошибка", "Не удалось получить длительность аудио");
+    
+    QString defaultPath;
+    const QString videoPath = m_mediaPlayer->source().toLocalFile();
+    if (!videoPath.isEmpty()) {
+        QFileInfo videoFile(videoPath);
+        defaultPath = videoFile.absolutePath() + "/" + videoFile.completeBaseName() + ".srt";
+    }
+    QString selectedFilter;
+    QString outputPath = QFileDialog::getSaveFileName(
+        this,
+        "Экспорт субтитров",
+        defaultPath,
+        "SubRip (*.srt);;WebVTT (*.vtt);;Advanced SubStation Alpha (*.ass)",
+        &selectedFilter
+    );
+    if (outputPath.isEmpty()) {
         return;
     }
-    qDebug() << "createSubtitlesOverlay: total duration:" << totalDuration << "seconds";
-    // Чанки
-    const int chunkDuration = 15;
-    const int overlapDuration = 2;
-    const int totalChunks = static_cast<int>(std::ceil(totalDuration / (chunkDuration - overlapDuration)));
-    qDebug() << "createSubtitlesOverlay: will process" << totalChunks << "chunks";
-    if (m_videoWidget) m_videoWidget->clearSubtitles();
-    QMap<qint64, QString> *allSubtitles = new QMap<qint64, QString>();
-    QString whisperPath = QDir::currentPath() + "/../tools/whisper/whisper";
-    qDebug() << "createSubtitlesOverlay: whisper path:" << whisperPath;
-    // Последовательная обработка чанков
-    auto processNextChunk = [=](int chunkIndex, auto &&processNextChunkRef) mutable -> void {
-        qDebug() << "createSubtitlesOverlay: processing chunk" << chunkIndex << "of" << totalChunks;
-        if (chunkIndex >= totalChunks) {
-            // Всё готово
-            qDebug() << "createSubtitlesOverlay: all chunks processed, finalizing...";
-            if (QFile::exists(tempAudioPath)) QFile::remove(tempAudioPath);
-            if (!allSubtitles->isEmpty()) {
-                qDebug() << "createSubtitlesOverlay: setting final subtitles, count:" << allSubtitles->size();
-                m_videoWidget->setSubtitles(*allSubtitles);
-            } else {
-                QMessageBox::warning(this, "Предупреждение", "Не удалось создать субтитры.");
-            }
-            delete allSubtitles;
-            return;
+    // Без расширения формат берём из выбранного фильтра
+    if (QFileInfo(outputPath).suffix().isEmpty()) {
+        if (selectedFilter.startsWith("WebVTT")) outputPath += ".vtt";
+        else if (selectedFilter.startsWith("Advanced")) outputPath += ".ass";
+        else outputPath += ".srt";
+    }
+    
+    const SubtitleWriter::Format format = SubtitleWriter::formatForPath(outputPath);
+    QString error;
+    if (!SubtitleWriter::writeFile(outputPath, SubtitleWriter::serialize(*track, format), &error)) {
+        QMessageBox::critical(this, "Ошибка", QString("Не удалось сохранить субтитры:\n%1").arg(error));
+        return;
+    }
+    if (format == SubtitleWriter::Format::Srt) {
+        writeSubtitleIndex(outputPath, track);
+    }
+    qDebug() << "SimpleMediaPlayer: subtitles exported to" << outputPath;
+}
+
+void SimpleMediaPlayer::writeSubtitleIndex(const QString &sourcePath, SubtitleTrackPtr track)
+{
+    if (!track || track->isEmpty()) return;
+    // Бинарный индекс рядом с SRT: следующее открытие отобразит его без разбора
+    QThreadPool *worker = m_subtitleWorker;
+    QtConcurrent::run(worker, [sourcePath, track]() {
+        QString error;
+        if (QFile::exists(sourcePath) && !SubtitleIndex::write(*track, sourcePath, &error)) {
+            qDebug() << "SimpleMediaPlayer: subtitle index not written for" << sourcePath << error;
         }
-        double startTime = chunkIndex * (chunkDuration - overlapDuration);
-        double endTime = std::min(startTime + chunkDuration, totalDuration);
-        QString chunkTempPath = QDir::tempPath() + "/" + QFileInfo(videoPath).baseName() + QString("_chunk_%1").arg(chunkIndex);
-        qDebug() << "createSubtitlesOverlay: chunk" << chunkIndex << "time range:" << startTime << "-" << endTime;
-        QProcess *chunkFfmpeg = new QProcess(this);
-        QStringList chunkArgs;
-        chunkArgs << "-i" << tempAudioPath << "-ss" << QString::number(startTime) << "-t" << QString::number(endTime - startTime)
-                  << "-acodec" << "pcm_s16le" << "-ar" << "16000" << "-ac" << "1" << chunkTempPath + ".wav" << "-y";
-        connect(chunkFfmpeg, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, [=](int, QProcess::ExitStatus) mutable {
-            chunkFfmpeg->deleteLater();
-            if (!QFile::exists(chunkTempPath + ".wav")) {
-                qDebug() << "createSubtitlesOverlay: chunk" << chunkIndex << "ffmpeg failed, skipping to next";
-                processNextChunkRef(chunkIndex + 1, processNextChunkRef);
-                return;
-            }
-            qDebug() << "createSubtitlesOverlay: chunk" << chunkIndex << "ffmpeg completed, starting whisper";
-            QProcess *chunkWhisper = new QProcess(this);
-            QStringList whisperArgs;
-            whisperArgs << "-m" << modelPath << "-f" << chunkTempPath + ".wav" << "-osrt" << "-of" << chunkTempPath << "-l" << "ru" << "--max-len" << "300" << "--split-on-word" << "--word-thold" << "0.01";
-            connect(chunkWhisper, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, [=](int, QProcess::ExitStatus) mutable {
-                QString srtFilePath = chunkTempPath + ".srt";
-                if (QFile::exists(srtFilePath)) {
-                    qDebug() << "createSubtitlesOverlay: chunk" << chunkIndex << "whisper completed, parsing SRT";
-                    QFile srtFile(srtFilePath);
-                    if (srtFile.open(QIODevice::ReadOnly)) {
-                        QByteArray srtData = srtFile.readAll();
-                        srtFile.close();
-                        QMap<qint64, QString> chunkSubtitles = parseSrtData(srtData);
-                        qint64 timeOffset = static_cast<qint64>(startTime * 1000);
-                        for (auto it = chunkSubtitles.begin(); it != chunkSubtitles.end(); ++it) {
-                            qint64 adjustedTime = it.key() + timeOffset;
-                            (*allSubtitles)[adjustedTime] = it.value();
-                        }
-                        qDebug() << "createSubtitlesOverlay: chunk" << chunkIndex << "added" << chunkSubtitles.size() << "subtitles, total now:" << allSubtitles->size();
-                        // Обновляем overlay после каждого чанка
-                        if (m_videoWidget) {
-                            m_videoWidget->setSubtitles(*allSubtitles);
-                            qDebug() << "createSubtitlesOverlay: chunk" << chunkIndex << "overlay updated";
-                        }
-                    }
-                } else {
-                    qDebug() << "createSubtitlesOverlay: chunk" << chunkIndex << "whisper failed, no SRT file created";
-                }
-                QFile::remove(chunkTempPath + ".wav");
-                QFile::remove(srtFilePath);
-                chunkWhisper->deleteLater();
-                // Следующий чанк
-                QTimer::singleShot(0, this, [=]() mutable { processNextChunkRef(chunkIndex + 1, processNextChunkRef); });
-            });
-            chunkWhisper->start(whisperPath, whisperArgs);
-        });
-        chunkFfmpeg->start("ffmpeg", chunkArgs);
-    };
-    // Запуск первого чанка
-    qDebug() << "createSubtitlesOverlay: starting first chunk";
-    processNextChunk(0, processNextChunk);
+    });
 }
 
-// Методы для работы с субтитрами
-QMap<qint64, QString> SimpleMediaPlayer::parseSrtData(const QByteArray &srtData)
-{
-    QMap<qint64, QString> subtitles;
-    QString srtText = QString::fromUtf8(srtData);
-    // Регулярное выражение для парсинга SRT
-    QRegularExpression regex(
-        "(\\d+)\\s+" // номер
-        "(\\d{2}):(\\d{2}):(\\d{2}),(\\d{3})\\s+-->\\s+" // время начала
-        "(\\d{2}):(\\d{2}):(\\d{2}),(\\d{3})\\s+" // время конца
-        "([\\s\\S]*?)(?=\\n\\d+\\n|$)" // текст (группа 10)
+void SimpleMediaPlayer::exportBurnedSubtitles()
+{
+    if (m_mediaPlayer->source().isEmpty() || m_mediaPlayer->source().toLocalFile().isEmpty()) {
+        QMessageBox::warning(this, "Ошибка", "Сначала откройте видео файл");
+        return;
+    }
+    SubtitleTrackPtr track = m_videoWidget->subtitleTrack();
+    if (!track || track->isEmpty()) {
+        QMessageBox::warning(this, "Ошибка", "Нет субтитров для экспорта. Сначала создайте или загрузите субтитры.");
+        return;
+    }
+    if (m_burnExporter && m_burnExporter->isRunning()) {
+        QMessageBox::information(this, "Экспорт", "Экспорт уже выполняется");
+        return;
+    }
+    
+    QString videoPath = m_mediaPlayer->source().toLocalFile();
+    QFileInfo videoFile(videoPath);
+    QString outputPath = QFileDialog::getSaveFileName(
+        this,
+        "Сохранить видео с субтитрами как",
+        videoFile.absolutePath() + "/" + videoFile.completeBaseName() + "_subs.mp4",
+        "Видео (*.mp4 *.mkv *.mov);;Все файлы (*)"
     );
-    QRegularExpressionMatchIterator it = regex.globalMatch(srtText);
-    while (it.hasNext()) {
-        QRegularExpressionMatch match = it.next();
-        // Извлекаем время начала
-        int hours = match.captured(2).toInt();
-        int minutes = match.captured(3).toInt();
-        int seconds = match.captured(4).toInt();
-        int milliseconds = match.captured(5).toInt();
-        qint64 startTime = (hours * 3600 + minutes * 60 + seconds) * 1000 + milliseconds;
-        // Извлекаем текст
-        QString text = match.captured(10).trimmed();
-        text = text.replace(QRegularExpression("\\n"), " ");
-        subtitles[startTime] = text;
+    if (outputPath.isEmpty()) {
+        return;
     }
-    return subtitles;
+    
+    if (!m_burnExporter) {
+        m_burnExporter = new SubtitleBurnExporter(this);
+    }
+    // Диалог не модальный: плеер остаётся доступен, пока сегменты кодируются
+    QProgressDialog *progress = new QProgressDialog("Экспорт видео с субтитрами...", "Отмена", 0, 100, this);
+    progress->setAttribute(Qt::WA_DeleteOnClose);
+    progress->setMinimumDuration(0);
+    progress->setValue(0);
+    connect(m_burnExporter, &SubtitleBurnExporter::progress, progress, [progress](int percent, const QString &stage) {
+        progress->setLabelText(stage);
+        progress->setValue(percent);
+    });
+    connect(progress, &QProgressDialog::canceled, m_burnExporter, &SubtitleBurnExporter::cancel);
+    connect(m_burnExporter, &SubtitleBurnExporter::finished, progress, [this, progress, outputPath](bool ok, const QString &error) {
+        m_burnExporter->disconnect(progress);
+        progress->close();
+        if (ok) {
+            QMessageBox::information(this, "Экспорт", "Видео сохранено: " + outputPath);
+        } else if (!error.isEmpty()) {
+            QMessageBox::warning(this, "Экспорт", error);
+        }
+    });
+    m_burnExporter->start(videoPath, outputPath, track);
+    progress->show();
+}
+
+// Методы для работы с субтитрами
+QList<SubtitleCue> SimpleMediaPlayer::parseSrtData(const QByteArray &srtData)
+{
+    return SrtParser::parse(srtData);
+}
+
+void SimpleMediaPlayer::displaySubtitles(const QList<SubtitleCue> &subtitles)
+{
+    // Готовые субтитры заменяют живую транскрипцию и автозагрузку
+    m_liveTrack.reset();
+    ++m_subtitleLoadGeneration;
+    setSubtitleTrack(std::make_shared<const SubtitleTrack>(SubtitleTrack::fromCues(subtitles)));
 }
 
-void SimpleMediaPlayer::displaySubtitles(const QMap<qint64, QString> &subtitles)
+void SimpleMediaPlayer::setSubtitleTrack(SubtitleTrackPtr track, bool extendsPrevious)
 {
+    // Вид, планировщик и поиск держат одну и ту же неизменяемую дорожку
     if (m_videoWidget) {
-        m_videoWidget->setSubtitles(subtitles);
+        m_videoWidget->setSubtitleTrack(track);
+        // Новая дорожка сбросила упреждающую отрисовку - заново вокруг того места,
+        // где идёт воспроизведение, а не с начала файла
+        if (track) m_videoWidget->prefetchSubtitles(m_subtitleScheduler->estimatedPosition());
     }
+    if (m_searchPanel) m_searchPanel->setTrack(track, extendsPrevious);
+    // Последним: планировщик пришлёт виду текущую реплику уже из новой дорожки
+    m_subtitleScheduler->setTrack(std::move(track));
+}
+
+void SimpleMediaPlayer::loadSiblingSubtitles(const QString &videoPath)
+{
+    const quint64 generation = ++m_subtitleLoadGeneration;
+    m_liveTrack.reset();
+    setSubtitleTrack(nullptr);
+    // И поиск файлов, и разбор идут в фоне: каталог может быть на медленном
+    // сетевом диске, а воспроизведение не должно его ждать
+    QThreadPool *worker = m_subtitleWorker;
+    QtConcurrent::run(worker, [this, videoPath, generation]() {
+        for (const QString &path : SubtitleLoader::siblingCandidates(videoPath)) {
+            // Уже открыли другое видео - не тратим время на устаревший разбор
+            if (generation != m_subtitleLoadGeneration.load()) return;
+            QString error;
+            SubtitleTrackPtr track = SubtitleLoader::loadFile(path, &error);
+            if (!track) {
+                qDebug() << "SimpleMediaPlayer: skipping subtitles" << path << error;
+                continue;
+            }
+            QMetaObject::invokeMethod(this, [this, track, path, generation]() {
+                // За время разбора могли открыть другое видео или загрузить другие субтитры
+                if (generation != m_subtitleLoadGeneration.load()) return;
+                qDebug() << "SimpleMediaPlayer: loaded subtitles" << path << "cues:" << track->size();
+                setSubtitleTrack(track);
+            }, Qt::QueuedConnection);
+            return;
+        }
+    });
+}
+
+void SimpleMediaPlayer::adoptLiveTrack(const LiveSubtitleTrackPtr &liveTrack)
+{
+    // Уведомления от прежних запусков и повторные о том же снимке пропускаем
+    if (liveTrack != m_liveTrack) return;
+    SubtitleTrackPtr snapshot = liveTrack->snapshot();
+    SubtitleTrackPtr previous = m_subtitleScheduler->track();
+    if (snapshot == previous) return;
+    // Прежний снимок той же живой дорожки - её префикс, поиск только дописывается
+    setSubtitleTrack(std::move(snapshot), previous != nullptr);
 }
 
 void SimpleMediaPlayer::toggleSubtitlesVisibility(bool visible)
@@ -892,6 +1330,7 @@ void SimpleMediaPlayer::setPlaybackRate(double rate) {
     if (m_mediaPlayer) {
         m_mediaPlayer->setPlaybackRate(rate);
     }
+    m_subtitleScheduler->setPlaybackRate(rate);
     // Обновляем тултип и иконку
     int idx = m_speedComboBox->findData(rate);
     if (idx >= 0) {
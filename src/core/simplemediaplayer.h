@@ -19,9 +19,25 @@
 #include <QMap>
 #include <QCheckBox>
 #include <QComboBox>
+#include <atomic>
 #include "ui/videowidget.h"
+#include "core/srtparser.h"
+#include "core/subtitletrack.h"
+#include "core/livesubtitletrack.h"
+#include "core/subtitlescheduler.h"
+#include "core/playlist.h"
+#include "core/packetindex.h"
 
 class WhisperModelSettingsDialog;
+class SubtitleBurnExporter;
+class QThreadPool;
+class SubtitleSearchPanel;
+class SeekSlider;
+class WaveformBuilder;
+class ThumbnailBuilder;
+class SeekCoordinator;
+class PerfStats;
+class TranscriptionPipeline;
 
 class SimpleMediaPlayer : public QWidget
 {
@@ -32,6 +48,9 @@ public:
     ~SimpleMediaPlayer();
 
     bool openFile(const QString &filePath);
+    // Несколько файлов подряд; следующий готовится, пока играет текущий
+    bool openPlaylist(const QStringList &filePaths);
+    void playNext();
     void play();
     void pause();
     void stop();
@@ -42,7 +61,11 @@ public:
     bool isPlaying() const;
     void createSubtitles();
     void createSubtitlesOverlay();
+    void exportSubtitles();
+    void exportBurnedSubtitles();
     double playbackRate() const;
+    // Насколько точно субтитры попадают в кадры (см. SubtitleScheduler::SyncStats)
+    SubtitleScheduler::SyncStats subtitleSyncStats() const;
     void setPlaybackRate(double rate);
 
 signals:
@@ -59,6 +82,7 @@ private slots:
     void onSliderReleased();
     void onSliderMoved(int value);
     void onPlaybackRateChanged(int index);
+    void onMediaStatusChanged(QMediaPlayer::MediaStatus status);
 
 protected:
     void dragEnterEvent(QDragEnterEvent *event) override;
@@ -66,22 +90,27 @@ protected:
     void dropEvent(QDropEvent *event) override;
     void keyPressEvent(QKeyEvent *event) override;
     void resizeEvent(QResizeEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
 
 private:
     QMediaPlayer *m_mediaPlayer;
     VideoGraphicsView *m_videoWidget;
-    QAudioOutput *m_audioOutput;
+    QAudioOutput *m_audioOutput = nullptr;
     
     // UI elements
     QPushButton *m_playButton;
     QPushButton *m_stopButton;
     QPushButton *m_openButton;
     QPushButton *m_resetButton;
+    QPushButton *m_nextButton;
     QPushButton *m_settingsButton;
     QPushButton *m_subtitlesButton;
     QPushButton *m_subtitlesOverlayButton;
+    QPushButton *m_exportSubtitlesButton;
+    QPushButton *m_burnSubtitlesButton;
+    QPushButton *m_searchButton;
     QCheckBox *m_showSubtitlesCheckBox;
-    QSlider *m_positionSlider;
+    SeekSlider *m_positionSlider;
     QSlider *m_volumeSlider;
     QLabel *m_timeLabel;
     QLabel *m_infoLabel;
@@ -91,11 +120,57 @@ private:
     bool m_sliderPressed;
     qint64 m_lastPosition;
     
+    // Отложенная инициализация: всё, без чего окно может появиться на экране
+    void ensureOutputs();
+    void ensureSearchPanel();
+    void ensureOverviewBuilders();
+    void clearOverview();
+    
+    // Оверлей статистики (клавиша I) и телеметрия
+    void toggleStatsOverlay();
+    void updatePerfStatsActive();
+    
+    // Плейлист: переключение на заранее открытый плеер
+    void connectPlayer(QMediaPlayer *player);
+    void loadItem(const QString &filePath);
+    void preloadNext();
+    void dropPreloaded();
+    void switchToPreloaded();
+    
+    // Быстрая перемотка к ближайшему ключевому кадру - для перетаскивания ползунка
+    void scrub(qint64 position);
+    
     // Методы для работы с субтитрами
-    QMap<qint64, QString> parseSrtData(const QByteArray &srtData);
-    void displaySubtitles(const QMap<qint64, QString> &subtitles);
+    QList<SubtitleCue> parseSrtData(const QByteArray &srtData);
+    void displaySubtitles(const QList<SubtitleCue> &subtitles);
+    void setSubtitleTrack(SubtitleTrackPtr track, bool extendsPrevious = false);
+    void adoptLiveTrack(const LiveSubtitleTrackPtr &liveTrack);
+    void loadSiblingSubtitles(const QString &videoPath);
+    void writeSubtitleIndex(const QString &sourcePath, SubtitleTrackPtr track);
     void toggleSubtitlesVisibility(bool show);
     
+    SubtitleBurnExporter *m_burnExporter = nullptr;
+    SubtitleScheduler *m_subtitleScheduler;
+    SubtitleSearchPanel *m_searchPanel = nullptr;
+    WaveformBuilder *m_waveformBuilder = nullptr;
+    ThumbnailBuilder *m_thumbnailBuilder = nullptr;
+    SeekCoordinator *m_seekCoordinator;
+    PerfStats *m_perfStats;
+    TranscriptionPipeline *m_transcription = nullptr;
+    QThreadPool *m_subtitleWorker;
+    LiveSubtitleTrackPtr m_liveTrack;
+    std::atomic<quint64> m_subtitleLoadGeneration{0}; // читается и из фонового потока
+    
+    // --- Плейлист ---
+    // Предзагружается ровно один следующий файл: плеер без выходов (открыт
+    // только демуксер, кадры не декодируются), его субтитры и индекс пакетов из кэша
+    Playlist m_playlist;
+    QMediaPlayer *m_preloadPlayer = nullptr;
+    QString m_preloadedPath;
+    SubtitleTrackPtr m_preloadedSubtitles;
+    PacketIndexPtr m_preloadedIndex;
+    std::atomic<quint64> m_preloadGeneration{0};
+    
     // --- Элементы управления скоростью ---
     double m_playbackRate = 1.0;
 };
@@ -0,0 +1,293 @@
+#include "core/srtparser.h"
+#include "core/trace.h"
+#include <cstring>
+
+namespace {
+
+// cp1251 -> Unicode для байтов 0x80..0xBF (0xC0..0xFF - подряд А..я)
+const char16_t kCp1251High[64] = {
+    0x0402, 0x0403, 0x201A, 0x0453, 0x201E, 0x2026, 0x2020, 0x2021,
+    0x20AC, 0x2030, 0x0409, 0x2039, 0x040A, 0x040C, 0x040B, 0x040F,
+    0x0452, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+    0xFFFD, 0x2122, 0x0459, 0x203A, 0x045A, 0x045C, 0x045B, 0x045F,
+    0x00A0, 0x040E, 0x045E, 0x0408, 0x00A4, 0x0490, 0x00A6, 0x00A7,
+    0x0401, 0x00A9, 0x0404, 0x00AB, 0x00AC, 0x00AD, 0x00AE, 0x0407,
+    0x00B0, 0x00B1, 0x0406, 0x0456, 0x0491, 0x00B5, 0x00B6, 0x00B7,
+    0x0451, 0x2116, 0x0454, 0x00BB, 0x0458, 0x0405, 0x0455, 0x0457
+};
+
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+// Читает группу цифр, возвращает количество прочитанных
+inline int readNumber(const char *&p, const char *e, qint64 &value)
+{
+    int digits = 0;
+    value = 0;
+    while (p < e && isDigit(*p)) {
+        value = value * 10 + (*p - '0');
+        ++p;
+        ++digits;
+    }
+    return digits;
+}
+
+// "HH:MM:SS,mmm" (SRT) или "MM:SS.mmm" / "HH:MM:SS.mmm" (WebVTT)
+bool readTimestamp(const char *&p, const char *e, qint64 &ms)
+{
+    while (p < e && isSpace(*p)) ++p;
+    qint64 parts[3] = {0, 0, 0};
+    int count = 0;
+    while (count < 3) {
+        const int digits = readNumber(p, e, parts[count]);
+        if (digits == 0) return false;
+        ++count;
+        if (p < e && *p == ':') {
+            ++p;
+            continue;
+        }
+        break;
+    }
+    if (count < 2) return false;
+    const qint64 hours = count == 3 ? parts[0] : 0;
+    const qint64 minutes = parts[count - 2];
+    const qint64 seconds = parts[count - 1];
+
+    qint64 millis = 0;
+    if (p < e && (*p == ',' || *p == '.')) {
+        ++p;
+        qint64 fraction = 0;
+        const int digits = readNumber(p, e, fraction);
+        if (digits == 0) return false;
+        // "5" -> 500 мс, "05" -> 50 мс, лишние знаки отбрасываются
+        if (digits == 1) millis = fraction * 100;
+        else if (digits == 2) millis = fraction * 10;
+        else {
+            millis = fraction;
+            for (int i = 3; i < digits; ++i) millis /= 10;
+        }
+    }
+    ms = ((hours * 60 + minutes) * 60 + seconds) * 1000 + millis;
+    return true;
+}
+
+bool parseTimingLine(const char *p, const char *e, qint64 &start, qint64 &end)
+{
+    if (!readTimestamp(p, e, start)) return false;
+    while (p < e && isSpace(*p)) ++p;
+    if (e - p < 3 || p[0] != '-' || p[1] != '-' || p[2] != '>') return false;
+    p += 3;
+    // Остаток строки (позиционирование WebVTT/SRT) игнорируется
+    return readTimestamp(p, e, end);
+}
+
+bool isIndexLine(const char *p, const char *e)
+{
+    if (p == e) return false;
+    for (; p < e; ++p) {
+        if (!isDigit(*p)) return false;
+    }
+    return true;
+}
+
+struct Line {
+    const char *begin;
+    const char *end;  // без \r и хвостовых пробелов
+    const char *next; // начало следующей строки
+};
+
+inline Line readLine(const char *p, const char *e)
+{
+    const char *nl = static_cast<const char *>(std::memchr(p, '\n', e - p));
+    Line line;
+    line.next = nl ? nl + 1 : e;
+    line.end = nl ? nl : e;
+    while (line.end > p && isSpace(line.end[-1])) --line.end;
+    while (p < line.end && isSpace(*p)) ++p;
+    line.begin = p;
+    return line;
+}
+
+// Копирует текст реплики, заменяя переводы строк пробелами
+template <typename Out, typename Emit>
+void forEachTextLine(const char *p, const char *e, Out &out, Emit emit)
+{
+    bool first = true;
+    while (p < e) {
+        const Line line = readLine(p, e);
+        if (line.begin != line.end) {
+            if (!first) emit(out, " ", 1);
+            emit(out, line.begin, line.end - line.begin);
+            first = false;
+        }
+        p = line.next;
+    }
+}
+
+} // namespace
+
+namespace SrtParser {
+
+QVector<RawCue> scan(const char *data, qsizetype size)
+{
+    QVector<RawCue> cues;
+    const char *p = data;
+    const char *e = data + size;
+    if (size >= 3 && static_cast<unsigned char>(p[0]) == 0xEF
+        && static_cast<unsigned char>(p[1]) == 0xBB && static_cast<unsigned char>(p[2]) == 0xBF) {
+        p += 3;
+    }
+    // Грубая оценка: одна реплика на ~60 байт
+    cues.reserve(size / 64 + 1);
+
+    bool inCue = false;
+    RawCue cue = {0, 0, 0, 0};
+    const char *textBegin = nullptr;
+    const char *textEnd = nullptr;
+
+    auto finishCue = [&]() {
+        if (inCue && textBegin) {
+            cue.textOffset = textBegin - data;
+            cue.textLength = textEnd - textBegin;
+            if (cue.end < cue.start) cue.end = cue.start;
+            cues.append(cue);
+        }
+        inCue = false;
+        textBegin = textEnd = nullptr;
+    };
+
+    while (p < e) {
+        const Line line = readLine(p, e);
+        const bool blank = line.begin == line.end;
+        qint64 start = 0;
+        qint64 end = 0;
+        if (blank) {
+            finishCue();
+        } else if (parseTimingLine(line.begin, line.end, start, end)) {
+            // Таймкод без пустой строки перед ним тоже начинает новую реплику
+            finishCue();
+            inCue = true;
+            cue.start = start;
+            cue.end = end;
+        } else if (inCue) {
+            // Номер следующей реплики без пустой строки перед ним
+            if (isIndexLine(line.begin, line.end) && line.next < e) {
+                const Line following = readLine(line.next, e);
+                if (parseTimingLine(following.begin, following.end, start, end)) {
+                    finishCue();
+                    p = line.next;
+                    continue;
+                }
+            }
+            if (!textBegin) textBegin = line.begin;
+            textEnd = line.end;
+        }
+        // Вне реплики: номер, заголовок WEBVTT или мусор - пропускаем
+        p = line.next;
+    }
+    finishCue();
+    return cues;
+}
+
+bool isValidUtf8(const char *data, qsizetype size)
+{
+    const unsigned char *p = reinterpret_cast<const unsigned char *>(data);
+    const unsigned char *e = p + size;
+    while (p < e) {
+        // Быстрый путь для ASCII: по 8 байт за раз
+        while (e - p >= 8) {
+            quint64 word;
+            std::memcpy(&word, p, 8);
+            if (word & 0x8080808080808080ULL) break;
+            p += 8;
+        }
+        if (p >= e) break;
+        const unsigned char c = *p;
+        if (c < 0x80) {
+            ++p;
+            continue;
+        }
+        int extra;
+        quint32 codepoint;
+        if (c >= 0xC2 && c <= 0xDF) {
+            extra = 1;
+            codepoint = c & 0x1F;
+        } else if (c >= 0xE0 && c <= 0xEF) {
+            extra = 2;
+            codepoint = c & 0x0F;
+        } else if (c >= 0xF0 && c <= 0xF4) {
+            extra = 3;
+            codepoint = c & 0x07;
+        } else {
+            return false;
+        }
+        if (e - p <= extra) return false;
+        for (int i = 1; i <= extra; ++i) {
+            if ((p[i] & 0xC0) != 0x80) return false;
+            codepoint = (codepoint << 6) | (p[i] & 0x3F);
+        }
+        // Overlong-последовательности, суррогаты и значения за U+10FFFF
+        if ((extra == 2 && codepoint < 0x800) || (extra == 3 && codepoint < 0x10000)
+            || (codepoint >= 0xD800 && codepoint <= 0xDFFF) || codepoint > 0x10FFFF) {
+            return false;
+        }
+        p += extra + 1;
+    }
+    return true;
+}
+
+Encoding detectEncoding(const char *data, qsizetype size)
+{
+    return isValidUtf8(data, size) ? Encoding::Utf8 : Encoding::Cp1251;
+}
+
+QString decodeText(const char *data, const RawCue &cue, Encoding encoding)
+{
+    const char *p = data + cue.textOffset;
+    const char *e = p + cue.textLength;
+    const bool multiline = std::memchr(p, '\n', cue.textLength) != nullptr;
+
+    if (encoding == Encoding::Utf8) {
+        if (!multiline) return QString::fromUtf8(p, cue.textLength);
+        QByteArray joined;
+        joined.reserve(cue.textLength);
+        forEachTextLine(p, e, joined, [](QByteArray &out, const char *s, qsizetype n) { out.append(s, n); });
+        return QString::fromUtf8(joined);
+    }
+
+    QString text;
+    text.reserve(cue.textLength);
+    forEachTextLine(p, e, text, [](QString &out, const char *s, qsizetype n) {
+        for (qsizetype i = 0; i < n; ++i) {
+            const unsigned char c = static_cast<unsigned char>(s[i]);
+            if (c < 0x80) out.append(QChar(c));
+            else if (c >= 0xC0) out.append(QChar(char16_t(0x0410 + (c - 0xC0))));
+            else out.append(QChar(kCp1251High[c - 0x80]));
+        }
+    });
+    return text;
+}
+
+QList<SubtitleCue> parse(const char *data, qsizetype size)
+{
+    TRACE_SCOPE("parse", "SrtParser::parse");
+    const QVector<RawCue> raw = scan(data, size);
+    const Encoding encoding = detectEncoding(data, size);
+    QList<SubtitleCue> cues;
+    cues.reserve(raw.size());
+    for (const RawCue &r : raw) {
+        SubtitleCue cue;
+        cue.start = r.start;
+        cue.end = r.end;
+        cue.text = decodeText(data, r, encoding);
+        cues.append(std::move(cue));
+    }
+    return cues;
+}
+
+QList<SubtitleCue> parse(const QByteArray &data)
+{
+    return parse(data.constData(), data.size());
+}
+
+} // namespace SrtParser
@@ -0,0 +1,310 @@
+#include "core/stallwatchdog.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QSaveFile>
+#include <QTimer>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#if defined(__GLIBC__) || defined(Q_OS_MACOS)
+#define STALL_WATCHDOG_STACKS 1
+#include <csignal>
+#include <cstdlib>
+#include <execinfo.h>
+#include <pthread.h>
+#endif
+
+namespace StallWatchdog {
+
+namespace {
+
+QElapsedTimer g_clock;
+qint64 nowNs()
+{
+    return g_clock.nsecsElapsed();
+}
+
+// --- Разметка операций GUI-потока ---
+// Стек имён пишет только GUI-поток, поток сторожа читает его без блокировок;
+// рваное чтение на границе входа/выхода даёт в худшем случае соседнюю операцию
+constexpr int MaxDepth = 16;
+struct ActiveOperation {
+    std::atomic<const char *> name{nullptr};
+    std::atomic<qint64> sinceNs{0};
+};
+ActiveOperation g_operations[MaxDepth];
+std::atomic<int> g_depth{0};
+thread_local bool t_guiThread = false;
+
+// --- Отметки цикла событий ---
+QTimer *g_heartbeat = nullptr;
+std::atomic<qint64> g_lastBeatNs{0};
+std::atomic<qint64> g_resumedGapNs{0}; // разрыв перед отметкой, завершившей зависание
+qint64 g_thresholdNs = 0;
+// Только GUI-поток
+qint64 g_beats = 0;
+qint64 g_lateBeats = 0;
+qint64 g_maxLatenessNs = 0;
+
+// --- Поток сторожа ---
+std::thread g_thread;
+std::mutex g_wakeMutex;
+std::condition_variable g_wake;
+bool g_stopping = false;
+
+std::mutex g_stallsMutex;
+QVector<Stall> g_stalls;
+
+#if defined(STALL_WATCHDOG_STACKS)
+constexpr int MaxFrames = 64;
+pthread_t g_guiThread;
+void *g_frames[MaxFrames];
+std::atomic<int> g_frameCount{-1};
+struct sigaction g_previousAction;
+
+void sampleStack(int)
+{
+    g_frameCount.store(backtrace(g_frames, MaxFrames), std::memory_order_release);
+}
+
+// Снимок стека GUI-потока: сигнал ему и короткое ожидание ответа
+QStringList sampleGuiStack()
+{
+    g_frameCount.store(-1, std::memory_order_relaxed);
+    if (pthread_kill(g_guiThread, SIGUSR2) != 0) return {};
+    for (int i = 0; i < 100 && g_frameCount.load(std::memory_order_acquire) < 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const int count = g_frameCount.load(std::memory_order_acquire);
+    if (count <= 0) return {};
+    QStringList stack;
+    char **symbols = backtrace_symbols(g_frames, count);
+    // Первые два кадра - обработчик сигнала и трамплин ядра
+    for (int i = 2; i < count; ++i) {
+        stack.append(symbols ? QString::fromLocal8Bit(symbols[i])
+                             : QString("0x%1").arg(quintptr(g_frames[i]), 0, 16));
+    }
+    free(symbols);
+    return stack;
+}
+#else
+QStringList sampleGuiStack()
+{
+    return {};
+}
+#endif
+
+// Активные операции от внешней к внутренней и возраст самой внутренней
+QString activeOperation(qint64 now, qint64 *ageNs)
+{
+    const int depth = qMin(g_depth.load(std::memory_order_acquire), MaxDepth);
+    QStringList names;
+    *ageNs = 0;
+    for (int i = 0; i < depth; ++i) {
+        if (const char *name = g_operations[i].name.load(std::memory_order_acquire)) {
+            names.append(QString::fromUtf8(name));
+            *ageNs = now - g_operations[i].sinceNs.load(std::memory_order_relaxed);
+        }
+    }
+    return names.join(" > ");
+}
+
+QString describe(const Stall &stall)
+{
+    QString text = QString("UI stalled %1 ms at +%2 ms").arg(stall.durationMs).arg(stall.atMs);
+    if (!stall.operation.isEmpty()) {
+        text += QString(" in \"%1\" (running %2 ms)").arg(stall.operation).arg(stall.operationMs);
+    } else {
+        text += " (no marked operation)";
+    }
+    return text;
+}
+
+void watch()
+{
+    // Опрос вчетверо чаще порога: зависание замечается не позже чем через 1.25 порога
+    const auto interval = std::chrono::nanoseconds(qMax<qint64>(g_thresholdNs / 4, 5000000));
+    bool stalled = false;
+    qint64 stallBeatNs = 0;
+    Stall current;
+    std::unique_lock<std::mutex> lock(g_wakeMutex);
+    while (!g_wake.wait_for(lock, interval, [] { return g_stopping; })) {
+        const qint64 now = nowNs();
+        const qint64 lastBeat = g_lastBeatNs.load(std::memory_order_acquire);
+        if (!stalled) {
+            if (now - lastBeat <= g_thresholdNs) continue;
+            stalled = true;
+            stallBeatNs = lastBeat;
+            current = Stall();
+            current.atMs = lastBeat / 1000000;
+            current.stack = sampleGuiStack();
+        }
+        if (lastBeat == stallBeatNs) {
+            // Ещё висим: операция могла смениться, берём последнюю увиденную
+            qint64 ageNs = 0;
+            const QString operation = activeOperation(now, &ageNs);
+            if (!operation.isEmpty()) {
+                current.operation = operation;
+                current.operationMs = ageNs / 1000000;
+            }
+            continue;
+        }
+        // Цикл событий ожил
+        stalled = false;
+        // Длительность - опоздание отметки: разрыв минус её период
+        const qint64 gap = g_resumedGapNs.exchange(0);
+        current.durationMs = qMax<qint64>(0, (gap > 0 ? gap : lastBeat - stallBeatNs) - qint64(HeartbeatMs) * 1000000) / 1000000;
+        qWarning().noquote() << "StallWatchdog:" << describe(current);
+        for (const QString &frame : current.stack) qWarning().noquote() << "    " << frame;
+        std::lock_guard<std::mutex> stallsLock(g_stallsMutex);
+        g_stalls.append(current);
+    }
+}
+
+void beat()
+{
+    const qint64 now = nowNs();
+    const qint64 gap = now - g_lastBeatNs.load(std::memory_order_relaxed);
+    ++g_beats;
+    const qint64 lateness = gap - qint64(HeartbeatMs) * 1000000;
+    if (lateness > qint64(FrameBudgetMs) * 1000000) ++g_lateBeats;
+    g_maxLatenessNs = qMax(g_maxLatenessNs, lateness);
+    if (gap > g_thresholdNs) g_resumedGapNs.store(gap, std::memory_order_relaxed);
+    g_lastBeatNs.store(now, std::memory_order_release);
+}
+
+} // namespace
+
+void start(int thresholdMs)
+{
+    if (g_heartbeat) return;
+    g_clock.start();
+    t_guiThread = true;
+    g_thresholdNs = qint64(qMax(HeartbeatMs * 2, thresholdMs)) * 1000000;
+    g_beats = 0;
+    g_lateBeats = 0;
+    g_maxLatenessNs = 0;
+    g_lastBeatNs.store(nowNs());
+    {
+        std::lock_guard<std::mutex> lock(g_stallsMutex);
+        g_stalls.clear();
+    }
+
+#if defined(STALL_WATCHDOG_STACKS)
+    g_guiThread = pthread_self();
+    // Первый вызов backtrace() подгружает libgcc - только не в обработчике сигнала
+    backtrace(g_frames, 1);
+    struct sigaction action = {};
+    action.sa_handler = sampleStack;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGUSR2, &action, &g_previousAction);
+#endif
+
+    g_heartbeat = new QTimer(QCoreApplication::instance());
+    g_heartbeat->setTimerType(Qt::PreciseTimer);
+    g_heartbeat->setInterval(HeartbeatMs);
+    QObject::connect(g_heartbeat, &QTimer::timeout, beat);
+    g_heartbeat->start();
+
+    g_stopping = false;
+    g_thread = std::thread(watch);
+}
+
+void stop()
+{
+    if (!g_heartbeat) return;
+    {
+        std::lock_guard<std::mutex> lock(g_wakeMutex);
+        g_stopping = true;
+    }
+    g_wake.notify_all();
+    g_thread.join();
+    delete g_heartbeat;
+    g_heartbeat = nullptr;
+#if defined(STALL_WATCHDOG_STACKS)
+    sigaction(SIGUSR2, &g_previousAction, nullptr);
+#endif
+}
+
+bool isRunning()
+{
+    return g_heartbeat != nullptr;
+}
+
+QVector<Stall> stalls()
+{
+    std::lock_guard<std::mutex> lock(g_stallsMutex);
+    return g_stalls;
+}
+
+Summary summary()
+{
+    Summary result;
+    result.uptimeMs = g_clock.isValid() ? g_clock.elapsed() : 0;
+    result.beats = g_beats;
+    result.lateBeats = g_lateBeats;
+    result.maxLatenessMs = qMax<qint64>(0, g_maxLatenessNs / 1000000);
+    for (const Stall &stall : stalls()) {
+        ++result.stalls;
+        result.stalledMs += stall.durationMs;
+        result.longestMs = qMax(result.longestMs, stall.durationMs);
+    }
+    return result;
+}
+
+QString report()
+{
+    const Summary s = summary();
+    QString text = QString("UI thread over %1 s: %2 heartbeats, %3 late by more than a frame (%4 ms), "
+                           "worst %5 ms; %6 stalls over %7 ms, %8 ms in total, longest %9 ms\n")
+                       .arg(s.uptimeMs / 1000.0, 0, 'f', 1).arg(s.beats).arg(s.lateBeats).arg(FrameBudgetMs)
+                       .arg(s.maxLatenessMs).arg(s.stalls).arg(g_thresholdNs / 1000000).arg(s.stalledMs)
+                       .arg(s.longestMs);
+    for (const Stall &stall : stalls()) {
+        text += describe(stall) + '\n';
+        for (const QString &frame : stall.stack) text += "    " + frame + '\n';
+    }
+    return text;
+}
+
+bool writeReport(const QString &path, QString *error)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    file.write(report().toUtf8());
+    if (!file.commit()) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+Scope::Scope(const char *name)
+{
+    if (!t_guiThread) return;
+    m_active = true;
+    const int depth = g_depth.load(std::memory_order_relaxed);
+    if (depth < MaxDepth) {
+        g_operations[depth].sinceNs.store(nowNs(), std::memory_order_relaxed);
+        g_operations[depth].name.store(name, std::memory_order_release);
+    }
+    g_depth.store(depth + 1, std::memory_order_release);
+}
+
+Scope::~Scope()
+{
+    if (!m_active) return;
+    const int depth = g_depth.load(std::memory_order_relaxed) - 1;
+    if (depth < MaxDepth) g_operations[depth].name.store(nullptr, std::memory_order_release);
+    g_depth.store(depth, std::memory_order_release);
+}
+
+} // namespace StallWatchdog
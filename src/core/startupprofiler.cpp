@@ -0,0 +1,68 @@
+#include "core/startupprofiler.h"
+#include <QDebug>
+#include <QElapsedTimer>
+
+namespace StartupProfiler {
+
+namespace {
+QElapsedTimer g_clock;
+QVector<Phase> g_phases;
+qint64 g_firstPaintNs = -1;
+
+double toMs(qint64 ns)
+{
+    return double(ns) / 1e6;
+}
+}
+
+void start()
+{
+    g_clock.start();
+    g_phases.clear();
+    g_firstPaintNs = -1;
+}
+
+void mark(const QString &name)
+{
+    if (!g_clock.isValid()) return;
+    const qint64 now = g_clock.nsecsElapsed();
+    const qint64 previous = g_phases.isEmpty() ? 0 : g_phases.last().elapsedNs;
+    g_phases.append(Phase{name, now});
+    if (g_firstPaintNs >= 0) {
+        // Отложенная работа: окно уже на экране
+        qDebug().noquote() << QString("Startup: %1 +%2 ms (after first paint)")
+                                  .arg(name).arg(toMs(now - previous), 0, 'f', 1);
+    }
+}
+
+void firstPaint()
+{
+    if (!g_clock.isValid() || g_firstPaintNs >= 0) return;
+    mark("first paint");
+    g_firstPaintNs = g_phases.last().elapsedNs;
+
+    qint64 previous = 0;
+    for (const Phase &phase : g_phases) {
+        qDebug().noquote() << QString("Startup: %1 +%2 ms")
+                                  .arg(phase.name, -24).arg(toMs(phase.elapsedNs - previous), 7, 'f', 1);
+        previous = phase.elapsedNs;
+    }
+    qDebug().noquote() << QString("Startup: time to first paint %1 ms").arg(toMs(g_firstPaintNs), 0, 'f', 1);
+}
+
+bool firstPaintDone()
+{
+    return g_firstPaintNs >= 0;
+}
+
+double timeToFirstPaintMs()
+{
+    return g_firstPaintNs >= 0 ? toMs(g_firstPaintNs) : -1.0;
+}
+
+QVector<Phase> phases()
+{
+    return g_phases;
+}
+
+} // namespace StartupProfiler
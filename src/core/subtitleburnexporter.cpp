@@ -0,0 +1,307 @@
+#include "core/subtitleburnexporter.h"
+#include "core/subtitlewriter.h"
+#include <QProcess>
+#include <QFile>
+#include <QDir>
+#include <QThread>
+#include <QDebug>
+#include <QtConcurrent>
+#include <cmath>
+#include <algorithm>
+
+namespace {
+
+// Стиль ближе к оверлею плеера: белый жирный текст на полупрозрачной плашке
+const char *kSubtitleStyle = "FontSize=20,Bold=1,PrimaryColour=&H00FFFFFF,BorderStyle=3,Outline=6,"
+                             "OutlineColour=&H38000000,BackColour=&H38000000,MarginV=20";
+
+// Сегменты короче этого не имеет смысла кодировать отдельно
+const double kMinSegmentSeconds = 4.0;
+
+} // namespace
+
+SubtitleBurnExporter::SubtitleBurnExporter(QObject *parent)
+    : QObject(parent)
+    , m_maxJobs(qMax(1, QThread::idealThreadCount()))
+{
+}
+
+SubtitleBurnExporter::~SubtitleBurnExporter()
+{
+    cancel();
+}
+
+void SubtitleBurnExporter::start(const QString &videoPath, const QString &outputPath, SubtitleTrackPtr track)
+{
+    Q_ASSERT(!m_running);
+    m_videoPath = videoPath;
+    m_outputPath = outputPath;
+    m_track = std::move(track);
+    m_segments.clear();
+    m_nextSegment = 0;
+    m_runningJobs = 0;
+    m_duration = 0;
+    m_running = true;
+    m_timer.start();
+
+    m_workDir.reset(new QTemporaryDir(QDir::tempPath() + "/simple_player_burn_XXXXXX"));
+    if (!m_workDir->isValid()) {
+        finish(false, "Не удалось создать временный каталог");
+        return;
+    }
+
+    // Длительность и ключевые кадры - из индекса пакетов (кэш или один проход ffprobe)
+    emit progress(0, "Поиск ключевых кадров...");
+    auto error = std::make_shared<QString>();
+    m_probe = new QFutureWatcher<PacketIndexPtr>(this);
+    connect(m_probe, &QFutureWatcher<PacketIndexPtr>::finished, this, [this, error]() {
+        QFutureWatcher<PacketIndexPtr> *probe = m_probe;
+        m_probe = nullptr;
+        probe->deleteLater();
+        onProbeFinished(probe->result(), *error);
+    });
+    const QString videoPath = m_videoPath;
+    m_probeCancelled = std::make_shared<std::atomic<bool>>(false);
+    const auto cancelled = m_probeCancelled;
+    m_probe->setFuture(QtConcurrent::run([videoPath, error, cancelled]() {
+        return PacketIndex::loadOrBuild(videoPath, error.get(), [cancelled]() { return cancelled->load(); });
+    }));
+}
+
+void SubtitleBurnExporter::onProbeFinished(PacketIndexPtr index, const QString &error)
+{
+    if (!m_running) return;
+    if (!index) {
+        finish(false, error);
+        return;
+    }
+    m_duration = index->durationSeconds();
+    if (m_duration <= 0) {
+        finish(false, "Не удалось определить длительность видео");
+        return;
+    }
+    QVector<double> keyframes;
+    keyframes.reserve(index->keyframes().size());
+    for (qint64 us : index->keyframes()) {
+        keyframes.append(us / 1e6);
+    }
+    planSegments(keyframes);
+
+    // Субтитры для каждого сегмента сдвигаются к нулю: после -ss перед -i время начинается с 0
+    for (int i = 0; i < m_segments.size(); ++i) {
+        const Segment &seg = m_segments[i];
+        const qint64 from = qRound64(seg.start * 1000);
+        const qint64 to = i + 1 < m_segments.size() ? qRound64(seg.end * 1000) : -1;
+        QFile srt(m_workDir->filePath(QString("seg_%1.srt").arg(i, 3, 10, QChar('0'))));
+        if (!srt.open(QIODevice::WriteOnly) || srt.write(SubtitleWriter::toSrt(*m_track, from, from, to)) < 0) {
+            finish(false, "Не удалось записать временный файл субтитров");
+            return;
+        }
+    }
+    qDebug() << "SubtitleBurnExporter:" << m_segments.size() << "segments," << keyframes.size()
+             << "keyframes, duration" << m_duration << "s, jobs" << m_maxJobs;
+    launchPendingSegments();
+}
+
+void SubtitleBurnExporter::planSegments(const QVector<double> &keyframes)
+{
+    // Сегментов в пару раз больше, чем потоков, чтобы ядра не простаивали в конце
+    int targetCount = qMax(1, m_maxJobs * 2);
+    targetCount = qMin(targetCount, qMax(1, int(m_duration / kMinSegmentSeconds)));
+    const double targetLength = m_duration / targetCount;
+
+    QVector<double> cuts;
+    cuts.append(0.0);
+    for (int i = 1; i < targetCount; ++i) {
+        const double ideal = i * targetLength;
+        auto it = std::lower_bound(keyframes.begin(), keyframes.end(), ideal);
+        double best = -1;
+        if (it != keyframes.end()) best = *it;
+        if (it != keyframes.begin() && (best < 0 || ideal - *(it - 1) < best - ideal)) best = *(it - 1);
+        // Резать можно только по ключевому кадру, иначе склейка без перекодирования невозможна
+        if (best > cuts.last() + kMinSegmentSeconds / 2 && best < m_duration - kMinSegmentSeconds / 2) {
+            cuts.append(best);
+        }
+    }
+    for (int i = 0; i < cuts.size(); ++i) {
+        Segment seg;
+        seg.start = cuts[i];
+        seg.end = i + 1 < cuts.size() ? cuts[i + 1] : m_duration;
+        m_segments.append(seg);
+    }
+}
+
+QString SubtitleBurnExporter::segmentFileName(int index) const
+{
+    return QString("seg_%1.ts").arg(index, 3, 10, QChar('0'));
+}
+
+void SubtitleBurnExporter::launchPendingSegments()
+{
+    const int jobs = qMin(m_maxJobs, int(m_segments.size()));
+    // Потоки кодировщика делим между параллельными задачами
+    const int threadsPerJob = qMax(1, QThread::idealThreadCount() / qMax(1, jobs));
+    while (m_running && m_runningJobs < jobs && m_nextSegment < m_segments.size()) {
+        const int index = m_nextSegment++;
+        Segment &seg = m_segments[index];
+        QProcess *process = new QProcess(this);
+        process->setWorkingDirectory(m_workDir->path());
+        seg.process = process;
+
+        QStringList args;
+        args << "-v" << "error" << "-nostdin" << "-y"
+             << "-ss" << QString::number(seg.start, 'f', 6) << "-i" << m_videoPath
+             << "-t" << QString::number(seg.end - seg.start, 'f', 6)
+             << "-map" << "0:v:0" << "-an"
+             << "-vf" << QString("subtitles=seg_%1.srt:force_style='%2'").arg(index, 3, 10, QChar('0')).arg(kSubtitleStyle)
+             << "-c:v" << "libx264" << "-preset" << "veryfast" << "-crf" << "20"
+             << "-threads" << QString::number(threadsPerJob)
+             << "-progress" << "pipe:1" << "-nostats"
+             << segmentFileName(index);
+
+        connect(process, &QProcess::readyReadStandardOutput, this, [this, index, process]() {
+            while (process->canReadLine()) {
+                const QByteArray line = process->readLine().trimmed();
+                if (line.startsWith("out_time_us=")) {
+                    m_segments[index].encodedSeconds = line.mid(12).toLongLong() / 1e6;
+                }
+            }
+            reportProgress();
+        });
+        connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+                [this, index](int exitCode, QProcess::ExitStatus status) {
+                    onSegmentFinished(index, status == QProcess::NormalExit ? exitCode : -1);
+                });
+        watchStartFailure(process, "ffmpeg");
+        ++m_runningJobs;
+        process->start("ffmpeg", args);
+    }
+}
+
+void SubtitleBurnExporter::onSegmentFinished(int index, int exitCode)
+{
+    Segment &seg = m_segments[index];
+    QProcess *process = seg.process;
+    seg.process = nullptr;
+    --m_runningJobs;
+    if (!m_running) {
+        process->deleteLater();
+        return;
+    }
+    if (exitCode != 0) {
+        const QString error = QString::fromUtf8(process->readAllStandardError());
+        process->deleteLater();
+        finish(false, QString("Ошибка кодирования сегмента %1:\n%2").arg(index).arg(error));
+        return;
+    }
+    process->deleteLater();
+    seg.done = true;
+    seg.encodedSeconds = seg.end - seg.start;
+    reportProgress();
+
+    if (std::all_of(m_segments.cbegin(), m_segments.cend(), [](const Segment &s) { return s.done; })) {
+        concatSegments();
+    } else {
+        launchPendingSegments();
+    }
+}
+
+void SubtitleBurnExporter::concatSegments()
+{
+    QFile list(m_workDir->filePath("segments.txt"));
+    if (!list.open(QIODevice::WriteOnly)) {
+        finish(false, "Не удалось записать список сегментов");
+        return;
+    }
+    for (int i = 0; i < m_segments.size(); ++i) {
+        list.write("file '" + segmentFileName(i).toUtf8() + "'\n");
+    }
+    list.close();
+
+    emit progress(95, "Склейка сегментов...");
+    m_concat = new QProcess(this);
+    m_concat->setWorkingDirectory(m_workDir->path());
+    connect(m_concat, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+            [this](int exitCode, QProcess::ExitStatus status) {
+                QProcess *concat = m_concat;
+                m_concat = nullptr;
+                concat->deleteLater();
+                if (!m_running) return;
+                if (status != QProcess::NormalExit || exitCode != 0) {
+                    finish(false, "Ошибка склейки сегментов:\n" + QString::fromUtf8(concat->readAllStandardError()));
+                    return;
+                }
+                qDebug() << "SubtitleBurnExporter: done in" << m_timer.elapsed() << "ms";
+                finish(true, QString());
+            });
+    watchStartFailure(m_concat, "ffmpeg");
+    // Видео склеивается без перекодирования, звук копируется из исходника целиком
+    m_concat->start("ffmpeg", QStringList{"-v", "error", "-nostdin", "-y",
+                                          "-f", "concat", "-safe", "0", "-i", "segments.txt",
+                                          "-i", m_videoPath,
+                                          "-map", "0:v:0", "-map", "1:a?", "-c", "copy",
+                                          m_outputPath});
+}
+
+void SubtitleBurnExporter::watchStartFailure(QProcess *process, const QString &program)
+{
+    // При FailedToStart сигнал finished не приходит
+    connect(process, &QProcess::errorOccurred, this, [this, program](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            finish(false, QString("Не удалось запустить %1. Убедитесь, что он установлен и доступен в PATH.").arg(program));
+        }
+    });
+}
+
+void SubtitleBurnExporter::reportProgress()
+{
+    double encoded = 0;
+    for (const Segment &seg : m_segments) {
+        encoded += qMin(seg.encodedSeconds, seg.end - seg.start);
+    }
+    const int percent = m_duration > 0 ? int(95.0 * encoded / m_duration) : 0;
+    emit progress(percent, QString("Кодирование сегментов (%1 параллельно)...").arg(m_runningJobs));
+}
+
+void SubtitleBurnExporter::cancel()
+{
+    if (!m_running) return;
+    finish(false, "Экспорт отменён");
+}
+
+void SubtitleBurnExporter::finish(bool ok, const QString &error)
+{
+    if (!m_running) return;
+    m_running = false;
+    // ffprobe в фоне убьёт сам loadOrBuild, увидев флаг
+    if (m_probeCancelled) {
+        *m_probeCancelled = true;
+        m_probeCancelled.reset();
+    }
+    if (m_probe) {
+        m_probe->disconnect(this);
+        m_probe->deleteLater();
+        m_probe = nullptr;
+    }
+    const bool concatenating = m_concat != nullptr;
+    // Убиваем всё, что ещё работает, и отключаем обработчики: их поздний finished
+    // с номером сегмента иначе попал бы в m_segments следующего экспорта
+    QList<QProcess *> processes;
+    if (m_concat) processes << m_concat;
+    m_concat = nullptr;
+    for (Segment &seg : m_segments) {
+        if (seg.process) processes << seg.process;
+        seg.process = nullptr;
+    }
+    for (QProcess *process : processes) {
+        process->disconnect(this);
+        process->kill();
+        process->deleteLater();
+    }
+    m_runningJobs = 0;
+    if (!ok && !m_outputPath.isEmpty() && concatenating) {
+        QFile::remove(m_outputPath);
+    }
+    m_workDir.reset();
+    emit finished(ok, error);
+}
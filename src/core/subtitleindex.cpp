@@ -0,0 +1,146 @@
+#include "core/subtitleindex.h"
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <cstring>
+
+namespace SubtitleIndex {
+
+namespace {
+
+const char kMagic[8] = {'S', 'U', 'B', 'I', 'D', 'X', '\0', '\0'};
+const quint32 kFormatVersion = 1;
+// Файл пишется в порядке байт машины; на чужой платформе индекс просто пересоздаётся
+const quint32 kByteOrderMark = 0x01020304;
+
+struct Header {
+    char magic[8];
+    quint32 formatVersion;
+    quint32 byteOrder;
+    quint64 sourceSize;
+    qint64 sourceModified; // мс от эпохи, UTC
+    quint32 cueCount;
+    quint32 entrySize;
+    quint64 entriesOffset;
+    quint64 textOffset;
+    quint64 textLength; // в символах QChar
+};
+
+static_assert(sizeof(SubtitleTrack::Entry) == 24, "SubtitleTrack::Entry layout is part of the index format");
+static_assert(sizeof(Header) % alignof(SubtitleTrack::Entry) == 0, "entries must stay aligned after the header");
+
+qint64 modifiedMs(const QFileInfo &info)
+{
+    return info.lastModified().toMSecsSinceEpoch();
+}
+
+bool fail(QString *error, const QString &message)
+{
+    if (error) *error = message;
+    return false;
+}
+
+} // namespace
+
+QString sidecarPath(const QString &sourcePath)
+{
+    return sourcePath + ".subidx";
+}
+
+bool write(const SubtitleTrack &track, const QString &sourcePath, QString *error)
+{
+    const QFileInfo source(sourcePath);
+    if (!source.exists()) {
+        return fail(error, "Исходный файл субтитров не найден");
+    }
+    const QStringView pool = track.textPool();
+
+    Header header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.formatVersion = kFormatVersion;
+    header.byteOrder = kByteOrderMark;
+    header.sourceSize = quint64(source.size());
+    header.sourceModified = modifiedMs(source);
+    header.cueCount = quint32(track.size());
+    header.entrySize = quint32(sizeof(SubtitleTrack::Entry));
+    header.entriesOffset = sizeof(Header);
+    header.textOffset = header.entriesOffset + quint64(track.size()) * sizeof(SubtitleTrack::Entry);
+    header.textLength = quint64(pool.size());
+
+    QSaveFile file(sidecarPath(sourcePath));
+    if (!file.open(QIODevice::WriteOnly)) {
+        return fail(error, file.errorString());
+    }
+    const qint64 entryBytes = qint64(track.size()) * qint64(sizeof(SubtitleTrack::Entry));
+    const qint64 textBytes = qint64(pool.size()) * qint64(sizeof(QChar));
+    bool ok = file.write(reinterpret_cast<const char *>(&header), sizeof(header)) == qint64(sizeof(header));
+    ok = ok && (entryBytes == 0 || file.write(reinterpret_cast<const char *>(track.entries()), entryBytes) == entryBytes);
+    ok = ok && (textBytes == 0 || file.write(reinterpret_cast<const char *>(pool.data()), textBytes) == textBytes);
+    if (!ok || !file.commit()) {
+        file.cancelWriting();
+        return fail(error, file.errorString());
+    }
+    return true;
+}
+
+SubtitleTrackPtr load(const QString &sourcePath, QString *error)
+{
+    const QFileInfo source(sourcePath);
+    auto file = std::make_shared<QFile>(sidecarPath(sourcePath));
+    if (!file->open(QIODevice::ReadOnly)) {
+        fail(error, file->errorString());
+        return nullptr;
+    }
+    const qint64 size = file->size();
+    if (size < qint64(sizeof(Header))) {
+        fail(error, "Индекс повреждён");
+        return nullptr;
+    }
+    const uchar *data = file->map(0, size);
+    if (!data) {
+        fail(error, file->errorString());
+        return nullptr;
+    }
+
+    Header header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.formatVersion != kFormatVersion
+        || header.byteOrder != kByteOrderMark || header.entrySize != sizeof(SubtitleTrack::Entry)) {
+        fail(error, "Неподдерживаемый формат индекса");
+        return nullptr;
+    }
+    if (!source.exists() || header.sourceSize != quint64(source.size()) || header.sourceModified != modifiedMs(source)) {
+        fail(error, "Индекс устарел");
+        return nullptr;
+    }
+
+    const quint64 fileSize = quint64(size);
+    const quint64 entryBytes = quint64(header.cueCount) * sizeof(SubtitleTrack::Entry);
+    if (header.entriesOffset != sizeof(Header) || header.textOffset != header.entriesOffset + entryBytes
+        || header.textOffset > fileSize || header.textLength > (fileSize - header.textOffset) / sizeof(QChar)) {
+        fail(error, "Индекс повреждён");
+        return nullptr;
+    }
+
+    // Записи используются прямо из отображения; один проход проверяет,
+    // что они отсортированы и не ссылаются за пределы буфера текстов
+    const auto *entries = reinterpret_cast<const SubtitleTrack::Entry *>(data + header.entriesOffset);
+    const auto *text = reinterpret_cast<const QChar *>(data + header.textOffset);
+    for (quint32 i = 0; i < header.cueCount; ++i) {
+        const SubtitleTrack::Entry &e = entries[i];
+        if (e.end < e.start || quint64(e.textOffset) + e.textLength > header.textLength
+            || (i > 0 && e.start < entries[i - 1].start)) {
+            fail(error, "Индекс повреждён");
+            return nullptr;
+        }
+    }
+
+    // Отображение живёт, пока жив QFile; дорожку могут отпустить в любом потоке,
+    // поэтому файл отвязываем от потока, в котором он создан
+    file->moveToThread(nullptr);
+    return std::make_shared<const SubtitleTrack>(std::move(file), entries, int(header.cueCount),
+                                                 text, qsizetype(header.textLength));
+}
+
+} // namespace SubtitleIndex
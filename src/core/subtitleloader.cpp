@@ -0,0 +1,69 @@
+#include "core/subtitleloader.h"
+#include "core/srtparser.h"
+#include "core/subtitleindex.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDebug>
+
+namespace SubtitleLoader {
+
+QStringList siblingCandidates(const QString &videoPath)
+{
+    const QFileInfo video(videoPath);
+    const QDir dir = video.absoluteDir();
+    const QString base = video.completeBaseName();
+
+    QStringList exact;
+    QStringList tagged;
+    // Имя видео не подставляем в маску: скобки вроде "[1080p]" QDir понял бы как шаблон
+    const QStringList entries = dir.entryList({"*.srt", "*.vtt"}, QDir::Files | QDir::Readable, QDir::Name);
+    for (const QString &name : entries) {
+        const QString stem = QFileInfo(name).completeBaseName();
+        if (stem == base) {
+            exact.append(dir.filePath(name));
+        } else if (stem.startsWith(base + '.')) {
+            tagged.append(dir.filePath(name));
+        }
+    }
+    // .srt сортируется раньше .vtt, так что при обоих вариантах берём SRT
+    return exact + tagged;
+}
+
+SubtitleTrackPtr loadFile(const QString &path, QString *error)
+{
+    // Свежий бинарный индекс отображается в память без разбора текста
+    if (SubtitleTrackPtr indexed = SubtitleIndex::load(path)) {
+        return indexed;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = file.errorString();
+        return nullptr;
+    }
+    const qint64 size = file.size();
+    QList<SubtitleCue> cues;
+    if (size > 0) {
+        // Отображение избавляет от копии всего файла; если ФС его не умеет, читаем целиком
+        if (const uchar *data = file.map(0, size)) {
+            cues = SrtParser::parse(reinterpret_cast<const char *>(data), qsizetype(size));
+            file.unmap(const_cast<uchar *>(data));
+        } else {
+            cues = SrtParser::parse(file.readAll());
+        }
+    }
+    if (cues.isEmpty()) {
+        if (error) *error = QString("В файле %1 нет реплик").arg(QFileInfo(path).fileName());
+        return nullptr;
+    }
+    auto track = std::make_shared<const SubtitleTrack>(SubtitleTrack::fromCues(cues));
+    // Индекс - только ускорение: каталог может быть только для чтения
+    QString indexError;
+    if (!SubtitleIndex::write(*track, path, &indexError)) {
+        qDebug() << "SubtitleLoader: index not written for" << path << indexError;
+    }
+    return track;
+}
+
+} // namespace SubtitleLoader
@@ -0,0 +1,166 @@
+#include "core/subtitlescheduler.h"
+#include "core/trace.h"
+#include <cmath>
+#include <limits>
+
+SubtitleScheduler::SubtitleScheduler(QObject *parent)
+    : QObject(parent)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &SubtitleScheduler::onTimeout);
+    m_clock.start();
+}
+
+void SubtitleScheduler::setTrack(SubtitleTrackPtr track)
+{
+    const qint64 position = estimatedPosition();
+    m_track = std::move(track);
+    m_cursor.reset();
+    m_armedBoundary = -1;
+    reanchor(position);
+    // Номер реплики в новой дорожке может совпасть с прежним (снимок живой
+    // дорожки, перезагрузка) - вид всё равно должен взять её из новой, и на паузе тоже
+    m_currentCue = m_track ? m_cursor.seek(*m_track, position) : -1;
+    emit cueChanged(m_currentCue);
+    arm(position);
+}
+
+qint64 SubtitleScheduler::estimatedPosition() const
+{
+    if (!m_playing) return m_anchor;
+    return m_anchor + qint64(m_clock.nsecsElapsed() / 1e6 * m_rate);
+}
+
+void SubtitleScheduler::reanchor(qint64 position)
+{
+    m_anchor = position;
+    m_clock.restart();
+}
+
+bool SubtitleScheduler::frameDriven() const
+{
+    return m_lastFrame.isValid() && m_lastFrame.elapsed() < FrameTimeoutMs;
+}
+
+void SubtitleScheduler::syncPosition(qint64 position)
+{
+    // Кадры точнее отчётов плеера: пока они идут, positionChanged только
+    // показывает, насколько бы ошиблись субтитры без привязки к кадрам
+    if (m_playing && frameDriven()) {
+        m_stats.lastDriftMs = position - estimatedPosition();
+        m_stats.maxAbsDriftMs = qMax(m_stats.maxAbsDriftMs, std::abs(m_stats.lastDriftMs));
+        return;
+    }
+    // Обычный тик: часы идут верно, делать ничего не нужно
+    if (m_playing && std::abs(position - estimatedPosition()) <= ResyncThresholdMs) {
+        return;
+    }
+    seek(position);
+}
+
+void SubtitleScheduler::presentFrame(qint64 framePosition)
+{
+    m_lastFrame.start();
+    reanchor(framePosition);
+    const int previousCue = m_currentCue;
+    evaluate(framePosition);
+    if (m_playing && m_currentCue != previousCue) {
+        recordBoundaryError(framePosition);
+    }
+}
+
+void SubtitleScheduler::recordBoundaryError(qint64 position)
+{
+    if (!m_track) return;
+    // Ближайшая пройденная граница: начало видимой реплики или конец предыдущей
+    const int slot = m_track->slotAt(position);
+    if (slot < 0) return;
+    const qint64 boundary = position < m_track->end(slot) ? m_track->start(slot) : m_track->end(slot);
+    const qint64 error = position - boundary;
+    ++m_stats.samples;
+    m_stats.lastBoundaryErrorMs = error;
+    m_stats.maxBoundaryErrorMs = qMax(m_stats.maxBoundaryErrorMs, error);
+    m_stats.meanBoundaryErrorMs += (error - m_stats.meanBoundaryErrorMs) / m_stats.samples;
+    emit syncMeasured(error);
+}
+
+void SubtitleScheduler::seek(qint64 position)
+{
+    reanchor(position);
+    m_armedBoundary = -1;
+    evaluate(position);
+}
+
+void SubtitleScheduler::setPlaying(bool playing)
+{
+    if (playing == m_playing) return;
+    const qint64 position = estimatedPosition();
+    m_playing = playing;
+    reanchor(position);
+    m_armedBoundary = -1;
+    arm(position);
+}
+
+void SubtitleScheduler::setPlaybackRate(double rate)
+{
+    if (rate <= 0 || rate == m_rate) return;
+    const qint64 position = estimatedPosition();
+    m_rate = rate;
+    reanchor(position);
+    m_armedBoundary = -1;
+    arm(position);
+}
+
+void SubtitleScheduler::evaluate(qint64 position)
+{
+    TRACE_SCOPE("subtitle", "SubtitleScheduler::evaluate");
+    const int cue = m_track ? m_cursor.seek(*m_track, position) : -1;
+    if (cue != m_currentCue) {
+        m_currentCue = cue;
+        emit cueChanged(cue);
+    }
+    arm(position);
+}
+
+void SubtitleScheduler::arm(qint64 position)
+{
+    if (!m_playing || !m_track || m_track->isEmpty()) {
+        m_timer.stop();
+        m_armedBoundary = -1;
+        return;
+    }
+    // Ближайшая граница: конец видимой реплики или начало следующей
+    const int slot = m_track->slotAt(position);
+    qint64 boundary = -1;
+    if (slot >= 0 && position < m_track->end(slot)) {
+        boundary = m_track->end(slot);
+    }
+    if (slot + 1 < m_track->size()) {
+        const qint64 next = m_track->start(slot + 1);
+        boundary = boundary < 0 ? next : qMin(boundary, next);
+    }
+    if (boundary < 0) {
+        m_timer.stop();
+        m_armedBoundary = -1;
+        return;
+    }
+    if (boundary == m_armedBoundary && m_timer.isActive()) return;
+    m_armedBoundary = boundary;
+    qint64 delay = qint64(std::ceil((boundary - position) / m_rate));
+    // Когда идут кадры, границу отработает кадр; таймер лишь страхует от их пропажи
+    if (frameDriven()) delay += FrameTimeoutMs;
+    m_timer.start(int(qBound<qint64>(0, delay, std::numeric_limits<int>::max())));
+}
+
+void SubtitleScheduler::onTimeout()
+{
+    // Таймер может сработать на долю миллисекунды раньше границы
+    const qint64 position = qMax(estimatedPosition(), m_armedBoundary);
+    m_armedBoundary = -1;
+    const int previousCue = m_currentCue;
+    evaluate(position);
+    if (m_playing && m_currentCue != previousCue) {
+        recordBoundaryError(position);
+    }
+}
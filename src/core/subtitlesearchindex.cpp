@@ -0,0 +1,100 @@
+#include "core/subtitlesearchindex.h"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+const char16_t kSmallYo = 0x0451; // ё
+const char16_t kSmallYe = 0x0435; // е
+}
+
+QString SubtitleSearchIndex::fold(QStringView word)
+{
+    QString folded;
+    folded.reserve(word.size());
+    for (QChar c : word) {
+        c = c.toCaseFolded();
+        if (c.unicode() == kSmallYo) c = QChar(kSmallYe);
+        folded.append(c);
+    }
+    return folded;
+}
+
+QVector<QString> SubtitleSearchIndex::tokenize(QStringView text)
+{
+    QVector<QString> words;
+    qsizetype begin = -1;
+    for (qsizetype i = 0; i <= text.size(); ++i) {
+        const bool wordChar = i < text.size() && text[i].isLetterOrNumber();
+        if (wordChar && begin < 0) {
+            begin = i;
+        } else if (!wordChar && begin >= 0) {
+            words.append(fold(text.mid(begin, i - begin)));
+            begin = -1;
+        }
+    }
+    return words;
+}
+
+void SubtitleSearchIndex::clear()
+{
+    m_terms.clear();
+    m_indexed = 0;
+}
+
+int SubtitleSearchIndex::appendFrom(const SubtitleTrack &track, int maxCues)
+{
+    int end = track.size();
+    if (maxCues >= 0) end = qMin(end, m_indexed + maxCues);
+    const int first = m_indexed;
+    for (int cue = first; cue < end; ++cue) {
+        for (const QString &word : tokenize(track.text(cue))) {
+            QVector<int> &postings = m_terms[word];
+            // Номера реплик идут по возрастанию, повтор слова в реплике - подряд
+            if (postings.isEmpty() || postings.last() != cue) {
+                postings.append(cue);
+            }
+        }
+    }
+    m_indexed = qMax(m_indexed, end);
+    return m_indexed - first;
+}
+
+QVector<int> SubtitleSearchIndex::prefixPostings(const QString &prefix) const
+{
+    QVector<int> result;
+    for (auto it = m_terms.lowerBound(prefix); it != m_terms.cend() && it.key().startsWith(prefix); ++it) {
+        result.append(it.value());
+    }
+    // Одно слово - уже отсортированный список; несколько - сливаем
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+QVector<int> SubtitleSearchIndex::search(QStringView query, int limit) const
+{
+    const QVector<QString> words = tokenize(query);
+    if (words.isEmpty()) return {};
+
+    QVector<QVector<int>> lists;
+    lists.reserve(words.size());
+    for (const QString &word : words) {
+        lists.append(prefixPostings(word));
+        if (lists.last().isEmpty()) return {};
+    }
+    // Пересечение начинаем с самого короткого списка
+    std::sort(lists.begin(), lists.end(), [](const QVector<int> &a, const QVector<int> &b) {
+        return a.size() < b.size();
+    });
+    QVector<int> result = lists.first();
+    for (int i = 1; i < lists.size() && !result.isEmpty(); ++i) {
+        QVector<int> narrowed;
+        std::set_intersection(result.cbegin(), result.cend(), lists[i].cbegin(), lists[i].cend(),
+                              std::back_inserter(narrowed));
+        result.swap(narrowed);
+    }
+    if (limit >= 0 && result.size() > limit) {
+        result.resize(limit);
+    }
+    return result;
+}
@@ -0,0 +1,98 @@
+#include "core/subtitletrack.h"
+#include <algorithm>
+
+namespace {
+// Собственное хранилище дорожки, собранной целиком
+struct OwnedStorage {
+    QVector<SubtitleTrack::Entry> entries;
+    QString arena;
+};
+}
+
+SubtitleTrack::SubtitleTrack(std::shared_ptr<const void> storage, const Entry *entries, int count,
+                             const QChar *text, qsizetype textSize, quint64 version)
+    : m_storage(std::move(storage))
+    , m_entries(entries)
+    , m_count(count)
+    , m_text(text)
+    , m_textSize(textSize)
+    , m_version(version)
+{
+}
+
+SubtitleTrack SubtitleTrack::fromCues(const QList<SubtitleCue> &cues)
+{
+    auto storage = std::make_shared<OwnedStorage>();
+    qsizetype chars = 0;
+    for (const SubtitleCue &cue : cues) {
+        chars += cue.text.size();
+    }
+    storage->entries.reserve(cues.size());
+    storage->arena.reserve(chars);
+    for (const SubtitleCue &cue : cues) {
+        Entry entry;
+        entry.start = cue.start;
+        entry.end = qMax(cue.start, cue.end);
+        entry.textOffset = quint32(storage->arena.size());
+        entry.textLength = quint32(cue.text.size());
+        storage->arena.append(cue.text);
+        storage->entries.append(entry);
+    }
+
+    // Тексты остаются на месте, сортируются только записи
+    QVector<Entry> &entries = storage->entries;
+    std::stable_sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+        return a.start < b.start;
+    });
+    // Одинаковое начало - остаётся последняя добавленная реплика
+    auto last = std::unique(entries.rbegin(), entries.rend(), [](const Entry &a, const Entry &b) {
+        return a.start == b.start;
+    });
+    entries.erase(entries.begin(), last.base());
+
+    const Entry *data = entries.constData();
+    const int count = int(entries.size());
+    const QChar *text = storage->arena.constData();
+    const qsizetype textSize = storage->arena.size();
+    return SubtitleTrack(std::move(storage), data, count, text, textSize);
+}
+
+QStringView SubtitleTrack::text(int index) const
+{
+    const Entry &e = m_entries[index];
+    return QStringView(m_text + e.textOffset, e.textLength);
+}
+
+int SubtitleTrack::slotAt(qint64 position) const
+{
+    const Entry *it = std::upper_bound(m_entries, m_entries + m_count, position,
+                                       [](qint64 pos, const Entry &e) { return pos < e.start; });
+    return int(it - m_entries) - 1;
+}
+
+int SubtitleTrack::indexAt(qint64 position) const
+{
+    const int slot = slotAt(position);
+    return slot >= 0 && position < m_entries[slot].end ? slot : -1;
+}
+
+int SubtitleTrack::Cursor::seek(const SubtitleTrack &track, qint64 position)
+{
+    const int n = track.size();
+    auto slotContains = [&](int slot) {
+        const bool afterStart = slot < 0 || track.start(slot) <= position;
+        const bool beforeNext = slot + 1 >= n || position < track.start(slot + 1);
+        return afterStart && beforeNext;
+    };
+
+    if (m_slot >= n) m_slot = -1;
+    if (!slotContains(m_slot)) {
+        // При воспроизведении позиция почти всегда переходит в соседний слот
+        if (m_slot + 1 < n && slotContains(m_slot + 1)) {
+            ++m_slot;
+        } else {
+            m_slot = track.slotAt(position);
+        }
+    }
+    return m_slot >= 0 && position < track.end(m_slot) ? m_slot : -1;
+}
@@ -0,0 +1,130 @@
+#include "core/subtitlewriter.h"
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QString>
+
+namespace SubtitleWriter {
+
+namespace {
+
+// hh:mm:ss + разделитель + миллисекунды (SRT/VTT)
+QByteArray formatTime(qint64 ms, char separator)
+{
+    if (ms < 0) ms = 0;
+    return QString("%1:%2:%3%4%5")
+        .arg(ms / 3600000, 2, 10, QChar('0'))
+        .arg((ms % 3600000) / 60000, 2, 10, QChar('0'))
+        .arg((ms % 60000) / 1000, 2, 10, QChar('0'))
+        .arg(QChar(separator))
+        .arg(ms % 1000, 3, 10, QChar('0'))
+        .toLatin1();
+}
+
+// h:mm:ss.cc - в ASS сотые доли секунды
+QByteArray formatAssTime(qint64 ms)
+{
+    if (ms < 0) ms = 0;
+    return QString("%1:%2:%3.%4")
+        .arg(ms / 3600000)
+        .arg((ms % 3600000) / 60000, 2, 10, QChar('0'))
+        .arg((ms % 60000) / 1000, 2, 10, QChar('0'))
+        .arg((ms % 1000) / 10, 2, 10, QChar('0'))
+        .toLatin1();
+}
+
+// Стиль как у оверлея плеера: белый жирный текст на полупрозрачной плашке
+const char *kAssHeader =
+    "[Script Info]\n"
+    "ScriptType: v4.00+\n"
+    "PlayResX: 1920\n"
+    "PlayResY: 1080\n"
+    "WrapStyle: 0\n"
+    "ScaledBorderAndShadow: yes\n"
+    "\n"
+    "[V4+ Styles]\n"
+    "Format: Name, Fontname, Fontsize, PrimaryColour, SecondaryColour, OutlineColour, BackColour, "
+    "Bold, Italic, Underline, StrikeOut, ScaleX, ScaleY, Spacing, Angle, BorderStyle, Outline, Shadow, "
+    "Alignment, MarginL, MarginR, MarginV, Encoding\n"
+    "Style: Default,Arial,54,&H00FFFFFF,&H00FFFFFF,&H38000000,&H38000000,"
+    "-1,0,0,0,100,100,0,0,3,8,0,2,192,192,40,1\n"
+    "\n"
+    "[Events]\n"
+    "Format: Layer, Start, End, Style, Name, MarginL, MarginR, MarginV, Effect, Text\n";
+
+} // namespace
+
+Format formatForPath(const QString &path)
+{
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    if (suffix == "vtt") return Format::Vtt;
+    if (suffix == "ass" || suffix == "ssa") return Format::Ass;
+    return Format::Srt;
+}
+
+QByteArray toSrt(const SubtitleTrack &track, qint64 offset, qint64 from, qint64 to)
+{
+    QByteArray out;
+    int number = 1;
+    for (int i = qMax(0, track.slotAt(from)); i < track.size(); ++i) {
+        qint64 start = track.start(i);
+        qint64 end = track.end(i);
+        if (end <= from || track.text(i).isEmpty()) continue;
+        if (to >= 0 && start >= to) break;
+        start = qMax(start, from);
+        if (to >= 0) end = qMin(end, to);
+        out += QByteArray::number(number++) + '\n';
+        out += formatTime(start - offset, ',') + " --> " + formatTime(end - offset, ',') + '\n';
+        out += track.text(i).toUtf8() + "\n\n";
+    }
+    return out;
+}
+
+QByteArray toVtt(const SubtitleTrack &track)
+{
+    QByteArray out = "WEBVTT\n\n";
+    for (int i = 0; i < track.size(); ++i) {
+        if (track.text(i).isEmpty()) continue;
+        // В тексте реплики VTT запрещены '&', '<' и последовательность "-->"
+        QString text = track.text(i).toString();
+        text.replace('&', "&amp;").replace('<', "&lt;").replace('>', "&gt;");
+        out += formatTime(track.start(i), '.') + " --> " + formatTime(track.end(i), '.') + '\n';
+        out += text.toUtf8() + "\n\n";
+    }
+    return out;
+}
+
+QByteArray toAss(const SubtitleTrack &track)
+{
+    QByteArray out = kAssHeader;
+    for (int i = 0; i < track.size(); ++i) {
+        if (track.text(i).isEmpty()) continue;
+        // Фигурные скобки в ASS открывают теги, а экранировать их нечем
+        QString text = track.text(i).toString();
+        text.replace('{', '(').replace('}', ')').replace('\n', "\\N");
+        out += "Dialogue: 0," + formatAssTime(track.start(i)) + ',' + formatAssTime(track.end(i))
+             + ",Default,,0,0,0,," + text.toUtf8() + '\n';
+    }
+    return out;
+}
+
+QByteArray serialize(const SubtitleTrack &track, Format format)
+{
+    switch (format) {
+    case Format::Vtt: return toVtt(track);
+    case Format::Ass: return toAss(track);
+    case Format::Srt: break;
+    }
+    return toSrt(track);
+}
+
+bool writeFile(const QString &path, const QByteArray &data, QString *error)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+} // namespace SubtitleWriter
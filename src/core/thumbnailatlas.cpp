@@ -0,0 +1,134 @@
+#include "core/thumbnailatlas.h"
+#include "core/mediacache.h"
+#include <QBuffer>
+#include <QFile>
+#include <QSaveFile>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+const char kMagic[8] = {'T', 'H', 'U', 'M', 'B', 'S', '\0', '\0'};
+const quint32 kFormatVersion = 1;
+const quint32 kByteOrderMark = 0x01020304;
+
+struct Header {
+    char magic[8];
+    quint32 formatVersion;
+    quint32 byteOrder;
+    quint64 sourceSize;
+    qint64 sourceModified;
+    qint64 intervalMs;
+    quint32 tileWidth;
+    quint32 tileHeight;
+    quint32 columns;
+    quint32 tileCount;
+};
+
+} // namespace
+
+ThumbnailAtlas::ThumbnailAtlas(qint64 intervalMs, int tileCount)
+    : m_intervalMs(qMax<qint64>(1, intervalMs))
+    , m_tileCount(qBound(0, tileCount, MaxTiles))
+{
+    const int rows = (m_tileCount + Columns - 1) / Columns;
+    if (rows > 0) {
+        m_image = QImage(Columns * TileWidth, rows * TileHeight, QImage::Format_RGB888);
+        m_image.fill(Qt::black);
+    }
+}
+
+qint64 ThumbnailAtlas::intervalFor(qint64 durationMs)
+{
+    const qint64 perTile = (durationMs + MaxTiles - 1) / MaxTiles;
+    return qMax(MinIntervalMs, (perTile + 999) / 1000 * 1000);
+}
+
+int ThumbnailAtlas::indexAt(qint64 positionMs) const
+{
+    const int ready = readyCount();
+    if (ready == 0 || positionMs < 0) return -1;
+    const qint64 index = (positionMs + m_intervalMs / 2) / m_intervalMs;
+    return int(qMin<qint64>(index, ready - 1));
+}
+
+QRect ThumbnailAtlas::tileRect(int index) const
+{
+    return QRect((index % Columns) * TileWidth, (index / Columns) * TileHeight, TileWidth, TileHeight);
+}
+
+void ThumbnailAtlas::appendTile(const uchar *rgb)
+{
+    const int index = m_ready.load(std::memory_order_relaxed);
+    if (index >= m_tileCount) return;
+    // Сетку уже могут рисовать: пишем мимо scanLine(), чтобы не отсоединять QImage
+    const QRect rect = tileRect(index);
+    uchar *bits = const_cast<uchar *>(m_image.constBits());
+    const qsizetype stride = m_image.bytesPerLine();
+    for (int y = 0; y < TileHeight; ++y) {
+        std::memcpy(bits + (rect.top() + y) * stride + rect.left() * 3, rgb + y * TileWidth * 3, TileWidth * 3);
+    }
+    m_ready.store(index + 1, std::memory_order_release);
+}
+
+bool ThumbnailAtlas::save(const QString &cachePath, const QString &sourcePath) const
+{
+    const MediaCache::SourceStamp stamp = MediaCache::SourceStamp::of(QFileInfo(sourcePath));
+    Header header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.formatVersion = kFormatVersion;
+    header.byteOrder = kByteOrderMark;
+    header.sourceSize = stamp.size;
+    header.sourceModified = stamp.modified;
+    header.intervalMs = m_intervalMs;
+    header.tileWidth = TileWidth;
+    header.tileHeight = TileHeight;
+    header.columns = Columns;
+    header.tileCount = quint32(readyCount());
+
+    QByteArray jpeg;
+    if (header.tileCount > 0) {
+        QBuffer buffer(&jpeg);
+        buffer.open(QIODevice::WriteOnly);
+        // Хранится только заполненная часть сетки
+        const int rows = (int(header.tileCount) + Columns - 1) / Columns;
+        if (!m_image.copy(0, 0, m_image.width(), rows * TileHeight).save(&buffer, "JPG", 80)) return false;
+    }
+
+    QSaveFile file(cachePath);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    bool ok = file.write(reinterpret_cast<const char *>(&header), sizeof(header)) == qint64(sizeof(header));
+    ok = ok && file.write(jpeg) == jpeg.size();
+    if (!ok || !file.commit()) {
+        file.cancelWriting();
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<ThumbnailAtlas> ThumbnailAtlas::load(const QString &cachePath, const QString &sourcePath)
+{
+    QFile file(cachePath);
+    if (!file.open(QIODevice::ReadOnly)) return nullptr;
+    Header header;
+    if (file.read(reinterpret_cast<char *>(&header), sizeof(header)) != qint64(sizeof(header))) return nullptr;
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.formatVersion != kFormatVersion
+        || header.byteOrder != kByteOrderMark || header.tileWidth != quint32(TileWidth)
+        || header.tileHeight != quint32(TileHeight) || header.columns != quint32(Columns)
+        || header.tileCount > quint32(MaxTiles)) {
+        return nullptr;
+    }
+    MediaCache::SourceStamp stamp;
+    stamp.size = header.sourceSize;
+    stamp.modified = header.sourceModified;
+    if (stamp != MediaCache::SourceStamp::of(QFileInfo(sourcePath))) return nullptr;
+
+    // Пустой атлас тоже кэшируется: у звуковых файлов кадров нет, и незачем снова звать ffmpeg
+    auto atlas = std::make_shared<ThumbnailAtlas>(header.intervalMs, int(header.tileCount));
+    if (header.tileCount == 0) return atlas;
+    const QImage grid = QImage::fromData(file.readAll(), "JPG").convertToFormat(QImage::Format_RGB888);
+    if (grid.width() != atlas->m_image.width() || grid.height() != atlas->m_image.height()) return nullptr;
+    atlas->m_image = grid;
+    atlas->m_ready.store(int(header.tileCount), std::memory_order_relaxed);
+    return atlas;
+}
@@ -0,0 +1,131 @@
+#include "core/thumbnailbuilder.h"
+#include "core/mediacache.h"
+#include "core/packetindex.h"
+#include <QDebug>
+#include <QProcess>
+#include <QtConcurrent>
+
+namespace {
+
+// Есть ли в файле видеодорожка: из кэша индекса пакетов, иначе коротким
+// ffprobe по заголовку. Без ответа считаем, что есть - тогда не кэшируем
+bool hasVideoStream(const QString &path)
+{
+    if (auto index = PacketIndex::load(MediaCache::pathFor(path, "packets"), path)) return index->hasVideo();
+    QProcess probe;
+    probe.start("ffprobe", QStringList{"-v", "error", "-select_streams", "v", "-show_entries", "stream=index",
+                                       "-of", "csv=p=0", path});
+    if (!probe.waitForStarted()) return true;
+    if (!probe.waitForFinished(5000)) {
+        probe.kill();
+        probe.waitForFinished();
+        return true;
+    }
+    if (probe.exitStatus() != QProcess::NormalExit || probe.exitCode() != 0) return true;
+    return !probe.readAllStandardOutput().trimmed().isEmpty();
+}
+
+} // namespace
+
+ThumbnailBuilder::ThumbnailBuilder(QObject *parent)
+    : QObject(parent)
+{
+    m_pool.setMaxThreadCount(1);
+}
+
+ThumbnailBuilder::~ThumbnailBuilder()
+{
+    cancel();
+    m_pool.waitForDone();
+}
+
+void ThumbnailBuilder::cancel()
+{
+    ++m_generation;
+    m_pool.clear();
+    m_path.clear();
+    m_durationMs = 0;
+    m_atlas.reset();
+}
+
+void ThumbnailBuilder::start(const QString &mediaPath, qint64 durationMs)
+{
+    if (mediaPath == m_path && durationMs == m_durationMs) return;
+    cancel();
+    if (mediaPath.isEmpty() || durationMs <= 0) return;
+    m_path = mediaPath;
+    m_durationMs = durationMs;
+    const quint64 generation = m_generation;
+    QtConcurrent::run(&m_pool, [this, mediaPath, durationMs, generation]() {
+        build(mediaPath, durationMs, generation);
+    });
+}
+
+void ThumbnailBuilder::build(const QString &path, qint64 durationMs, quint64 generation)
+{
+    if (generation != m_generation) return;
+    const QString cachePath = MediaCache::pathFor(path, "thumbs");
+    if (auto cached = ThumbnailAtlas::load(cachePath, path)) {
+        publish(cached, generation, true);
+        return;
+    }
+
+    const qint64 interval = ThumbnailAtlas::intervalFor(durationMs);
+    auto atlas = std::make_shared<ThumbnailAtlas>(interval, int(durationMs / interval) + 1);
+    publish(atlas, generation, false);
+
+    const QString size = QString("%1:%2").arg(ThumbnailAtlas::TileWidth).arg(ThumbnailAtlas::TileHeight);
+    const QString filter = QString("fps=1000/%1,scale=%2:force_original_aspect_ratio=decrease,"
+                                   "pad=%2:(ow-iw)/2:(oh-ih)/2")
+                               .arg(interval).arg(size);
+    QProcess ffmpeg;
+    QStringList args;
+    args << "-v" << "error" << "-nostdin" << "-skip_frame" << "nokey" << "-i" << path
+         << "-an" << "-sn" << "-vf" << filter << "-f" << "rawvideo" << "-pix_fmt" << "rgb24" << "-";
+    ffmpeg.start("ffmpeg", args);
+    if (!ffmpeg.waitForStarted()) {
+        qDebug() << "ThumbnailBuilder: failed to start ffmpeg:" << ffmpeg.errorString();
+        return;
+    }
+
+    const qsizetype tileBytes = qsizetype(ThumbnailAtlas::TileWidth) * ThumbnailAtlas::TileHeight * 3;
+    QByteArray pending;
+    for (;;) {
+        if (generation != m_generation) {
+            ffmpeg.kill();
+            ffmpeg.waitForFinished();
+            return;
+        }
+        const bool more = ffmpeg.waitForReadyRead(500);
+        pending += ffmpeg.readAllStandardOutput();
+        qsizetype offset = 0;
+        for (; pending.size() - offset >= tileBytes; offset += tileBytes) {
+            atlas->appendTile(reinterpret_cast<const uchar *>(pending.constData() + offset));
+        }
+        pending.remove(0, offset);
+        if (!more && ffmpeg.state() == QProcess::NotRunning) break;
+    }
+    // Упавший на середине ffmpeg оставил бы в кэше обрезанный атлас. У звукового
+    // файла ffmpeg тоже выходит с ошибкой (нет потоков для вывода), но пустой
+    // атлас - верный ответ, и его стоит закэшировать
+    const bool ok = ffmpeg.exitStatus() == QProcess::NormalExit && ffmpeg.exitCode() == 0;
+    if (ok || (ffmpeg.exitStatus() == QProcess::NormalExit && !hasVideoStream(path))) {
+        atlas->save(cachePath, path);
+    } else {
+        qDebug() << "ThumbnailBuilder: ffmpeg failed, atlas not cached:" << ffmpeg.readAllStandardError().trimmed();
+    }
+    publish(atlas, generation, true);
+}
+
+void ThumbnailBuilder::publish(const std::shared_ptr<ThumbnailAtlas> &atlas, quint64 generation, bool last)
+{
+    // Плитки атласа видны сразу по мере записи, в GUI передаётся только сам атлас
+    QMetaObject::invokeMethod(this, [this, atlas, generation, last]() {
+        if (generation != m_generation) return;
+        if (m_atlas != atlas) {
+            m_atlas = atlas;
+            emit atlasChanged(m_atlas);
+        }
+        if (last) emit finished();
+    }, Qt::QueuedConnection);
+}
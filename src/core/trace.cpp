@@ -0,0 +1,267 @@
+#include "core/trace.h"
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QThread>
+#include <QVector>
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace Trace {
+
+namespace {
+
+// Кольцо одного потока. Писатель - только владелец: кладёт событие в слот
+// и публикует новый счётчик записей. Читатель копирует слоты и затем
+// проверяет, что писатель не успел обойти кольцо по скопированным
+struct Ring {
+    Event events[RingCapacity];
+    std::atomic<quint64> written{0};
+    // Меняется, когда кольцо переходит к другому потоку
+    std::atomic<quint64> epoch{0};
+    // Поля ниже - под мьютексом реестра
+    int threadId = 0;
+    QString threadName;
+    bool inUse = false;
+};
+
+struct Registry {
+    QMutex mutex;
+    QVector<std::shared_ptr<Ring>> rings;
+    int lastThreadId = 0;
+};
+
+Registry &registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+const QElapsedTimer &clock()
+{
+    static const QElapsedTimer timer = [] {
+        QElapsedTimer t;
+        t.start();
+        return t;
+    }();
+    return timer;
+}
+
+// Кольцо принадлежит потоку, пока тот жив. После выхода потока события
+// остаются в реестре для выгрузки, пока кольцо не займёт новый поток:
+// иначе пул, перезапускающий потоки, копил бы по кольцу на каждый
+struct RingLease {
+    std::shared_ptr<Ring> ring;
+
+    RingLease()
+    {
+        QThread *thread = QThread::currentThread();
+        QString name = thread ? thread->objectName() : QString();
+        Registry &reg = registry();
+        QMutexLocker lock(&reg.mutex);
+        for (const std::shared_ptr<Ring> &candidate : std::as_const(reg.rings)) {
+            if (!candidate->inUse) {
+                ring = candidate;
+                break;
+            }
+        }
+        if (ring) {
+            ring->epoch.fetch_add(1, std::memory_order_acq_rel);
+            ring->written.store(0, std::memory_order_release);
+        } else {
+            ring = std::make_shared<Ring>();
+            reg.rings.append(ring);
+        }
+        ring->inUse = true;
+        ring->threadId = ++reg.lastThreadId;
+        if (name.isEmpty()) {
+            name = ring->threadId == 1 ? QStringLiteral("main") : QString("thread %1").arg(ring->threadId);
+        }
+        ring->threadName = name;
+    }
+
+    ~RingLease()
+    {
+        Registry &reg = registry();
+        QMutexLocker lock(&reg.mutex);
+        ring->inUse = false;
+    }
+};
+
+Ring *threadRing()
+{
+    thread_local RingLease lease;
+    return lease.ring.get();
+}
+
+// Копия событий кольца, которые гарантированно не перезаписаны во время копирования.
+// epoch - взятый под мьютексом реестра вместе с именем потока
+QVector<Event> snapshot(const Ring &ring, quint64 epoch)
+{
+    if (ring.epoch.load(std::memory_order_acquire) != epoch) return QVector<Event>();
+    const quint64 end = ring.written.load(std::memory_order_acquire);
+    const quint64 begin = end > quint64(RingCapacity) ? end - RingCapacity : 0;
+    QVector<Event> events;
+    events.reserve(int(end - begin));
+    for (quint64 i = begin; i < end; ++i) {
+        events.append(ring.events[i % RingCapacity]);
+    }
+    // Кольцо успели отдать другому потоку - скопированное уже не его
+    if (ring.epoch.load(std::memory_order_acquire) != epoch) return QVector<Event>();
+    // Пока копировали, писатель мог уйти вперёд и затереть начало. Событие
+    // с номером after он, возможно, как раз пишет - в слот события after - RingCapacity
+    const quint64 after = ring.written.load(std::memory_order_acquire);
+    const quint64 safeBegin = after >= quint64(RingCapacity) ? after - RingCapacity + 1 : 0;
+    if (safeBegin > begin) {
+        events.remove(0, int(qMin(safeBegin - begin, quint64(events.size()))));
+    }
+    return events;
+}
+
+QByteArray jsonString(const QString &text)
+{
+    QByteArray out = "\"";
+    for (QChar ch : text) {
+        const ushort c = ch.unicode();
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += char(c);
+        } else if (c < 0x20) {
+            out += QString("\\u%1").arg(c, 4, 16, QChar('0')).toLatin1();
+        } else {
+            out += QString(ch).toUtf8();
+        }
+    }
+    out += '"';
+    return out;
+}
+
+} // namespace
+
+qint64 now()
+{
+    return clock().nsecsElapsed();
+}
+
+void record(const Event &event)
+{
+    Ring *ring = threadRing();
+    const quint64 index = ring->written.load(std::memory_order_relaxed);
+    ring->events[index % RingCapacity] = event;
+    ring->written.store(index + 1, std::memory_order_release);
+}
+
+void instant(const char *category, const char *name)
+{
+    Event event;
+    event.category = category;
+    event.name = name;
+    event.timestampNs = now();
+    event.phase = Phase::Instant;
+    record(event);
+}
+
+void counter(const char *category, const char *name, qint64 value)
+{
+    Event event;
+    event.category = category;
+    event.name = name;
+    event.timestampNs = now();
+    event.value = value;
+    event.phase = Phase::Counter;
+    record(event);
+}
+
+void asyncBegin(const char *category, const char *name, qint64 id)
+{
+    Event event;
+    event.category = category;
+    event.name = name;
+    event.timestampNs = now();
+    event.value = id;
+    event.phase = Phase::AsyncBegin;
+    record(event);
+}
+
+void asyncEnd(const char *category, const char *name, qint64 id)
+{
+    Event event;
+    event.category = category;
+    event.name = name;
+    event.timestampNs = now();
+    event.value = id;
+    event.phase = Phase::AsyncEnd;
+    record(event);
+}
+
+bool writeChromeJson(const QString &path, QString *error)
+{
+    struct Source {
+        std::shared_ptr<Ring> ring;
+        quint64 epoch;
+        int threadId;
+        QString threadName;
+    };
+    QVector<Source> sources;
+    {
+        Registry &reg = registry();
+        QMutexLocker lock(&reg.mutex);
+        for (const std::shared_ptr<Ring> &ring : std::as_const(reg.rings)) {
+            sources.append(Source{ring, ring->epoch.load(std::memory_order_relaxed), ring->threadId, ring->threadName});
+        }
+    }
+
+    QByteArray json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    auto append = [&](const QByteArray &line) {
+        if (!first) json += ",\n";
+        json += line;
+        first = false;
+    };
+    for (const Source &source : sources) {
+        const QByteArray tid = QByteArray::number(source.threadId);
+        append("{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" + tid
+               + ",\"args\":{\"name\":" + jsonString(source.threadName) + "}}");
+        for (const Event &event : snapshot(*source.ring, source.epoch)) {
+            // Chrome ждёт микросекунды
+            QByteArray line = "{\"ph\":\"" + QByteArray(1, char(event.phase))
+                + "\",\"cat\":" + jsonString(QString::fromUtf8(event.category))
+                + ",\"name\":" + jsonString(QString::fromUtf8(event.name))
+                + ",\"pid\":1,\"tid\":" + tid
+                + ",\"ts\":" + QByteArray::number(double(event.timestampNs) / 1000.0, 'f', 3);
+            switch (event.phase) {
+            case Phase::Complete:
+                line += ",\"dur\":" + QByteArray::number(double(event.durationNs) / 1000.0, 'f', 3);
+                break;
+            case Phase::Counter:
+                line += ",\"args\":{\"value\":" + QByteArray::number(event.value) + "}";
+                break;
+            case Phase::AsyncBegin:
+            case Phase::AsyncEnd:
+                line += ",\"id\":" + QByteArray::number(event.value);
+                break;
+            case Phase::Instant:
+                line += ",\"s\":\"t\"";
+                break;
+            }
+            append(line + "}");
+        }
+    }
+    json += "\n]}\n";
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    file.write(json);
+    if (!file.commit()) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+} // namespace Trace
@@ -0,0 +1,320 @@
+#include "core/transcriptionpipeline.h"
+#include "core/srtparser.h"
+#include "core/wavchunker.h"
+#include "core/trace.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QtConcurrent>
+
+// Один запуск транскрипции. Поля процессов и чанков трогает только поток
+// конвейера; parsed и nextMerge - только поток-писатель m_worker
+struct TranscriptionPipeline::Run {
+    quint64 id = 0;
+    QString mediaPath;
+    QString prefix; // общий префикс временных файлов запуска
+    Config config;
+    LiveSubtitleTrackPtr track;
+    std::atomic<bool> cancelled{false};
+
+    QElapsedTimer wall;
+    QProcess *extractor = nullptr;
+    std::shared_ptr<QFile> audio;
+    WavChunker::Format format;
+    QVector<WavChunker::Chunk> chunks;
+    QVector<ChunkStats> chunkStats;
+    QVector<QProcess *> running;
+    int nextChunk = 0;
+    int merged = 0;
+
+    QMap<int, QVector<SubtitleCue>> parsed;
+    int nextMerge = 0;
+
+    QString chunkPath(int index) const { return prefix + QString("_chunk_%1").arg(index); }
+};
+
+namespace {
+quint64 nextRunId()
+{
+    static std::atomic<quint64> counter{0};
+    return ++counter;
+}
+}
+
+TranscriptionPipeline::TranscriptionPipeline(QObject *parent)
+    : QObject(parent)
+{
+    // Один поток: у живой дорожки один писатель, а чанки дописываются по порядку
+    m_worker.setMaxThreadCount(1);
+}
+
+TranscriptionPipeline::~TranscriptionPipeline()
+{
+    cancel();
+    m_worker.waitForDone();
+}
+
+void TranscriptionPipeline::start(const QString &mediaPath)
+{
+    cancel();
+
+    RunPtr run = std::make_shared<Run>();
+    run->id = nextRunId();
+    run->mediaPath = mediaPath;
+    run->config = m_config;
+    run->config.concurrency = qMax(1, run->config.concurrency);
+    const QString workDir = run->config.workDir.isEmpty() ? QDir::tempPath() : run->config.workDir;
+    // pid и номер запуска: два окна или два запуска подряд не делят файлы
+    run->prefix = workDir + "/" + QFileInfo(mediaPath).baseName()
+                + QString("_%1_%2").arg(QCoreApplication::applicationPid()).arg(run->id);
+    run->track = std::make_shared<LiveSubtitleTrack>();
+    run->wall.start();
+    m_run = run;
+    m_track = run->track;
+    m_stats = Stats();
+
+    // Извлечение аудио асинхронно: длинный файл не держит цикл событий
+    QProcess *ffmpeg = new QProcess(this);
+    run->extractor = ffmpeg;
+    connect(ffmpeg, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+            [this, run](int exitCode, QProcess::ExitStatus status) { onExtracted(run, exitCode, status); });
+    // Ошибка запуска приходит прямо из start(); итог - уже после возврата из него
+    connect(ffmpeg, &QProcess::errorOccurred, this, [this, run](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            QMetaObject::invokeMethod(this, [this, run]() {
+                finish(run, false, QString("Не удалось запустить %1").arg(run->config.ffmpegPath));
+            }, Qt::QueuedConnection);
+        }
+    });
+    QStringList args;
+    args << "-i" << mediaPath << "-vn" << "-acodec" << "pcm_s16le" << "-ar" << "16000" << "-ac" << "1"
+         << run->prefix + ".wav" << "-y";
+    TRACE_ASYNC_BEGIN("process", "ffmpeg extract audio", run->id);
+    ffmpeg->start(run->config.ffmpegPath, args);
+    emit processStarted(ffmpeg);
+}
+
+void TranscriptionPipeline::cancel()
+{
+    if (!m_run) return;
+    RunPtr run = std::move(m_run);
+    run->cancelled = true;
+    killProcesses(run);
+    if (run->audio) run->audio->close();
+    QFile::remove(run->prefix + ".wav");
+    // Недописанные чанки потока-писателя уберёт за собой он сам
+    QtConcurrent::run(&m_worker, [run]() {
+        for (int i = 0; i < run->chunks.size(); ++i) {
+            QFile::remove(run->chunkPath(i) + ".wav");
+            QFile::remove(run->chunkPath(i) + ".srt");
+        }
+    });
+}
+
+void TranscriptionPipeline::killProcesses(const RunPtr &run)
+{
+    QVector<QProcess *> processes = run->running;
+    if (run->extractor) processes.append(run->extractor);
+    run->running.clear();
+    run->extractor = nullptr;
+    for (QProcess *process : processes) {
+        process->disconnect(this);
+        process->kill();
+        process->deleteLater();
+    }
+}
+
+void TranscriptionPipeline::onExtracted(const RunPtr &run, int exitCode, QProcess::ExitStatus status)
+{
+    if (run != m_run) return;
+    TRACE_ASYNC_END("process", "ffmpeg extract audio", run->id);
+    run->extractor->deleteLater();
+    run->extractor = nullptr;
+    m_stats.extractMs = run->wall.elapsed();
+    if (status != QProcess::NormalExit || exitCode != 0) {
+        finish(run, false, "Не удалось извлечь аудио");
+        return;
+    }
+
+    // Длительность и нарезка - по заголовку WAV, без ffprobe и ffmpeg на каждый чанк
+    run->audio = std::make_shared<QFile>(run->prefix + ".wav");
+    QString wavError;
+    if (!run->audio->open(QIODevice::ReadOnly) || !WavChunker::readFormat(*run->audio, &run->format, &wavError)) {
+        qDebug() << "TranscriptionPipeline: bad extracted audio" << run->audio->fileName() << wavError;
+        finish(run, false, "Не удалось получить длительность аудио");
+        return;
+    }
+    run->chunks = WavChunker::plan(run->format.durationMs(), run->config.chunkMs, run->config.overlapMs);
+    if (run->chunks.isEmpty()) {
+        finish(run, false, "Не удалось получить длительность аудио");
+        return;
+    }
+    run->chunkStats.resize(run->chunks.size());
+    m_stats.audioMs = run->format.durationMs();
+    m_stats.chunks = run->chunks.size();
+    qDebug() << "TranscriptionPipeline:" << run->mediaPath << m_stats.audioMs << "ms," << m_stats.chunks
+             << "chunks, concurrency" << run->config.concurrency << "model" << run->config.modelPath;
+    emit progressed(0, run->chunks.size());
+    launchChunks(run);
+}
+
+void TranscriptionPipeline::launchChunks(const RunPtr &run)
+{
+    while (run == m_run && run->running.size() < run->config.concurrency && run->nextChunk < run->chunks.size()) {
+        startChunk(run, run->nextChunk++);
+    }
+}
+
+void TranscriptionPipeline::startChunk(const RunPtr &run, int index)
+{
+    const WavChunker::Chunk chunk = run->chunks.at(index);
+    ChunkStats &stats = run->chunkStats[index];
+    stats.index = index;
+    stats.audioMs = chunk.endMs - chunk.startMs;
+    const QString chunkPath = run->chunkPath(index);
+
+    // Интервалы чанка и его процессов в трассе связаны номером чанка
+    TRACE_ASYNC_BEGIN("chunk", "chunk", index);
+    QString chunkError;
+    bool sliced = false;
+    {
+        TRACE_SCOPE("chunk", "slice WAV");
+        QElapsedTimer sliceClock;
+        sliceClock.start();
+        sliced = WavChunker::writeChunk(*run->audio, run->format, chunk, chunkPath + ".wav", &chunkError);
+        stats.sliceNs = sliceClock.nsecsElapsed();
+    }
+    if (!sliced) {
+        qDebug() << "TranscriptionPipeline: chunk" << index << "not written, skipping:" << chunkError;
+        // Пустой чанк всё равно проходит через писателя, чтобы не задержать следующие
+        onWhisperFinished(run, index, nullptr);
+        return;
+    }
+
+    QProcess *whisper = new QProcess(this);
+    run->running.append(whisper);
+    auto clock = std::make_shared<QElapsedTimer>();
+    connect(whisper, &QProcess::started, this, [run, index, clock]() {
+        run->chunkStats[index].spawnNs = clock->nsecsElapsed();
+    });
+    connect(whisper, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+            [this, run, index, whisper, clock](int, QProcess::ExitStatus) {
+                TRACE_ASYNC_END("process", "whisper chunk", index);
+                run->chunkStats[index].whisperMs = clock->elapsed();
+                onWhisperFinished(run, index, whisper);
+            });
+    connect(whisper, &QProcess::errorOccurred, this, [this, run, index, whisper](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            TRACE_ASYNC_END("process", "whisper chunk", index);
+            QMetaObject::invokeMethod(this, [this, run, index, whisper]() { onWhisperFinished(run, index, whisper); },
+                                      Qt::QueuedConnection);
+        }
+    });
+
+    QStringList args;
+    args << "-m" << run->config.modelPath << "-f" << chunkPath + ".wav" << "-osrt" << "-of" << chunkPath
+         << "-l" << run->config.language;
+    if (run->config.whisperThreads > 0) args << "-t" << QString::number(run->config.whisperThreads);
+    args << run->config.whisperArgs;
+    TRACE_ASYNC_BEGIN("process", "whisper chunk", index);
+    clock->start();
+    whisper->start(run->config.whisperPath, args);
+    emit processStarted(whisper);
+}
+
+void TranscriptionPipeline::onWhisperFinished(const RunPtr &run, int index, QProcess *whisper)
+{
+    if (whisper) {
+        if (!run->running.removeOne(whisper)) return; // уже учтён (ошибка запуска и finished)
+        whisper->deleteLater();
+    }
+    if (run != m_run) return;
+
+    const qint64 offset = run->chunks.at(index).startMs;
+    const QString chunkPath = run->chunkPath(index);
+    QFile::remove(chunkPath + ".wav");
+    ChunkStats stats = run->chunkStats.at(index);
+    QtConcurrent::run(&m_worker, [this, run, index, offset, chunkPath, stats]() mutable {
+        if (run->cancelled) return;
+        QElapsedTimer parseClock;
+        parseClock.start();
+        {
+            TRACE_SCOPE("parse", "chunk SRT");
+            QFile srtFile(chunkPath + ".srt");
+            QVector<SubtitleCue> cues;
+            if (srtFile.open(QIODevice::ReadOnly)) {
+                const QByteArray srtData = srtFile.readAll();
+                srtFile.close();
+                stats.ok = true;
+                for (const SubtitleCue &cue : SrtParser::parse(srtData)) {
+                    cues.append(SubtitleCue{cue.start + offset, cue.end + offset, cue.text});
+                }
+            } else {
+                qDebug() << "TranscriptionPipeline: chunk" << index << "whisper failed, no SRT file created";
+            }
+            QFile::remove(chunkPath + ".srt");
+            run->parsed.insert(index, cues);
+        }
+        // Чанки завершаются в любом порядке, в дорожку - строго по порядку
+        int added = 0;
+        while (run->parsed.contains(run->nextMerge)) {
+            for (const SubtitleCue &cue : run->parsed.take(run->nextMerge)) {
+                // Реплики из перекрытия с прошлым чанком отбрасываются
+                added += run->track->append(cue.start, cue.end, cue.text);
+            }
+            ++run->nextMerge;
+        }
+        if (added > 0) run->track->publish();
+        TRACE_COUNTER("chunk", "cues added", added);
+        stats.parseNs = parseClock.nsecsElapsed();
+        stats.cues = added;
+        TRACE_ASYNC_END("chunk", "chunk", index);
+        const bool published = added > 0;
+        QMetaObject::invokeMethod(this, [this, run, stats, published]() {
+            if (run != m_run) return;
+            if (published) {
+                ++m_stats.trackUpdates;
+                emit trackUpdated(run->track);
+            }
+            onChunkMerged(run, stats);
+        }, Qt::QueuedConnection);
+    });
+    // Ненарезанный чанк пропускается прямо из цикла launchChunks
+    if (whisper) launchChunks(run);
+}
+
+void TranscriptionPipeline::onChunkMerged(const RunPtr &run, const ChunkStats &chunk)
+{
+    run->chunkStats[chunk.index] = chunk;
+    m_stats.sliceNs += chunk.sliceNs;
+    m_stats.spawnNs += chunk.spawnNs;
+    m_stats.whisperMs += chunk.whisperMs;
+    m_stats.parseNs += chunk.parseNs;
+    if (!chunk.ok) ++m_stats.failedChunks;
+    ++run->merged;
+    emit chunkFinished(chunk);
+    emit progressed(run->merged, run->chunks.size());
+    if (run->merged == run->chunks.size()) {
+        if (m_stats.failedChunks == m_stats.chunks) {
+            finish(run, false, "whisper не обработал ни одного чанка");
+        } else {
+            finish(run, true, QString());
+        }
+    }
+}
+
+void TranscriptionPipeline::finish(const RunPtr &run, bool ok, const QString &error)
+{
+    if (run != m_run) return;
+    m_stats.wallMs = run->wall.elapsed();
+    killProcesses(run);
+    if (run->audio) run->audio->close();
+    QFile::remove(run->prefix + ".wav");
+    m_run.reset();
+    qDebug() << "TranscriptionPipeline: finished" << ok << error << "in" << m_stats.wallMs << "ms";
+    emit finished(ok, error);
+}
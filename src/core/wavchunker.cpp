@@ -0,0 +1,160 @@
+#include "core/wavchunker.h"
+#include <QFile>
+#include <QtEndian>
+#include <cstring>
+
+namespace WavChunker {
+
+namespace {
+
+const qint64 CopyBlockBytes = 256 * 1024;
+
+bool fail(QString *error, const QString &message)
+{
+    if (error) *error = message;
+    return false;
+}
+
+quint16 u16(const char *p)
+{
+    return qFromLittleEndian<quint16>(p);
+}
+
+quint32 u32(const char *p)
+{
+    return qFromLittleEndian<quint32>(p);
+}
+
+} // namespace
+
+qint64 Format::durationMs() const
+{
+    const qint64 bytesPerSecond = qint64(sampleRate) * bytesPerFrame();
+    return bytesPerSecond > 0 ? dataBytes * 1000 / bytesPerSecond : 0;
+}
+
+bool readFormat(QIODevice &source, Format *format, QString *error)
+{
+    if (!source.seek(0)) return fail(error, "not seekable");
+    const QByteArray riff = source.read(12);
+    if (riff.size() < 12 || !riff.startsWith("RIFF") || riff.mid(8, 4) != "WAVE") {
+        return fail(error, "not a RIFF/WAVE file");
+    }
+
+    Format result;
+    bool haveFormat = false;
+    qint64 position = 12;
+    while (true) {
+        const QByteArray chunkHeader = source.read(8);
+        if (chunkHeader.size() < 8) return fail(error, "no data chunk");
+        const QByteArray id = chunkHeader.left(4);
+        const qint64 size = u32(chunkHeader.constData() + 4);
+        position += 8;
+        if (id == "fmt ") {
+            const QByteArray fmt = source.read(qMin<qint64>(size, 40));
+            if (fmt.size() < 16) return fail(error, "truncated fmt chunk");
+            quint16 tag = u16(fmt.constData());
+            // WAVE_FORMAT_EXTENSIBLE: настоящий формат - в первых байтах GUID подформата
+            if (tag == 0xFFFE && fmt.size() >= 26) tag = u16(fmt.constData() + 24);
+            if (tag != 1) return fail(error, QString("unsupported WAV format %1").arg(tag));
+            result.channels = u16(fmt.constData() + 2);
+            result.sampleRate = int(u32(fmt.constData() + 4));
+            result.bitsPerSample = u16(fmt.constData() + 14);
+            if (result.channels <= 0 || result.sampleRate <= 0 || result.bitsPerSample % 8 != 0) {
+                return fail(error, "bad fmt chunk");
+            }
+            haveFormat = true;
+        } else if (id == "data") {
+            if (!haveFormat) return fail(error, "data chunk before fmt");
+            result.dataOffset = position;
+            // ffmpeg, пишущий в поток, оставляет размер 0 или 0xFFFFFFFF: тогда - до конца файла
+            const qint64 rest = source.size() - position;
+            result.dataBytes = (size == 0 || size == 0xFFFFFFFFLL || size > rest) ? rest : size;
+            result.dataBytes -= result.dataBytes % result.bytesPerFrame();
+            *format = result;
+            return true;
+        }
+        // Чанки выровнены по чётной границе
+        position += size + (size & 1);
+        if (!source.seek(position)) return fail(error, "truncated RIFF chunk");
+    }
+}
+
+QVector<Chunk> plan(qint64 durationMs, qint64 chunkMs, qint64 overlapMs)
+{
+    QVector<Chunk> chunks;
+    const qint64 step = chunkMs - overlapMs;
+    if (durationMs <= 0 || chunkMs <= 0 || step <= 0) return chunks;
+    const qint64 count = (durationMs + step - 1) / step;
+    chunks.reserve(int(count));
+    for (qint64 i = 0; i < count; ++i) {
+        Chunk chunk;
+        chunk.startMs = i * step;
+        chunk.endMs = qMin(chunk.startMs + chunkMs, durationMs);
+        chunks.append(chunk);
+    }
+    return chunks;
+}
+
+QByteArray header(const Format &format, qint64 dataBytes)
+{
+    QByteArray out(44, Qt::Uninitialized);
+    char *p = out.data();
+    const int blockAlign = format.bytesPerFrame();
+    memcpy(p, "RIFF", 4);
+    qToLittleEndian<quint32>(quint32(36 + dataBytes), p + 4);
+    memcpy(p + 8, "WAVEfmt ", 8);
+    qToLittleEndian<quint32>(16, p + 16);
+    qToLittleEndian<quint16>(1, p + 20);
+    qToLittleEndian<quint16>(quint16(format.channels), p + 22);
+    qToLittleEndian<quint32>(quint32(format.sampleRate), p + 24);
+    qToLittleEndian<quint32>(quint32(format.sampleRate * blockAlign), p + 28);
+    qToLittleEndian<quint16>(quint16(blockAlign), p + 32);
+    qToLittleEndian<quint16>(quint16(format.bitsPerSample), p + 34);
+    memcpy(p + 36, "data", 4);
+    qToLittleEndian<quint32>(quint32(dataBytes), p + 40);
+    return out;
+}
+
+void byteRange(const Format &format, const Chunk &chunk, qint64 *offset, qint64 *length)
+{
+    const qint64 frame = format.bytesPerFrame();
+    const qint64 begin = qBound<qint64>(0, chunk.startMs * format.sampleRate / 1000 * frame, format.dataBytes);
+    const qint64 end = qBound<qint64>(begin, chunk.endMs * format.sampleRate / 1000 * frame, format.dataBytes);
+    *offset = begin;
+    *length = end - begin;
+}
+
+bool writeChunk(QIODevice &source, const Format &format, const Chunk &chunk, QIODevice &target, QString *error)
+{
+    qint64 offset = 0;
+    qint64 length = 0;
+    byteRange(format, chunk, &offset, &length);
+    if (target.write(header(format, length)) != 44) return fail(error, target.errorString());
+    if (!source.seek(format.dataOffset + offset)) return fail(error, "seek failed");
+
+    QByteArray block(int(qMin(length, CopyBlockBytes)), Qt::Uninitialized);
+    qint64 remaining = length;
+    while (remaining > 0) {
+        const qint64 wanted = qMin(remaining, qint64(block.size()));
+        const qint64 got = source.read(block.data(), wanted);
+        if (got <= 0) return fail(error, "source truncated");
+        if (target.write(block.constData(), got) != got) return fail(error, target.errorString());
+        remaining -= got;
+    }
+    return true;
+}
+
+bool writeChunk(QIODevice &source, const Format &format, const Chunk &chunk, const QString &path, QString *error)
+{
+    QFile target(path);
+    if (!target.open(QIODevice::WriteOnly | QIODevice::Truncate)) return fail(error, target.errorString());
+    if (!writeChunk(source, format, chunk, target, error)) {
+        target.close();
+        target.remove();
+        return false;
+    }
+    return true;
+}
+
+} // namespace WavChunker
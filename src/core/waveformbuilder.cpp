@@ -0,0 +1,187 @@
+#include "core/waveformbuilder.h"
+#include "core/mediacache.h"
+#include <QDebug>
+#include <QProcess>
+#include <QtConcurrent>
+#include <cmath>
+
+namespace {
+
+// Накопление отсчётов в корзины уровня 0
+class BucketWriter {
+public:
+    explicit BucketWriter(QVector<WaveformPeak> &out) : m_out(out) {}
+
+    void add(const qint16 *samples, qsizetype count)
+    {
+        for (qsizetype i = 0; i < count; ++i) {
+            const int s = samples[i];
+            m_min = qMin(m_min, s);
+            m_max = qMax(m_max, s);
+            m_sumSquares += qint64(s) * s;
+            if (++m_count == WaveformPyramid::BucketSamples) flush();
+        }
+    }
+
+    void flush()
+    {
+        if (m_count == 0 || m_out.size() >= WaveformPyramid::SegmentBuckets) {
+            m_count = 0;
+            return;
+        }
+        WaveformPeak peak;
+        peak.min = qint16(m_min);
+        peak.max = qint16(m_max);
+        peak.rms = quint16(std::lround(std::sqrt(double(m_sumSquares) / m_count)));
+        m_out.append(peak);
+        m_min = 32767;
+        m_max = -32768;
+        m_sumSquares = 0;
+        m_count = 0;
+    }
+
+private:
+    QVector<WaveformPeak> &m_out;
+    int m_min = 32767;
+    int m_max = -32768;
+    qint64 m_sumSquares = 0;
+    int m_count = 0;
+};
+
+} // namespace
+
+// Один запуск расчёта; задачи отменённого запуска видят, что поколение сменилось
+struct WaveformBuilder::Run {
+    QString path;
+    quint64 generation = 0;
+    std::shared_ptr<WaveformPyramid> pyramid;
+    std::atomic<int> remaining{0};
+    std::atomic<bool> failed{false}; // хоть один сегмент не посчитан - в кэш не пишем
+};
+
+WaveformBuilder::WaveformBuilder(QObject *parent)
+    : QObject(parent)
+{
+    // Половина ядер: ffmpeg в каждом процессе сам декодирует, воспроизведению тоже нужно
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() / 2));
+}
+
+WaveformBuilder::~WaveformBuilder()
+{
+    cancel();
+    m_pool.waitForDone();
+}
+
+void WaveformBuilder::cancel()
+{
+    ++m_generation;
+    m_pool.clear();
+    m_path.clear();
+    m_durationMs = 0;
+    m_pyramid.reset();
+}
+
+void WaveformBuilder::start(const QString &mediaPath, qint64 durationMs)
+{
+    if (mediaPath == m_path && durationMs == m_durationMs) return;
+    cancel();
+    if (mediaPath.isEmpty() || durationMs <= 0) return;
+    m_path = mediaPath;
+    m_durationMs = durationMs;
+    auto run = std::make_shared<Run>();
+    run->path = mediaPath;
+    run->generation = m_generation;
+    // Даже чтение кэша - в пуле: пирамида длинного файла весит мегабайты
+    QtConcurrent::run(&m_pool, [this, run, durationMs]() { loadOrSchedule(run, durationMs); });
+}
+
+void WaveformBuilder::loadOrSchedule(const RunPtr &run, qint64 durationMs)
+{
+    if (run->generation != m_generation) return;
+    if (auto cached = WaveformPyramid::load(MediaCache::pathFor(run->path, "wave"), run->path)) {
+        run->pyramid = cached;
+        publish(run, true, true);
+        return;
+    }
+
+    const qint64 samples = durationMs * WaveformPyramid::SampleRate / 1000;
+    run->pyramid = std::make_shared<WaveformPyramid>(
+        (samples + WaveformPyramid::BucketSamples - 1) / WaveformPyramid::BucketSamples);
+    run->remaining = run->pyramid->segmentCount();
+    publish(run, true, false);
+
+    // Сегменты ставятся по порядку, так что волна заполняется слева направо
+    for (int segment = 0; segment < run->pyramid->segmentCount(); ++segment) {
+        QtConcurrent::run(&m_pool, [this, run, segment]() { computeSegment(run, segment); });
+    }
+}
+
+void WaveformBuilder::computeSegment(const RunPtr &run, int segment)
+{
+    if (run->generation != m_generation) return;
+    const double segmentSeconds = double(WaveformPyramid::SegmentBuckets) * WaveformPyramid::BucketSamples
+                                / WaveformPyramid::SampleRate;
+
+    QProcess ffmpeg;
+    QStringList args;
+    // -ss до -i: быстрый переход к сегменту без декодирования всего, что раньше
+    args << "-v" << "error" << "-nostdin"
+         << "-ss" << QString::number(segment * segmentSeconds, 'f', 3)
+         << "-t" << QString::number(segmentSeconds, 'f', 3)
+         << "-i" << run->path << "-vn" << "-ac" << "1" << "-ar" << QString::number(WaveformPyramid::SampleRate)
+         << "-f" << "s16le" << "-";
+    ffmpeg.start("ffmpeg", args);
+
+    QVector<WaveformPeak> peaks;
+    peaks.reserve(WaveformPyramid::SegmentBuckets);
+    BucketWriter writer(peaks);
+    QByteArray pending;
+    if (ffmpeg.waitForStarted()) {
+        for (;;) {
+            if (run->generation != m_generation) {
+                ffmpeg.kill();
+                ffmpeg.waitForFinished();
+                return;
+            }
+            const bool more = ffmpeg.waitForReadyRead(500);
+            pending += ffmpeg.readAllStandardOutput();
+            const qsizetype whole = pending.size() / 2 * 2;
+            writer.add(reinterpret_cast<const qint16 *>(pending.constData()), whole / 2);
+            pending.remove(0, whole);
+            if (!more && ffmpeg.state() == QProcess::NotRunning) break;
+        }
+        writer.flush();
+        if (ffmpeg.exitStatus() != QProcess::NormalExit || ffmpeg.exitCode() != 0) {
+            qDebug() << "WaveformBuilder: ffmpeg failed on segment" << segment << ffmpeg.readAllStandardError().trimmed();
+            run->failed = true;
+        }
+    } else {
+        qDebug() << "WaveformBuilder: failed to start ffmpeg:" << ffmpeg.errorString();
+        run->failed = true;
+    }
+    // Сегмент без звука (или сбой ffmpeg) остаётся тишиной, но считается готовым
+    run->pyramid->setSegment(segment, peaks);
+
+    const bool last = --run->remaining == 0;
+    if (last) {
+        run->pyramid->finalize();
+        // Тишина на месте сбоя в кэше осталась бы навсегда - пусть пересчитается в следующий раз
+        if (!run->failed) run->pyramid->save(MediaCache::pathFor(run->path, "wave"), run->path);
+    }
+    publish(run, false, last);
+}
+
+void WaveformBuilder::publish(const RunPtr &run, bool changed, bool last)
+{
+    // Деструктор дожидается пула, так что this переживает задачу
+    QMetaObject::invokeMethod(this, [this, run, changed, last]() {
+        if (run->generation != m_generation) return;
+        if (changed) {
+            m_pyramid = run->pyramid;
+            emit pyramidChanged(m_pyramid);
+        } else {
+            emit progressed();
+        }
+        if (last) emit finished();
+    }, Qt::QueuedConnection);
+}
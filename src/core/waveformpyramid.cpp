@@ -0,0 +1,208 @@
+#include "core/waveformpyramid.h"
+#include "core/mediacache.h"
+#include <QFile>
+#include <QSaveFile>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+const char kMagic[8] = {'W', 'A', 'V', 'E', 'P', 'K', '\0', '\0'};
+const quint32 kFormatVersion = 1;
+// Как и у индекса субтитров: порядок байт машины, на чужой платформе кэш пересчитывается
+const quint32 kByteOrderMark = 0x01020304;
+
+struct Header {
+    char magic[8];
+    quint32 formatVersion;
+    quint32 byteOrder;
+    quint64 sourceSize;
+    qint64 sourceModified;
+    quint32 sampleRate;
+    quint32 bucketSamples;
+    quint64 bucketCount;
+};
+
+static_assert(sizeof(WaveformPeak) == 6, "WaveformPeak layout is part of the cache format");
+
+// Сумма квадратов и количество - чтобы RMS сводки был честным средним
+struct Accumulator {
+    int min = 0;
+    int max = 0;
+    double sumSquares = 0;
+    int count = 0;
+
+    void add(const WaveformPeak &p)
+    {
+        min = count == 0 ? p.min : qMin(min, int(p.min));
+        max = count == 0 ? p.max : qMax(max, int(p.max));
+        sumSquares += double(p.rms) * p.rms;
+        ++count;
+    }
+
+    WaveformPeak result() const
+    {
+        WaveformPeak p;
+        p.min = qint16(min);
+        p.max = qint16(max);
+        p.rms = count ? quint16(std::lround(std::sqrt(sumSquares / count))) : 0;
+        return p;
+    }
+};
+
+} // namespace
+
+WaveformPyramid::WaveformPyramid(qint64 bucketCount)
+{
+    bucketCount = qMax<qint64>(1, bucketCount);
+    for (qint64 size = bucketCount;; size = (size + 1) / 2) {
+        m_levels.emplace_back(size_t(size));
+        if (size == 1) break;
+    }
+    m_segmentCount = int((bucketCount + SegmentBuckets - 1) / SegmentBuckets);
+    m_ready.reset(new std::atomic<bool>[m_segmentCount]);
+    for (int i = 0; i < m_segmentCount; ++i) {
+        m_ready[i].store(false, std::memory_order_relaxed);
+    }
+}
+
+bool WaveformPyramid::isSegmentReady(int segment) const
+{
+    return segment >= 0 && segment < m_segmentCount && m_ready[segment].load(std::memory_order_acquire);
+}
+
+void WaveformPyramid::buildLevels(qint64 fromBucket, qint64 toBucket, int lastLevel)
+{
+    lastLevel = qMin(lastLevel, int(m_levels.size()) - 1);
+    for (int level = 1; level <= lastLevel; ++level) {
+        const std::vector<WaveformPeak> &below = m_levels[level - 1];
+        std::vector<WaveformPeak> &current = m_levels[level];
+        const qint64 first = fromBucket >> level;
+        const qint64 last = qMin<qint64>(((toBucket - 1) >> level) + 1, qint64(current.size()));
+        for (qint64 i = first; i < last; ++i) {
+            Accumulator acc;
+            acc.add(below[size_t(2 * i)]);
+            if (size_t(2 * i + 1) < below.size()) acc.add(below[size_t(2 * i + 1)]);
+            current[size_t(i)] = acc.result();
+        }
+    }
+}
+
+void WaveformPyramid::setSegment(int segment, const QVector<WaveformPeak> &peaks)
+{
+    if (segment < 0 || segment >= m_segmentCount) return;
+    std::vector<WaveformPeak> &base = m_levels[0];
+    const qint64 from = qint64(segment) * SegmentBuckets;
+    const qint64 to = qMin<qint64>(from + SegmentBuckets, qint64(base.size()));
+    const qint64 count = qMin<qint64>(to - from, peaks.size());
+    std::copy(peaks.constBegin(), peaks.constBegin() + count, base.begin() + from);
+    std::fill(base.begin() + from + count, base.begin() + to, WaveformPeak());
+
+    buildLevels(from, to, SegmentLevels - 1);
+    m_ready[segment].store(true, std::memory_order_release);
+}
+
+void WaveformPyramid::finalize()
+{
+    // Уровни внутри сегментов уже готовы, строим только те, что их объединяют
+    const int levels = int(m_levels.size());
+    for (int level = SegmentLevels; level < levels; ++level) {
+        const std::vector<WaveformPeak> &below = m_levels[level - 1];
+        std::vector<WaveformPeak> &current = m_levels[level];
+        for (size_t i = 0; i < current.size(); ++i) {
+            Accumulator acc;
+            acc.add(below[2 * i]);
+            if (2 * i + 1 < below.size()) acc.add(below[2 * i + 1]);
+            current[i] = acc.result();
+        }
+    }
+    m_complete.store(true, std::memory_order_release);
+}
+
+bool WaveformPyramid::peak(qint64 fromBucket, qint64 toBucket, WaveformPeak *out) const
+{
+    fromBucket = qMax<qint64>(0, fromBucket);
+    toBucket = qMin(toBucket, bucketCount());
+    if (toBucket <= fromBucket) return false;
+
+    // Самый грубый уровень, корзина которого не шире запрошенного диапазона;
+    // пока расчёт идёт, доступны только уровни внутри сегментов
+    int level = 0;
+    while (level + 1 < int(m_levels.size()) && (qint64(2) << level) <= toBucket - fromBucket) {
+        ++level;
+    }
+    if (level >= SegmentLevels && !isComplete()) {
+        level = SegmentLevels - 1;
+    }
+
+    Accumulator acc;
+    const qint64 first = fromBucket >> level;
+    const qint64 last = (toBucket - 1) >> level;
+    for (qint64 i = first; i <= last; ++i) {
+        if (level < SegmentLevels && !isSegmentReady(int((i << level) / SegmentBuckets))) continue;
+        acc.add(m_levels[level][size_t(i)]);
+    }
+    if (acc.count == 0) return false;
+    *out = acc.result();
+    return true;
+}
+
+bool WaveformPyramid::save(const QString &cachePath, const QString &sourcePath) const
+{
+    if (!isComplete()) return false;
+    const MediaCache::SourceStamp stamp = MediaCache::SourceStamp::of(QFileInfo(sourcePath));
+
+    Header header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.formatVersion = kFormatVersion;
+    header.byteOrder = kByteOrderMark;
+    header.sourceSize = stamp.size;
+    header.sourceModified = stamp.modified;
+    header.sampleRate = SampleRate;
+    header.bucketSamples = BucketSamples;
+    header.bucketCount = quint64(bucketCount());
+
+    QSaveFile file(cachePath);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    const qint64 bytes = bucketCount() * qint64(sizeof(WaveformPeak));
+    bool ok = file.write(reinterpret_cast<const char *>(&header), sizeof(header)) == qint64(sizeof(header));
+    ok = ok && file.write(reinterpret_cast<const char *>(m_levels[0].data()), bytes) == bytes;
+    if (!ok || !file.commit()) {
+        file.cancelWriting();
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<WaveformPyramid> WaveformPyramid::load(const QString &cachePath, const QString &sourcePath)
+{
+    QFile file(cachePath);
+    if (!file.open(QIODevice::ReadOnly)) return nullptr;
+
+    Header header;
+    if (file.read(reinterpret_cast<char *>(&header), sizeof(header)) != qint64(sizeof(header))) return nullptr;
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.formatVersion != kFormatVersion
+        || header.byteOrder != kByteOrderMark || header.sampleRate != quint32(SampleRate)
+        || header.bucketSamples != quint32(BucketSamples)) {
+        return nullptr;
+    }
+    MediaCache::SourceStamp stamp;
+    stamp.size = header.sourceSize;
+    stamp.modified = header.sourceModified;
+    if (stamp != MediaCache::SourceStamp::of(QFileInfo(sourcePath))) return nullptr;
+    if (header.bucketCount == 0
+        || header.bucketCount != quint64(file.size() - qint64(sizeof(header))) / sizeof(WaveformPeak)) {
+        return nullptr;
+    }
+
+    auto pyramid = std::make_shared<WaveformPyramid>(qint64(header.bucketCount));
+    const qint64 bytes = qint64(header.bucketCount) * qint64(sizeof(WaveformPeak));
+    if (file.read(reinterpret_cast<char *>(pyramid->m_levels[0].data()), bytes) != bytes) return nullptr;
+    pyramid->buildLevels(0, qint64(header.bucketCount), SegmentLevels - 1);
+    for (int i = 0; i < pyramid->m_segmentCount; ++i) {
+        pyramid->m_ready[i].store(true, std::memory_order_relaxed);
+    }
+    pyramid->finalize();
+    return pyramid;
+}
@@ -3,25 +3,71 @@
 #include <QMessageBox>
 #include <QIcon>
 #include "core/simplemediaplayer.h"
+#include "core/startupprofiler.h"
+#include "core/trace.h"
+#include "core/stallwatchdog.h"
+#include <QDir>
+#include <QDebug>
 
 int main(int argc, char *argv[])
 {
+    StartupProfiler::start();
     QApplication app(argc, argv);
+    StartupProfiler::mark("QApplication");
     QIcon appIcon(":/icons/app_image.png");
     app.setWindowIcon(appIcon);
     
     SimpleMediaPlayer player;
     player.setWindowIcon(appIcon);
+    
+    // Файлы из командной строки открываем ещё до показа окна: демуксер
+    // поднимается, пока окно рисуется, и воспроизведение начинается сразу
+    QStringList filePaths;
+    for (int i = 1; i < argc; ++i) {
+        filePaths.append(QString::fromLocal8Bit(argv[i]));
+    }
+    bool opened = true;
+    if (!filePaths.isEmpty()) {
+        opened = player.openPlaylist(filePaths);
+        if (opened) player.play();
+        StartupProfiler::mark("open command line file");
+    }
     player.show();
     
-    // Если передан аргумент командной строки, открываем файл
-    if (argc > 1) {
-        QString filePath = QString::fromLocal8Bit(argv[1]);
-        if (!player.openFile(filePath)) {
-            QMessageBox::warning(&player, "Error", "Failed to open file: " + filePath);
-        }
+    if (!opened) {
+        QMessageBox::warning(&player, "Error", "Failed to open file: " + filePaths.join(", "));
     }
     // Убираем автоматическое открытие диалога - теперь пользователь может использовать кнопку "Open File"
     
-    return app.exec();
+    // Сторож GUI-потока: порог из SIMPLE_PLAYER_STALL_MS (0 - выключен), сводка
+    // в лог при выходе и в SIMPLE_PLAYER_STALL_LOG, если задан. Запускается перед
+    // циклом событий: до него окно ещё строится, это меряет StartupProfiler
+    bool thresholdSet = false;
+    const int stallThresholdMs = qEnvironmentVariableIntValue("SIMPLE_PLAYER_STALL_MS", &thresholdSet);
+    if (!thresholdSet || stallThresholdMs > 0) {
+        StallWatchdog::start(thresholdSet ? stallThresholdMs : StallWatchdog::DefaultThresholdMs);
+    }
+    
+    const int exitCode = app.exec();
+    if (StallWatchdog::isRunning()) {
+        StallWatchdog::stop();
+        qDebug().noquote() << StallWatchdog::report();
+        const QString stallLogPath = qEnvironmentVariable("SIMPLE_PLAYER_STALL_LOG");
+        QString stallLogError;
+        if (!stallLogPath.isEmpty() && !StallWatchdog::writeReport(stallLogPath, &stallLogError)) {
+            qDebug() << "Stall log not written:" << stallLogPath << stallLogError;
+        }
+    }
+#if defined(SIMPLE_PLAYER_TRACING) && SIMPLE_PLAYER_TRACING
+    // Трасса сеанса: путь из SIMPLE_PLAYER_TRACE_FILE или временный каталог
+    QString tracePath = qEnvironmentVariable("SIMPLE_PLAYER_TRACE_FILE");
+    if (tracePath.isEmpty()) tracePath = QDir::temp().filePath("simple_player_trace.json");
+    QString traceError;
+    if (Trace::writeChromeJson(tracePath, &traceError)) {
+        qDebug() << "Trace written to" << tracePath;
+    } else {
+        qDebug() << "Trace not written:" << tracePath << traceError;
+    }
+#endif
+    return exitCode;
 } 
\ No newline at end of file
@@ -0,0 +1,252 @@
+#include "ui/seekslider.h"
+#include <QPainter>
+#include <QStyle>
+#include <QStyleOptionSlider>
+#include <QVector>
+#include <QLineF>
+#include <QMouseEvent>
+
+// Всплывающая миниатюра над ползунком: плитка атласа и время под ней
+class ThumbnailPreview : public QWidget {
+public:
+    explicit ThumbnailPreview(QWidget *parent)
+        : QWidget(parent, Qt::ToolTip | Qt::FramelessWindowHint)
+    {
+        setAttribute(Qt::WA_ShowWithoutActivating);
+        setAttribute(Qt::WA_TransparentForMouseEvents);
+        setFixedSize(ThumbnailAtlas::TileWidth + 2, ThumbnailAtlas::TileHeight + TextHeight + 2);
+    }
+
+    void setTile(ThumbnailAtlasPtr atlas, int index, const QString &time)
+    {
+        if (atlas == m_atlas && index == m_index && time == m_time) return;
+        m_atlas = std::move(atlas);
+        m_index = index;
+        m_time = time;
+        update();
+    }
+
+    static constexpr int TextHeight = 18;
+
+protected:
+    void paintEvent(QPaintEvent *) override
+    {
+        QPainter painter(this);
+        painter.fillRect(rect(), Qt::black);
+        if (m_atlas && m_index >= 0) {
+            painter.drawImage(QRect(1, 1, ThumbnailAtlas::TileWidth, ThumbnailAtlas::TileHeight),
+                              m_atlas->image(), m_atlas->tileRect(m_index));
+        }
+        painter.setPen(Qt::white);
+        painter.drawText(QRect(0, ThumbnailAtlas::TileHeight + 1, width(), TextHeight), Qt::AlignCenter, m_time);
+    }
+
+private:
+    ThumbnailAtlasPtr m_atlas;
+    int m_index = -1;
+    QString m_time;
+};
+
+namespace {
+QString formatPreviewTime(qint64 ms)
+{
+    const QString minutes = QString("%1:%2")
+        .arg((ms % 3600000) / 60000, 2, 10, QChar('0'))
+        .arg((ms % 60000) / 1000, 2, 10, QChar('0'));
+    return ms >= 3600000 ? QString::number(ms / 3600000) + ':' + minutes : minutes;
+}
+}
+
+SeekSlider::SeekSlider(Qt::Orientation orientation, QWidget *parent)
+    : QSlider(orientation, parent)
+{
+}
+
+void SeekSlider::setThumbnails(ThumbnailAtlasPtr atlas)
+{
+    m_thumbnails = std::move(atlas);
+    setMouseTracking(m_thumbnails != nullptr);
+    if (!m_thumbnails) hidePreview();
+}
+
+void SeekSlider::mouseMoveEvent(QMouseEvent *event)
+{
+    QSlider::mouseMoveEvent(event);
+    showPreview(event->position().toPoint().x());
+}
+
+void SeekSlider::leaveEvent(QEvent *event)
+{
+    hidePreview();
+    QSlider::leaveEvent(event);
+}
+
+void SeekSlider::hideEvent(QHideEvent *event)
+{
+    hidePreview();
+    QSlider::hideEvent(event);
+}
+
+void SeekSlider::hidePreview()
+{
+    if (m_preview) m_preview->hide();
+}
+
+void SeekSlider::showPreview(int x)
+{
+    if (!m_thumbnails || orientation() != Qt::Horizontal || maximum() <= minimum()) {
+        hidePreview();
+        return;
+    }
+    QStyleOptionSlider option;
+    initStyleOption(&option);
+    int spanStart = 0;
+    int spanLength = 1;
+    waveformRect(option, &spanStart, &spanLength);
+    const int value = QStyle::sliderValueFromPosition(minimum(), maximum(), x - spanStart, spanLength,
+                                                      option.upsideDown);
+    // Поиск плитки - деление на шаг атласа; ещё не готовые места не показываем
+    const int index = m_thumbnails->indexAt(value);
+    if (index < 0) {
+        hidePreview();
+        return;
+    }
+
+    if (!m_preview) m_preview = new ThumbnailPreview(this);
+    m_preview->setTile(m_thumbnails, index, formatPreviewTime(value));
+    const QPoint anchor = mapToGlobal(QPoint(x - m_preview->width() / 2, -m_preview->height() - 4));
+    m_preview->move(anchor);
+    if (!m_preview->isVisible()) m_preview->show();
+}
+
+void SeekSlider::setWaveform(WaveformPyramidPtr waveform)
+{
+    if (waveform == m_waveform) return;
+    const bool heightChanged = !waveform != !m_waveform;
+    m_waveform = std::move(waveform);
+    m_backgroundDirty = true;
+    if (heightChanged) updateGeometry();
+    update();
+}
+
+void SeekSlider::waveformUpdated()
+{
+    m_backgroundDirty = true;
+    update();
+}
+
+QSize SeekSlider::sizeHint() const
+{
+    QSize hint = QSlider::sizeHint();
+    if (m_waveform && orientation() == Qt::Horizontal) hint.setHeight(qMax(hint.height(), WaveformHeight));
+    return hint;
+}
+
+QSize SeekSlider::minimumSizeHint() const
+{
+    QSize hint = QSlider::minimumSizeHint();
+    if (m_waveform && orientation() == Qt::Horizontal) hint.setHeight(qMax(hint.height(), WaveformHeight));
+    return hint;
+}
+
+void SeekSlider::resizeEvent(QResizeEvent *event)
+{
+    QSlider::resizeEvent(event);
+    m_backgroundDirty = true;
+}
+
+void SeekSlider::sliderChange(SliderChange change)
+{
+    // Новая длительность меняет шкалу времени под волной
+    if (change == SliderRangeChange) m_backgroundDirty = true;
+    QSlider::sliderChange(change);
+}
+
+QRect SeekSlider::waveformRect(const QStyleOptionSlider &option, int *spanStart, int *spanLength) const
+{
+    const QRect groove = style()->subControlRect(QStyle::CC_Slider, &option, QStyle::SC_SliderGroove, this);
+    const QRect handle = style()->subControlRect(QStyle::CC_Slider, &option, QStyle::SC_SliderHandle, this);
+    // Центр ручки ходит от groove.left() + handle/2 до groove.right() - handle/2
+    *spanStart = groove.left() + handle.width() / 2;
+    *spanLength = qMax(1, groove.width() - handle.width());
+    return QRect(groove.left(), rect().top() + 2, groove.width(), rect().height() - 4);
+}
+
+void SeekSlider::renderWaveform(const QStyleOptionSlider &option)
+{
+    m_backgroundDirty = false;
+    int spanStart = 0;
+    int spanLength = 1;
+    const QRect area = waveformRect(option, &spanStart, &spanLength);
+    const qreal dpr = devicePixelRatioF();
+    const QSize pixels = (QSizeF(area.size()) * dpr).toSize();
+    if (pixels.isEmpty() || !m_waveform) {
+        m_background = QImage();
+        return;
+    }
+    if (m_background.size() != pixels) {
+        m_background = QImage(pixels, QImage::Format_ARGB32_Premultiplied);
+    }
+    m_background.setDevicePixelRatio(dpr);
+    m_background.fill(Qt::transparent);
+
+    // Столбец на пиксель устройства; границы столбца переводим во время по той же
+    // шкале, по которой ходит ручка, а время - в корзины пирамиды
+    const double msPerPixel = double(maximum() - minimum()) / (spanLength * dpr);
+    const double bucketsPerMs = double(WaveformPyramid::SampleRate) / WaveformPyramid::BucketSamples / 1000.0;
+    const double offset = (area.left() - spanStart) * dpr;
+    const double mid = pixels.height() / 2.0;
+    const double scale = mid / 32768.0;
+
+    QVector<QLineF> envelope;
+    QVector<QLineF> rms;
+    envelope.reserve(pixels.width());
+    rms.reserve(pixels.width());
+    for (int x = 0; x < pixels.width(); ++x) {
+        const double fromMs = minimum() + (x + offset) * msPerPixel;
+        const double toMs = fromMs + msPerPixel;
+        const qint64 fromBucket = qint64(fromMs * bucketsPerMs);
+        const qint64 toBucket = qMax(fromBucket + 1, qint64(toMs * bucketsPerMs));
+        WaveformPeak peak;
+        if (toMs <= 0 || !m_waveform->peak(fromBucket, toBucket, &peak)) continue;
+        const double cx = x + 0.5;
+        envelope.append(QLineF(cx, mid - peak.max * scale, cx, mid - peak.min * scale));
+        rms.append(QLineF(cx, mid - peak.rms * scale, cx, mid + peak.rms * scale));
+    }
+
+    QPainter painter(&m_background);
+    painter.scale(1 / dpr, 1 / dpr); // рисуем в пикселях устройства
+    painter.setPen(QPen(palette().color(QPalette::Mid), 1));
+    painter.drawLines(envelope);
+    painter.setPen(QPen(palette().color(QPalette::Highlight), 1));
+    painter.drawLines(rms);
+}
+
+void SeekSlider::paintEvent(QPaintEvent *event)
+{
+    if (!m_waveform || orientation() != Qt::Horizontal) {
+        QSlider::paintEvent(event);
+        return;
+    }
+
+    QStyleOptionSlider option;
+    initStyleOption(&option);
+    if (m_backgroundDirty) renderWaveform(option);
+
+    int spanStart = 0;
+    int spanLength = 1;
+    const QRect area = waveformRect(option, &spanStart, &spanLength);
+    QPainter painter(this);
+    painter.drawImage(area.topLeft(), m_background);
+
+    // Пройденная часть - полупрозрачной заливкой поверх волны
+    const int handleX = spanStart + QStyle::sliderPositionFromValue(minimum(), maximum(), value(), spanLength,
+                                                                    option.upsideDown);
+    QColor played = palette().color(QPalette::Highlight);
+    played.setAlpha(50);
+    painter.fillRect(QRect(area.left(), area.top(), handleX - area.left(), area.height()), played);
+
+    // Жёлоб заменён волной, стиль рисует только ручку
+    option.subControls = QStyle::SC_SliderHandle;
+    style()->drawComplexControl(QStyle::CC_Slider, &option, &painter, this);
+}
@@ -0,0 +1,152 @@
+#include "ui/subtitlecuerenderer.h"
+#include "core/trace.h"
+#include <QtConcurrent>
+#include <QPainter>
+#include <QFontMetricsF>
+#include <QStringList>
+#include <cmath>
+
+SubtitleCueRenderer::SubtitleCueRenderer(QObject *parent)
+    : QObject(parent)
+    , m_cache(CacheLimitKb)
+{
+    // Один поток: реплики рисуются по порядку и не отнимают ядра у декодера
+    m_pool.setMaxThreadCount(1);
+    m_font.setPointSize(7);
+    m_font.setBold(true);
+}
+
+SubtitleCueRenderer::~SubtitleCueRenderer()
+{
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+void SubtitleCueRenderer::setTrack(SubtitleTrackPtr track)
+{
+    m_track = std::move(track);
+    m_pool.clear();
+    m_pending.clear();
+}
+
+void SubtitleCueRenderer::setGeometry(int textWidth, qreal scale)
+{
+    if (textWidth == m_width && qFuzzyCompare(scale, m_scale)) return;
+    m_width = textWidth;
+    m_scale = scale;
+    invalidate();
+}
+
+void SubtitleCueRenderer::setFont(const QFont &font)
+{
+    if (font == m_font) return;
+    m_font = font;
+    invalidate();
+}
+
+void SubtitleCueRenderer::invalidate()
+{
+    // Задачи старого поколения дорисуются, но их результат будет отброшен
+    ++m_generation;
+    m_pool.clear();
+    m_cache.clear();
+    m_pending.clear();
+    emit invalidated();
+}
+
+void SubtitleCueRenderer::store(const SubtitleLayoutKey &key, const QImage &image)
+{
+    const int cost = qMax<qsizetype>(1, image.sizeInBytes() / 1024);
+    m_cache.insert(key, new QImage(image), cost);
+}
+
+QImage SubtitleCueRenderer::image(const QString &text)
+{
+    if (text.isEmpty() || m_width <= 0 || m_scale <= 0) return QImage();
+    const SubtitleLayoutKey key{text, m_width};
+    if (const QImage *cached = m_cache.object(key)) {
+        return *cached;
+    }
+    QImage image = render(text, m_font, m_width, m_scale);
+    store(key, image);
+    return image;
+}
+
+void SubtitleCueRenderer::prefetchFrom(int index)
+{
+    if (index < 0) return;
+    schedule(index + 1, index + 1 + LookAhead);
+}
+
+void SubtitleCueRenderer::prefetchAround(qint64 position)
+{
+    if (!m_track) return;
+    const int slot = m_track->slotAt(position);
+    schedule(slot - LookBehind, slot + 1 + LookAhead);
+}
+
+void SubtitleCueRenderer::schedule(int from, int to)
+{
+    if (!m_track || m_width <= 0 || m_scale <= 0) return;
+    from = qMax(0, from);
+    to = qMin(to, m_track->size());
+
+    QStringList texts;
+    for (int i = from; i < to; ++i) {
+        SubtitleLayoutKey key{m_track->text(i).toString(), m_width};
+        if (m_cache.contains(key) || m_pending.contains(key)) continue;
+        texts.append(key.text);
+        m_pending.insert(std::move(key));
+    }
+    if (texts.isEmpty()) return;
+
+    const quint64 generation = m_generation;
+    const QFont font = m_font;
+    const int width = m_width;
+    const qreal scale = m_scale;
+    // Деструктор дожидается пула, поэтому this переживает задачу;
+    // доставка результата идёт в поток объекта через очередь событий
+    QtConcurrent::run(&m_pool, [this, texts, font, width, scale, generation]() {
+        QList<QImage> images;
+        images.reserve(texts.size());
+        for (const QString &text : texts) {
+            images.append(render(text, font, width, scale));
+        }
+        QMetaObject::invokeMethod(this, [this, texts, images, width, generation]() {
+            if (generation != m_generation) return;
+            for (int i = 0; i < texts.size(); ++i) {
+                const SubtitleLayoutKey key{texts.at(i), width};
+                m_pending.remove(key);
+                // Оверлей мог уже нарисовать реплику синхронно
+                if (!m_cache.contains(key)) {
+                    store(key, images.at(i));
+                }
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+QImage SubtitleCueRenderer::render(const QString &text, const QFont &font, int textWidth, qreal scale)
+{
+    TRACE_SCOPE("subtitle", "SubtitleCueRenderer::render");
+    QFontMetricsF metrics(font);
+    const QRectF bounds = metrics.boundingRect(QRectF(0, 0, textWidth, 1e6), Qt::AlignHCenter | Qt::TextWordWrap, text);
+    const QSizeF box(std::ceil(bounds.width()) + 2 * PaddingX,
+                     qMax(std::ceil(bounds.height()) + 2 * PaddingY, MinHeight));
+
+    // Растр сразу в пикселях экрана, чтобы при выводе не было масштабирования
+    QImage image(QSize(int(std::ceil(box.width() * scale)), int(std::ceil(box.height() * scale))),
+                 QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(scale);
+    image.fill(Qt::transparent);
+
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+    painter.fillRect(QRectF(QPointF(0, 0), box), QColor(0, 0, 0, 200));
+    painter.setFont(font);
+    painter.setPen(Qt::white);
+    // Переносим по той же ширине, по которой мерили, иначе строки разобьются иначе
+    painter.drawText(QRectF(PaddingX, 0, box.width() - 2 * PaddingX + 1, box.height()),
+                     Qt::AlignCenter | Qt::TextWordWrap, text);
+    return image;
+}
@@ -0,0 +1,53 @@
+#include "ui/subtitleoverlayitem.h"
+#include "ui/subtitlecuerenderer.h"
+#include <QPainter>
+
+SubtitleOverlayItem::SubtitleOverlayItem(SubtitleCueRenderer *renderer, QGraphicsItem *parent)
+    : QGraphicsItem(parent)
+    , m_renderer(renderer)
+{
+}
+
+void SubtitleOverlayItem::setText(const QString &text)
+{
+    if (text == m_text) return;
+    m_text = text;
+    relayout();
+}
+
+void SubtitleOverlayItem::setFrameRect(const QRectF &frameRect)
+{
+    if (frameRect == m_frameRect) return;
+    m_frameRect = frameRect;
+    relayout();
+}
+
+void SubtitleOverlayItem::refresh()
+{
+    relayout();
+}
+
+void SubtitleOverlayItem::relayout()
+{
+    // Ширина переноса задаётся рендереру видом; здесь только берём готовый растр
+    m_image = m_text.isEmpty() || m_frameRect.width() <= 0 ? QImage() : m_renderer->image(m_text);
+    const QRectF rect = m_image.isNull() ? QRectF() : QRectF(QPointF(0, 0), m_image.deviceIndependentSize());
+
+    if (rect.size() != m_rect.size()) {
+        prepareGeometryChange();
+        m_rect = rect;
+    } else {
+        update();
+    }
+    if (!rect.isEmpty()) {
+        // setPos сам инвалидирует старую и новую области элемента
+        setPos(m_frameRect.x() + (m_frameRect.width() - rect.width()) / 2,
+               m_frameRect.bottom() - rect.height() - BottomMargin);
+    }
+}
+
+void SubtitleOverlayItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *)
+{
+    if (m_image.isNull()) return;
+    painter->drawImage(QPointF(0, 0), m_image);
+}
@@ -0,0 +1,107 @@
+#include "ui/subtitlesearchpanel.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+
+namespace {
+QString formatCueTime(qint64 ms)
+{
+    return QString("%1:%2:%3")
+        .arg(ms / 3600000, 2, 10, QChar('0'))
+        .arg((ms % 3600000) / 60000, 2, 10, QChar('0'))
+        .arg((ms % 60000) / 1000, 2, 10, QChar('0'));
+}
+}
+
+SubtitleSearchPanel::SubtitleSearchPanel(QWidget *parent)
+    : QWidget(parent)
+    , m_query(new QLineEdit(this))
+    , m_results(new QListWidget(this))
+    , m_status(new QLabel(this))
+{
+    m_query->setPlaceholderText("Поиск по субтитрам...");
+    m_query->setClearButtonEnabled(true);
+    m_results->setUniformItemSizes(true);
+    m_status->setStyleSheet("QLabel { color: gray; }");
+
+    QHBoxLayout *queryLayout = new QHBoxLayout();
+    queryLayout->addWidget(m_query, /*stretch=*/1);
+    queryLayout->addWidget(m_status);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addLayout(queryLayout);
+    layout->addWidget(m_results);
+
+    m_indexTimer.setSingleShot(true);
+    connect(&m_indexTimer, &QTimer::timeout, this, &SubtitleSearchPanel::indexMore);
+    connect(m_query, &QLineEdit::textChanged, this, &SubtitleSearchPanel::runQuery);
+    // Enter в строке запроса - переход к первой найденной реплике
+    connect(m_query, &QLineEdit::returnPressed, this, [this]() {
+        if (m_results->count() > 0) {
+            emit seekRequested(m_results->item(0)->data(Qt::UserRole).toLongLong());
+        }
+    });
+    // itemActivated покрывает и мышь (щелчок или двойной щелчок - по стилю платформы),
+    // и Enter; itemClicked вдобавок к нему давал бы вторую перемотку на тот же щелчок
+    connect(m_results, &QListWidget::itemActivated, this, [this](QListWidgetItem *item) {
+        emit seekRequested(item->data(Qt::UserRole).toLongLong());
+    });
+}
+
+void SubtitleSearchPanel::setTrack(SubtitleTrackPtr track, bool extendsPrevious)
+{
+    if (!extendsPrevious) {
+        m_index.clear();
+    }
+    m_track = std::move(track);
+    indexMore();
+}
+
+void SubtitleSearchPanel::focusQuery()
+{
+    m_query->setFocus();
+    m_query->selectAll();
+}
+
+void SubtitleSearchPanel::indexMore()
+{
+    if (!m_track) {
+        m_index.clear();
+        runQuery();
+        return;
+    }
+    const int before = m_index.indexedCount();
+    m_index.appendFrom(*m_track, IndexBatch);
+    if (m_index.indexedCount() < m_track->size()) {
+        // Остаток - в следующих итерациях цикла событий
+        m_status->setText(QString("индексация %1%").arg(m_index.indexedCount() * 100 / m_track->size()));
+        m_indexTimer.start(0);
+    } else {
+        m_status->clear();
+    }
+    if (m_index.indexedCount() != before) {
+        runQuery();
+    }
+}
+
+void SubtitleSearchPanel::runQuery()
+{
+    m_results->clear();
+    const QString query = m_query->text();
+    if (!m_track || query.trimmed().isEmpty()) {
+        if (!m_indexTimer.isActive()) m_status->clear();
+        return;
+    }
+
+    const QVector<int> hits = m_index.search(query, MaxResults);
+    for (int cue : hits) {
+        QListWidgetItem *item = new QListWidgetItem(
+            QString("[%1] %2").arg(formatCueTime(m_track->start(cue)), m_track->text(cue).toString()), m_results);
+        item->setData(Qt::UserRole, m_track->start(cue));
+    }
+    if (hits.isEmpty() && m_index.indexedCount() == m_track->size()) {
+        m_status->setText("ничего не найдено");
+    } else if (m_index.indexedCount() == m_track->size()) {
+        m_status->setText(QString("найдено: %1%2").arg(hits.size()).arg(hits.size() >= MaxResults ? "+" : ""));
+    }
+}
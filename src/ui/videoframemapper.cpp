@@ -0,0 +1,280 @@
+#include "ui/videoframemapper.h"
+#include <QVideoFrameFormat>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace {
+
+// Целочисленные коэффициенты YUV -> RGB (масштаб 256)
+struct YuvCoefficients {
+    int yOffset;
+    int yScale;
+    int rv;
+    int gu;
+    int gv;
+    int bu;
+};
+
+YuvCoefficients coefficientsFor(const QVideoFrameFormat &format)
+{
+    const bool full = format.colorRange() == QVideoFrameFormat::ColorRange_Full;
+    const bool bt709 = format.colorSpace() == QVideoFrameFormat::ColorSpace_BT709;
+    if (bt709) {
+        return full ? YuvCoefficients{0, 256, 403, 48, 120, 475} : YuvCoefficients{16, 298, 459, 55, 136, 541};
+    }
+    return full ? YuvCoefficients{0, 256, 359, 88, 183, 454} : YuvCoefficients{16, 298, 409, 100, 208, 516};
+}
+
+inline uint clampByte(int v)
+{
+    return uint(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+// Плоскости 4:2:0: яркость на каждый пиксель, цветность на блок 2x2.
+// uStep - шаг между отсчётами U (1 у планарных форматов, 2 у NV12/NV21)
+struct Planes420 {
+    const uchar *y;
+    int yStride;
+    const uchar *u;
+    const uchar *v;
+    int uvStride;
+    int uvStep;
+};
+
+void convertRows(const Planes420 &p, const YuvCoefficients &c, uchar *out, int width, int firstRow, int lastRow)
+{
+    for (int row = firstRow; row < lastRow; ++row) {
+        const uchar *y = p.y + row * p.yStride;
+        const uchar *u = p.u + (row / 2) * p.uvStride;
+        const uchar *v = p.v + (row / 2) * p.uvStride;
+        QRgb *dst = reinterpret_cast<QRgb *>(out + size_t(row) * width * 4);
+        for (int x = 0; x < width; ++x) {
+            const int ci = (x / 2) * p.uvStep;
+            const int d = u[ci] - 128;
+            const int e = v[ci] - 128;
+            const int luma = (y[x] - c.yOffset) * c.yScale + 128;
+            dst[x] = 0xff000000u
+                   | (clampByte((luma + c.rv * e) >> 8) << 16)
+                   | (clampByte((luma - c.gu * d - c.gv * e) >> 8) << 8)
+                   | clampByte((luma + c.bu * d) >> 8);
+        }
+    }
+}
+
+// Кадр остаётся отображённым, пока жив QImage поверх его памяти
+void releaseMappedFrame(void *info)
+{
+    QVideoFrame *frame = static_cast<QVideoFrame *>(info);
+    frame->unmap();
+    delete frame;
+}
+
+// Среднее четырёх пикселей по каждому байту с округлением. Каналы идут
+// парами в 16-битных дорожках слова, так что сумма четырёх не переполняется;
+// цикл по строке компилятор векторизует
+inline quint32 average4(quint32 a, quint32 b, quint32 c, quint32 d)
+{
+    const quint32 lo = (a & 0x00ff00ffu) + (b & 0x00ff00ffu) + (c & 0x00ff00ffu) + (d & 0x00ff00ffu) + 0x00020002u;
+    const quint32 hi = ((a >> 8) & 0x00ff00ffu) + ((b >> 8) & 0x00ff00ffu)
+                     + ((c >> 8) & 0x00ff00ffu) + ((d >> 8) & 0x00ff00ffu) + 0x00020002u;
+    return ((lo >> 2) & 0x00ff00ffu) | (((hi >> 2) & 0x00ff00ffu) << 8);
+}
+
+void halveRows(const QImage &src, uchar *dst, int dstStride, int width, int firstRow, int lastRow)
+{
+    for (int row = firstRow; row < lastRow; ++row) {
+        const quint32 *top = reinterpret_cast<const quint32 *>(src.constScanLine(2 * row));
+        const quint32 *bottom = reinterpret_cast<const quint32 *>(src.constScanLine(2 * row + 1));
+        quint32 *out = reinterpret_cast<quint32 *>(dst + size_t(row) * dstStride);
+        for (int x = 0; x < width; ++x) {
+            out[x] = average4(top[2 * x], top[2 * x + 1], bottom[2 * x], bottom[2 * x + 1]);
+        }
+    }
+}
+
+const int kRowsPerBand = 64;
+
+// Обрабатывает строки [0, height) полосами в глобальном пуле потоков
+template <typename Fn>
+void forEachBand(int height, Fn fn)
+{
+    QVector<int> bands;
+    for (int row = 0; row < height; row += kRowsPerBand) {
+        bands.append(row);
+    }
+    QtConcurrent::blockingMap(bands, [&](int first) {
+        fn(first, qMin(first + kRowsPerBand, height));
+    });
+}
+
+} // namespace
+
+VideoFrameMapper::VideoFrameMapper(int poolSize)
+    : m_poolSize(qMax(1, poolSize))
+{
+}
+
+VideoFrameMapper::Stats VideoFrameMapper::stats() const
+{
+    Stats stats;
+    stats.zeroCopy = m_zeroCopy.load(std::memory_order_relaxed);
+    stats.converted = m_converted.load(std::memory_order_relaxed);
+    stats.fallback = m_fallback.load(std::memory_order_relaxed);
+    stats.downscaled = m_downscaled.load(std::memory_order_relaxed);
+    stats.dropped = m_dropped.load(std::memory_order_relaxed);
+    return stats;
+}
+
+QImage VideoFrameMapper::acquire(const QSize &size, QImage::Format format)
+{
+    BufferPtr free;
+    for (const BufferPtr &buffer : m_pool) {
+        if (buffer->size == size && buffer->format == format && !buffer->busy.load(std::memory_order_acquire)) {
+            free = buffer;
+            break;
+        }
+    }
+    if (!free && m_pool.size() < m_poolSize) {
+        free = std::make_shared<Buffer>();
+        m_pool.append(free);
+    }
+    if (!free) {
+        // Пул полон: перекраиваем любой свободный буфер (сменился размер кадра или окна);
+        // занятые освободятся вместе со своими QImage
+        for (const BufferPtr &buffer : m_pool) {
+            if (!buffer->busy.load(std::memory_order_acquire)) {
+                free = buffer;
+                break;
+            }
+        }
+        if (!free) return QImage();
+    }
+    if (free->size != size) {
+        free->data.reset(new uchar[size_t(size.width()) * size.height() * 4]);
+        free->size = size;
+    }
+    free->format = format;
+
+    free->busy.store(true, std::memory_order_relaxed);
+    // QImage держит ссылку на буфер и возвращает его в пул при освобождении
+    auto *owner = new BufferPtr(free);
+    return QImage(free->data.get(), size.width(), size.height(), size.width() * 4, format,
+                  [](void *info) {
+                      auto *buffer = static_cast<BufferPtr *>(info);
+                      (*buffer)->busy.store(false, std::memory_order_release);
+                      delete buffer;
+                  }, owner);
+}
+
+QImage VideoFrameMapper::map(const QVideoFrame &frame, const QSize &targetSize)
+{
+    QImage image = toImage(frame);
+    if (image.isNull() || targetSize.isEmpty() || image.depth() != 32) return image;
+
+    // Уменьшать есть смысл, пока обе стороны остаются не меньше области вывода
+    while (image.width() >= 2 * targetSize.width() && image.height() >= 2 * targetSize.height()) {
+        QImage half = halve(image);
+        if (half.isNull()) break; // пул занят - отдаём как есть, отрисовка справится
+        image = std::move(half);
+    }
+    return image;
+}
+
+QImage VideoFrameMapper::halve(const QImage &image)
+{
+    const QSize size(image.width() / 2, image.height() / 2);
+    QImage out = acquire(size, image.format());
+    if (out.isNull()) return QImage();
+    uchar *dst = const_cast<uchar *>(out.constBits());
+    const int stride = int(out.bytesPerLine());
+    forEachBand(size.height(), [&](int first, int last) {
+        halveRows(image, dst, stride, size.width(), first, last);
+    });
+    ++m_downscaled;
+    return out;
+}
+
+QImage VideoFrameMapper::toImage(const QVideoFrame &frame)
+{
+    if (!frame.isValid()) return QImage();
+    const QVideoFrameFormat::PixelFormat pixelFormat = frame.pixelFormat();
+
+    if (frame.handleType() == QVideoFrame::NoHandle) {
+        const QImage::Format imageFormat = QVideoFrameFormat::imageFormatFromPixelFormat(pixelFormat);
+        if (imageFormat != QImage::Format_Invalid) {
+            // Память кадра и есть картинка: оборачиваем без копии.
+            // Константные данные - запись в такой QImage сделает свою копию
+            QVideoFrame *mapped = new QVideoFrame(frame);
+            if (mapped->map(QVideoFrame::ReadOnly)) {
+                ++m_zeroCopy;
+                const uchar *bits = mapped->bits(0);
+                return QImage(bits, mapped->width(), mapped->height(), mapped->bytesPerLine(0),
+                              imageFormat, releaseMappedFrame, mapped);
+            }
+            delete mapped;
+        }
+        switch (pixelFormat) {
+        case QVideoFrameFormat::Format_NV12:
+        case QVideoFrameFormat::Format_NV21:
+        case QVideoFrameFormat::Format_YUV420P:
+        case QVideoFrameFormat::Format_YV12:
+            return convertYuv(frame);
+        default:
+            break;
+        }
+    }
+
+    ++m_fallback;
+    return frame.toImage();
+}
+
+QImage VideoFrameMapper::convertYuv(const QVideoFrame &frame)
+{
+    QImage out = acquire(frame.size(), QImage::Format_RGB32);
+    if (out.isNull()) {
+        // Потребитель не успевает: все буферы ещё на экране
+        ++m_dropped;
+        return QImage();
+    }
+    QVideoFrame mapped(frame);
+    if (!mapped.map(QVideoFrame::ReadOnly)) {
+        ++m_fallback;
+        return frame.toImage();
+    }
+
+    Planes420 planes;
+    planes.y = mapped.bits(0);
+    planes.yStride = mapped.bytesPerLine(0);
+    switch (mapped.pixelFormat()) {
+    case QVideoFrameFormat::Format_NV12:
+    case QVideoFrameFormat::Format_NV21: {
+        const bool nv21 = mapped.pixelFormat() == QVideoFrameFormat::Format_NV21;
+        const uchar *uv = mapped.bits(1);
+        planes.u = nv21 ? uv + 1 : uv;
+        planes.v = nv21 ? uv : uv + 1;
+        planes.uvStride = mapped.bytesPerLine(1);
+        planes.uvStep = 2;
+        break;
+    }
+    default: {
+        const bool yv12 = mapped.pixelFormat() == QVideoFrameFormat::Format_YV12;
+        planes.u = mapped.bits(yv12 ? 2 : 1);
+        planes.v = mapped.bits(yv12 ? 1 : 2);
+        planes.uvStride = mapped.bytesPerLine(1);
+        planes.uvStep = 1;
+        break;
+    }
+    }
+
+    // Полосы строк конвертируются параллельно прямо в память буфера:
+    // QImage над ним ещё никому не отдан, поэтому пишем мимо bits() без отсоединения
+    const YuvCoefficients coefficients = coefficientsFor(mapped.surfaceFormat());
+    uchar *dst = const_cast<uchar *>(out.constBits());
+    const int width = out.width();
+    forEachBand(out.height(), [&](int first, int last) {
+        convertRows(planes, coefficients, dst, width, first, last);
+    });
+    mapped.unmap();
+    ++m_converted;
+    return out;
+}
@@ -13,9 +13,13 @@
 #include <QDropEvent>
 #include <QGraphicsRectItem>
 #include <QGraphicsDropShadowEffect>
+#include "core/trace.h"
+#include "core/perfstats.h"
+#include <QElapsedTimer>
 
 VideoWidget::VideoWidget(QWidget *parent)
     : QWidget(parent)
+    , m_videoSink(new QVideoSink(this))
     , m_hasFrame(false)
     , m_keepAspectRatio(true)
 {
@@ -28,43 +32,85 @@ VideoWidget::VideoWidget(QWidget *parent)
     QPalette pal = palette();
     pal.setColor(QPalette::Window, Qt::black);
     setPalette(pal);
+
+    // Кадр готовится в потоке декодера (отображение или конвертация),
+    // в GUI уходит уже готовый QImage
+    connect(m_videoSink, &QVideoSink::videoFrameChanged, this, &VideoWidget::presentFrame, Qt::DirectConnection);
 }
 
 VideoWidget::~VideoWidget()
 {
+    disconnect(m_videoSink, nullptr, this, nullptr);
+}
+
+void VideoWidget::presentFrame(const QVideoFrame &frame)
+{
+    TRACE_SCOPE("video", "VideoWidget::presentFrame");
+    QSize target;
+    {
+        QMutexLocker locker(&m_pendingMutex);
+        target = m_targetPixels;
+    }
+    QImage image = m_frameMapper.map(frame, target);
+    if (image.isNull()) return;
+
+    QMutexLocker locker(&m_pendingMutex);
+    m_pendingFrame = std::move(image);
+    m_pendingVideoSize = frame.size();
+    if (m_pendingPosted) return;
+    m_pendingPosted = true;
+    QMetaObject::invokeMethod(this, [this]() { takePendingFrame(); }, Qt::QueuedConnection);
+}
+
+void VideoWidget::takePendingFrame()
+{
+    QImage frame;
+    QSize videoSize;
+    {
+        QMutexLocker locker(&m_pendingMutex);
+        frame = std::move(m_pendingFrame);
+        m_pendingFrame = QImage();
+        videoSize = m_pendingVideoSize;
+        m_pendingPosted = false;
+    }
+    if (!frame.isNull()) showFrame(frame, videoSize);
 }
 
 void VideoWidget::setFrame(const QImage &frame)
 {
+    showFrame(frame, frame.size());
+}
+
+void VideoWidget::showFrame(const QImage &frame, const QSize &videoSize)
+{
+    // QImage разделяемый: это ссылка на тот же буфер, а не копия пикселей.
+    // Кадр мог прийти уже уменьшенным, поэтому размер видео передаётся отдельно
     m_currentFrame = frame;
-    m_videoSize = frame.size();
     m_hasFrame = true;
-    updateScaledImage();
-    update();
+    if (videoSize != m_videoSize) {
+        m_videoSize = videoSize;
+        updateTargetRect();
+    }
+    update(m_targetRect);
 }
 
 void VideoWidget::clear()
 {
     m_currentFrame = QImage();
-    m_scaledFrame = QImage();
     m_hasFrame = false;
     update();
 }
 
 void VideoWidget::paintEvent(QPaintEvent *event)
 {
+    TRACE_SCOPE("paint", "VideoWidget::paintEvent");
     QPainter painter(this);
     painter.setRenderHint(QPainter::SmoothPixmapTransform);
     
-    if (m_hasFrame && !m_scaledFrame.isNull()) {
-        // Calculate position to center the image
-        QRect widgetRect = rect();
-        QRect imageRect = m_scaledFrame.rect();
-        
-        int x = (widgetRect.width() - imageRect.width()) / 2;
-        int y = (widgetRect.height() - imageRect.height()) / 2;
-        
-        painter.drawImage(x, y, m_scaledFrame);
+    if (m_hasFrame && !m_currentFrame.isNull()) {
+        // Масштабирует растровый движок при выводе (билинейно); кадры, которые
+        // больше области вдвое и более, поток декодера уже уменьшил
+        painter.drawImage(m_targetRect, m_currentFrame);
     } else {
         // Draw placeholder
         painter.setPen(Qt::white);
@@ -76,9 +122,7 @@ void VideoWidget::paintEvent(QPaintEvent *event)
 void VideoWidget::resizeEvent(QResizeEvent *event)
 {
     QWidget::resizeEvent(event);
-    if (m_hasFrame) {
-        updateScaledImage();
-    }
+    updateTargetRect();
 }
 
 void VideoWidget::mousePressEvent(QMouseEvent *event)
@@ -117,20 +161,17 @@ void VideoWidget::keyPressEvent(QKeyEvent *event)
     }
 }
 
-void VideoWidget::updateScaledImage()
+void VideoWidget::updateTargetRect()
 {
-    if (!m_hasFrame || m_currentFrame.isNull()) {
-        return;
-    }
-    
-    QSize widgetSize = size();
-    QSize imageSize = m_currentFrame.size();
-    
-    if (m_keepAspectRatio) {
-        m_scaledFrame = m_currentFrame.scaled(widgetSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    if (m_videoSize.isEmpty()) {
+        m_targetRect = rect();
     } else {
-        m_scaledFrame = m_currentFrame.scaled(widgetSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        const QSize size = m_keepAspectRatio ? m_videoSize.scaled(this->size(), Qt::KeepAspectRatio) : this->size();
+        m_targetRect = QRect(QPoint((width() - size.width()) / 2, (height() - size.height()) / 2), size);
     }
+
+    QMutexLocker locker(&m_pendingMutex);
+    m_targetPixels = m_targetRect.size() * devicePixelRatioF();
 }
 
 qint64 VideoWidget::positionFromMouse(const QPoint &pos) const
@@ -156,31 +197,28 @@ void DraggableVideoWidget::setSubtitleText(const QString &text) {
     update();
 }
 
-void DraggableVideoWidget::setSubtitles(const QMap<qint64, QString> &subtitles) {
-    qDebug() << "DraggableVideoWidget::setSubtitles called with" << subtitles.size() << "subtitles";
-    m_subtitles = subtitles;
+void DraggableVideoWidget::setSubtitleTrack(SubtitleTrackPtr track) {
+    qDebug() << "DraggableVideoWidget::setSubtitleTrack called with" << (track ? track->size() : 0) << "subtitles";
+    m_track = std::move(track);
+    m_cursor.reset();
+    m_currentCue = -1;
 }
 
 void DraggableVideoWidget::clearSubtitles() {
     qDebug() << "DraggableVideoWidget::clearSubtitles called";
-    m_subtitles.clear();
+    m_track.reset();
+    m_cursor.reset();
+    m_currentCue = -1;
     m_subtitleText.clear();
     update();
 }
 
 void DraggableVideoWidget::updateSubtitlePosition(qint64 position) {
-    QString newText;
-    QList<qint64> keys = m_subtitles.keys();
-    std::sort(keys.begin(), keys.end());
-    for (auto it = m_subtitles.begin(); it != m_subtitles.end(); ++it) {
-        if (it.key() <= position && position < it.key() + 10000) {
-            newText = it.value();
-            break;
-        }
-    }
-    if (newText != m_subtitleText) {
-        qDebug() << "DraggableVideoWidget::updateSubtitlePosition new text:" << newText << "at position:" << position;
-        m_subtitleText = newText;
+    TRACE_SCOPE("subtitle", "DraggableVideoWidget::updateSubtitlePosition");
+    const int cue = m_track ? m_cursor.seek(*m_track, position) : -1;
+    if (cue != m_currentCue) {
+        m_currentCue = cue;
+        m_subtitleText = cue >= 0 ? m_track->text(cue).toString() : QString();
         update();
     }
 }
@@ -214,7 +252,7 @@ void DraggableVideoWidget::dropEvent(QDropEvent *event) {
 }
 
 void DraggableVideoWidget::paintEvent(QPaintEvent *event) {
-    qDebug() << "DraggableVideoWidget::paintEvent called, rect:" << rect() << "visible:" << isVisible();
+    TRACE_SCOPE("paint", "DraggableVideoWidget::paintEvent");
     QPainter painter(this);
     painter.setRenderHint(QPainter::Antialiasing);
     // Сначала рисуем видео с прозрачностью
@@ -234,113 +272,120 @@ void DraggableVideoWidget::paintEvent(QPaintEvent *event) {
         painter.drawText(textRect.translated(2,2), Qt::AlignCenter | Qt::TextWordWrap, m_subtitleText);
         painter.setPen(Qt::white);
         painter.drawText(textRect, Qt::AlignCenter | Qt::TextWordWrap, m_subtitleText);
-        qDebug() << "DraggableVideoWidget::paintEvent drew subtitle:" << m_subtitleText;
     }
 }
 
 // Реализация методов VideoGraphicsView
 VideoGraphicsView::VideoGraphicsView(QWidget *parent)
-    : QGraphicsView(parent), m_videoItem(new QGraphicsVideoItem()), m_subtitleItem(new QGraphicsTextItem()), m_subtitlesVisible(true) {
+    : QGraphicsView(parent), m_videoItem(new QGraphicsVideoItem()),
+      m_cueRenderer(new SubtitleCueRenderer(this)), m_overlay(new SubtitleOverlayItem(m_cueRenderer)), m_subtitlesVisible(true) {
     setAcceptDrops(true);
     setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     auto *graphicsScene = new QGraphicsScene(this);
     setScene(graphicsScene);
     graphicsScene->addItem(m_videoItem);
-    graphicsScene->addItem(m_subtitleItem);
-    m_subtitleItem->setDefaultTextColor(Qt::yellow);
+    graphicsScene->addItem(m_overlay);
     m_videoItem->setZValue(0);
-    m_subtitleItem->setZValue(2);
-    m_subtitleItem->setPos(50, 50); // Центрирование можно доработать
-    m_subtitleItem->setPlainText("");
+    m_overlay->setZValue(2);
     setFrameStyle(QFrame::NoFrame);
     fitInView(m_videoItem, Qt::KeepAspectRatio); // Инициализация
     // Подписка на изменение размера видео
     connect(m_videoItem, &QGraphicsVideoItem::nativeSizeChanged, this, [this]() {
         if (scene()) scene()->setSceneRect(m_videoItem->boundingRect());
         fitInView(m_videoItem, Qt::KeepAspectRatio);
+        updateOverlayGeometry(); // субтитры привязаны к размеру кадра
+    });
+    // Кэш картинок сброшен — текущую реплику надо взять заново и снова заглянуть вперёд
+    connect(m_cueRenderer, &SubtitleCueRenderer::invalidated, this, [this]() {
+        m_overlay->refresh();
+        m_cueRenderer->prefetchFrom(m_currentCue);
     });
-    // Добавляю поле для фона
-    m_subtitleBg = nullptr;
 }
 
-void VideoGraphicsView::setSubtitles(const QMap<qint64, QString> &subtitles) {
-    m_subtitles = subtitles;
+void VideoGraphicsView::setSubtitleTrack(SubtitleTrackPtr track) {
+    m_track = std::move(track);
+    m_cursor.reset();
+    m_cueRenderer->setTrack(m_track);
+    // Оверлей не очищаем: иначе строка мигает на каждом снимке живой дорожки.
+    // Текущую реплику из новой дорожки следом пришлёт планировщик (cueChanged),
+    // её нужно показать, даже если номер совпал с прежним
+    m_cueStale = true;
 }
 
 void VideoGraphicsView::clearSubtitles() {
-    m_subtitles.clear();
-    m_subtitleItem->setPlainText("");
+    m_track.reset();
+    m_cursor.reset();
+    m_cueRenderer->setTrack(nullptr);
+    showCue(-1);
 }
 
 void VideoGraphicsView::setSubtitlesVisible(bool visible) {
     m_subtitlesVisible = visible;
-    if (m_subtitleItem) {
-        m_subtitleItem->setVisible(visible);
-    }
-    if (m_subtitleBg) {
-        m_subtitleBg->setVisible(visible);
-    }
+    m_overlay->setVisible(visible);
 }
 
 void VideoGraphicsView::updateSubtitlePosition(qint64 position) {
-    QString text;
-    for (auto it = m_subtitles.constBegin(); it != m_subtitles.constEnd(); ++it) {
-        if (position >= it.key()) text = it.value();
-        else break;
-    }
-    
-    // Если субтитры скрыты, очищаем текст
-    if (!m_subtitlesVisible) {
-        text.clear();
-    }
-    
-    m_subtitleItem->setPlainText(text);
-
-    // Определяем количество строк
-    int lineCount = text.count("\n") + 1;
-    int fontSize = 7;
-
-    // Оформление субтитров
-    QFont font = m_subtitleItem->font();
-    font.setPointSize(fontSize);
-    font.setBold(true);
-    m_subtitleItem->setFont(font);
-    m_subtitleItem->setDefaultTextColor(QColor(255,255,255));
-    qreal maxWidth = scene() ? scene()->width() * 0.8 : 800;
-    m_subtitleItem->setTextWidth(maxWidth); // Ограничиваем ширину
-
-    // Центрирование и позиция внизу (отступ 15px)
-    QRectF videoRect = m_videoItem->boundingRect();
-    QRectF textRect = m_subtitleItem->boundingRect();
-    qreal x = videoRect.x() + (videoRect.width() - textRect.width()) / 2;
-    qreal y = videoRect.y() + videoRect.height() - textRect.height() - 15; // 15px отступ от низа
-    m_subtitleItem->setPos(x, y);
-    m_subtitleItem->setZValue(0);
-
-    // Удаляем старый фон, если был
-    if (m_subtitleBg) {
-        if (scene()) scene()->removeItem(m_subtitleBg);
-        delete m_subtitleBg;
-        m_subtitleBg = nullptr;
-    }
-    // Добавляем новый фон под текст только если субтитры видимы и есть текст
-    if (!text.isEmpty() && m_subtitlesVisible) {
-        QRectF bgRect = m_subtitleItem->boundingRect().adjusted(-16, -8, 16, 8);
-        // Делаем минимальную высоту фона
-        if (bgRect.height() < 32) {
-            bgRect.setHeight(32);
-        }
-        m_subtitleBg = new QGraphicsRectItem(bgRect);
-        m_subtitleBg->setBrush(QColor(0,0,0,200));
-        m_subtitleBg->setPen(Qt::NoPen);
-        m_subtitleBg->setZValue(1);
-        m_subtitleBg->setPos(x, y);
-        if (scene()) scene()->addItem(m_subtitleBg);
-    }
-    // Явно выставляем zValue для текста и фона
-    if (m_subtitleBg) m_subtitleBg->setZValue(1);
-    m_subtitleItem->setZValue(2);
+    showCue(m_track ? m_cursor.seek(*m_track, position) : -1);
+}
+
+void VideoGraphicsView::showCue(int index) {
+    TRACE_SCOPE("subtitle", "VideoGraphicsView::showCue");
+    index = m_track && index >= 0 && index < m_track->size() ? index : -1;
+    // Та же реплика той же дорожки — сцену не трогаем
+    if (index == m_currentCue && !m_cueStale) return;
+    m_cueStale = false;
+    QElapsedTimer cost;
+    if (m_perfStats) cost.start();
+    m_currentCue = index;
+    m_overlay->setText(index >= 0 ? m_track->text(index).toString() : QString());
+    m_cueRenderer->prefetchFrom(index);
+    if (m_perfStats) m_perfStats->subtitleUpdated(cost.nsecsElapsed());
+}
+
+void VideoGraphicsView::setStatsVisible(bool visible) {
+    if (visible == m_statsVisible) return;
+    m_statsVisible = visible;
+    viewport()->update(statsRect());
+}
+
+void VideoGraphicsView::setStatsText(const QString &text) {
+    // Старый прямоугольник тоже перерисовать: новый текст может быть короче
+    const QRect before = statsRect();
+    m_statsText = text;
+    if (m_statsVisible) viewport()->update(before.united(statsRect()));
+}
+
+QRect VideoGraphicsView::statsRect() const {
+    const QFontMetrics metrics(font());
+    const QRect text = metrics.boundingRect(QRect(0, 0, 10000, 10000), Qt::AlignLeft | Qt::AlignTop, m_statsText);
+    return text.adjusted(0, 0, 16, 12).translated(8, 8);
+}
+
+void VideoGraphicsView::drawForeground(QPainter *painter, const QRectF &rect) {
+    QGraphicsView::drawForeground(painter, rect);
+    if (!m_statsVisible || m_statsText.isEmpty()) return;
+    // В координатах окна: масштаб сцены к оверлею не относится
+    painter->save();
+    painter->resetTransform();
+    const QRect box = statsRect();
+    painter->fillRect(box, QColor(0, 0, 0, 160));
+    painter->setPen(Qt::white);
+    painter->setFont(font());
+    painter->drawText(box.adjusted(8, 6, -8, -6), Qt::AlignLeft | Qt::AlignTop, m_statsText);
+    painter->restore();
+}
+
+void VideoGraphicsView::prefetchSubtitles(qint64 position) {
+    m_cueRenderer->prefetchAround(position);
+}
+
+void VideoGraphicsView::updateOverlayGeometry() {
+    const QRectF frame = m_videoItem->boundingRect();
+    // Растр рисуется в пикселях экрана: масштаб вида плюс плотность пикселей
+    const qreal scale = transform().m11() * viewport()->devicePixelRatioF();
+    m_cueRenderer->setGeometry(int(frame.width() * SubtitleOverlayItem::WidthFraction), scale);
+    m_overlay->setFrameRect(frame);
 }
 
 QGraphicsVideoItem* VideoGraphicsView::videoItem() const {
@@ -350,6 +395,7 @@ QGraphicsVideoItem* VideoGraphicsView::videoItem() const {
 void VideoGraphicsView::resizeEvent(QResizeEvent *event) {
     QGraphicsView::resizeEvent(event);
     fitInView(m_videoItem, Qt::KeepAspectRatio); // Подгоняем видео при изменении размера окна
+    updateOverlayGeometry();
 }
 
 #include "videowidget.moc"